@@ -37,6 +37,8 @@ option(USE_VTUNE "Plug VTUNE to profile GSdx JIT.")
 #-------------------------------------------------------------------------------
 option(REBUILD_SHADER "Rebuild GLSL/CG shader (developer option)")
 option(BUILD_REPLAY_LOADERS "Build GS replayer to ease testing (developer option)")
+option(BUILD_LIBRETRO_BENCH "Build the headless libretro core benchmark (developer option)")
+option(BUILD_BLOCKS_BENCH "Build the recompiler block index benchmark (developer option)")
 
 #-------------------------------------------------------------------------------
 # Path and lib option
@@ -248,6 +248,20 @@ extern void MemProtect(void *baseaddr, size_t size, const PageProtectionMode &mo
 
 extern void Munmap(void *base, size_t size);
 
+// Creates an anonymous shared memory object which can be mapped at several host addresses
+// at once (used to alias emulated memory).  Returns NULL if the host doesn't support it.
+extern void *CreateSharedMemory(size_t size);
+extern void DestroySharedMemory(void *handle);
+
+// Maps [offset, offset+size) of a shared memory object at baseaddr, replacing any mapping
+// already present there.  Returns NULL on failure.
+extern void *MapSharedMemory(void *handle, size_t offset, void *baseaddr, size_t size, const PageProtectionMode &mode);
+
+// Asks the host to back the 2MB aligned part of a committed range with huge pages when it
+// faults them in (transparent huge pages).  Protection changes still work per 4KB page, the
+// host splits the huge page they land in.  Returns false if the host can't do it.
+extern bool MemAdviseHugePages(void *baseaddr, size_t size);
+
 template <uint size>
 void MemProtectStatic(u8 (&arr)[size], const PageProtectionMode &mode)
 {
@@ -30,10 +30,12 @@
 struct PageFaultInfo
 {
     uptr addr;
+    uptr pc; // faulting instruction, or 0 if the host doesn't report it
 
-    PageFaultInfo(uptr address)
+    PageFaultInfo(uptr address, uptr pc_ = 0)
     {
         addr = address;
+        pc = pc_;
     }
 };
 
@@ -107,15 +109,23 @@ protected:
 
 protected:
     bool m_handled;
+    uptr m_resume;
 
 public:
     SrcType_PageFault()
         : m_handled(false)
+        , m_resume(0)
     {
     }
     virtual ~SrcType_PageFault() = default;
 
     bool WasHandled() const { return m_handled; }
+
+    // A listener may redirect execution elsewhere instead of re-executing the faulting
+    // instruction (only honored when the host reports PageFaultInfo::pc).
+    void SetResumeAddress(uptr pc) { m_resume = pc; }
+    uptr GetResumeAddress() const { return m_resume; }
+
     virtual void Dispatch(const PageFaultInfo &params);
 
 protected:
@@ -217,6 +227,9 @@ protected:
     // as well.
     bool m_allow_writes;
 
+    // Asks the host for huge pages when committing (see HostSys::MemAdviseHugePages).
+    bool m_huge_pages;
+
     // Allows the implementation to decide how much memory it needs to allocate if someone requests the given size
     // Should translate requests of size 0 to m_defsize
     virtual size_t GetSize(size_t requestedSize);
@@ -267,6 +280,7 @@ public:
     const u8 *GetPtrEnd() const { return (u8 *)m_baseptr + (m_pages_reserved * __pagesize); }
 
     VirtualMemoryReserve &SetPageAccessOnCommit(const PageProtectionMode &mode);
+    VirtualMemoryReserve &SetHugePagesOnCommit(bool enabled);
 
     operator void *() { return m_baseptr; }
     operator const void *() const { return m_baseptr; }
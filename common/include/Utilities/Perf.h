@@ -32,11 +32,15 @@ struct Info
     void Print(FILE *fp);
 };
 
+// Names the guest code at pc (ie from the game symbols). Return false if unknown.
+typedef bool (*SymbolResolver)(u32 pc, char *name, size_t size);
+
 class InfoVector
 {
     std::vector<Info> m_v;
     char m_prefix[20];
     unsigned int m_vtune_id;
+    SymbolResolver m_resolver;
 
 public:
     InfoVector(const char *prefix);
@@ -45,6 +49,7 @@ public:
     void map(uptr x86, u32 size, const char *symbol);
     void map(uptr x86, u32 size, u32 pc);
     void reset();
+    void set_resolver(SymbolResolver resolver) { m_resolver = resolver; }
 };
 
 void dump();
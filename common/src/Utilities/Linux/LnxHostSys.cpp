@@ -23,6 +23,11 @@
 #include <signal.h>
 #include <errno.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#if defined(__linux__) && defined(__x86_64__)
+#include <ucontext.h>
+#endif
 
 // Apple uses the MAP_ANON define instead of MAP_ANONYMOUS, but they mean
 // the same thing.
@@ -35,7 +40,7 @@ extern void SignalExit(int sig);
 static const uptr m_pagemask = getpagesize() - 1;
 
 // Linux implementation of SIGSEGV handler.  Bind it using sigaction().
-static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *)
+static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *context)
 {
     // [TODO] : Add a thread ID filter to the Linux Signal handler here.
     // Rationale: On windows, the __try/__except model allows per-thread specific behavior
@@ -59,12 +64,22 @@ static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *)
     // so for now we lock this exception code unless someone can fix this better...
     Threading::ScopedLock lock(PageFault_Mutex);
 
+#if defined(__linux__) && defined(__x86_64__)
+    greg_t &rip = static_cast<ucontext_t *>(context)->uc_mcontext.gregs[REG_RIP];
+    Source_PageFault->Dispatch(PageFaultInfo((uptr)siginfo->si_addr & ~m_pagemask, (uptr)rip));
+#else
     Source_PageFault->Dispatch(PageFaultInfo((uptr)siginfo->si_addr & ~m_pagemask));
+#endif
 
     // resumes execution right where we left off (re-executes instruction that
-    // caused the SIGSEGV).
-    if (Source_PageFault->WasHandled())
+    // caused the SIGSEGV), unless a listener asked to continue somewhere else.
+    if (Source_PageFault->WasHandled()) {
+#if defined(__linux__) && defined(__x86_64__)
+        if (uptr resume = Source_PageFault->GetResumeAddress())
+            rip = (greg_t)resume;
+#endif
         return;
+    }
 
     if (!wxThread::IsMain()) {
         pxFailRel(pxsFmt("Unhandled page fault @ 0x%08x", siginfo->si_addr));
@@ -218,6 +233,66 @@ void HostSys::Munmap(uptr base, size_t size)
     munmap((void *)base, size);
 }
 
+// The shared memory handle is the file descriptor plus one, so that NULL means failure.
+void *HostSys::CreateSharedMemory(size_t size)
+{
+#if defined(__linux__) && defined(SYS_memfd_create)
+    PageSizeAssertionTest(size);
+
+    int fd = syscall(SYS_memfd_create, "pcsx2", 1 /* MFD_CLOEXEC */);
+    if (fd < 0)
+        return NULL;
+
+    if (ftruncate(fd, size) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    return (void *)(uptr)(fd + 1);
+#else
+    return NULL;
+#endif
+}
+
+void HostSys::DestroySharedMemory(void *handle)
+{
+    if (handle)
+        close((int)(uptr)handle - 1);
+}
+
+void *HostSys::MapSharedMemory(void *handle, size_t offset, void *baseaddr, size_t size, const PageProtectionMode &mode)
+{
+    PageSizeAssertionTest(size);
+
+    int lnxmode = PROT_NONE;
+    if (mode.CanWrite())
+        lnxmode |= PROT_WRITE;
+    if (mode.CanRead())
+        lnxmode |= PROT_READ;
+
+    void *result = mmap(baseaddr, size, lnxmode, MAP_SHARED | MAP_FIXED, (int)(uptr)handle - 1, offset);
+    return (result == MAP_FAILED) ? NULL : result;
+}
+
+// Explicit huge pages (MAP_HUGETLB) can't be protected per 4KB page, which the EE ram page
+// tracking relies on; transparent ones are split by the kernel when that happens.  The hint
+// is a no-op unless /sys/kernel/mm/transparent_hugepage/enabled is "always" or "madvise".
+bool HostSys::MemAdviseHugePages(void *baseaddr, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    static const uptr HugePageSize = 0x200000;
+
+    uptr start = ((uptr)baseaddr + HugePageSize - 1) & ~(HugePageSize - 1);
+    uptr end = ((uptr)baseaddr + size) & ~(HugePageSize - 1);
+    if (start >= end)
+        return false;
+
+    return madvise((void *)start, end - start, MADV_HUGEPAGE) == 0;
+#else
+    return false;
+#endif
+}
+
 void HostSys::MemProtect(void *baseaddr, size_t size, const PageProtectionMode &mode)
 {
     if (!_memprotect(baseaddr, size, mode)) {
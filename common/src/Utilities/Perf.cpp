@@ -21,6 +21,15 @@
 #include "unistd.h"
 #endif
 
+#ifdef __linux__
+#include <elf.h>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
 //#define ProfileWithPerf
 #define MERGE_BLOCK_RESULT
 
@@ -41,6 +50,219 @@ InfoVector iop("IOP");
 InfoVector vu("VU");
 InfoVector vif("VIF");
 
+////////////////////////////////////////////////////////////////////////////////
+// perf jitdump
+////////////////////////////////////////////////////////////////////////////////
+// Unlike the perf map below, the jitdump stream is available in every build. Set
+// PCSX2_JITDUMP=1 to write every recompiled block (code bytes included) into
+// $JITDUMPDIR/jit-<pid>.dump (default /tmp). Then
+//   perf record -k 1 ...
+//   perf inject --jit -i perf.data -o perf.jit.data
+//
+// The format has no unload record: when a code cache is reset, perf resolves the
+// reused addresses with the most recent load record, as they are timestamped.
+#ifdef __linux__
+namespace
+{
+
+enum JitRecordType {
+    JIT_CODE_LOAD = 0,
+    JIT_CODE_CLOSE = 3,
+};
+
+struct JitHeader
+{
+    u32 magic;
+    u32 version;
+    u32 total_size;
+    u32 elf_mach;
+    u32 pad1;
+    u32 pid;
+    u64 timestamp;
+    u64 flags;
+};
+
+struct JitRecordHeader
+{
+    u32 id;
+    u32 total_size;
+    u64 timestamp;
+};
+
+struct JitCodeLoad
+{
+    JitRecordHeader p;
+    u32 pid;
+    u32 tid;
+    u64 vma;
+    u64 code_addr;
+    u64 code_size;
+    u64 code_index;
+    // followed by the null-terminated name and the code bytes
+};
+
+class JitDump
+{
+    std::mutex m_lock;
+    FILE *m_fp;
+    void *m_marker;
+    u64 m_index;
+    u32 m_pid;
+
+    // perf requires the same clock as "perf record -k 1"
+    static u64 Timestamp()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (u64)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+
+public:
+    JitDump()
+        : m_fp(NULL)
+        , m_marker(NULL)
+        , m_index(0)
+        , m_pid(getpid())
+    {
+        const char *enable = getenv("PCSX2_JITDUMP");
+        if (enable && *enable && strcmp(enable, "0"))
+            Open();
+    }
+
+    ~JitDump()
+    {
+        Close();
+    }
+
+    bool IsOpen() const { return m_fp != NULL; }
+
+    void Open()
+    {
+        const char *dir = getenv("JITDUMPDIR");
+        char file[256];
+        snprintf(file, sizeof(file), "%s/jit-%d.dump", dir ? dir : "/tmp", m_pid);
+
+        int fd = open(file, O_CREAT | O_TRUNC | O_RDWR, 0666);
+        if (fd < 0) {
+            fprintf(stderr, "Perf: failed to create %s\n", file);
+            return;
+        }
+
+        // perf discovers the dump through this executable mapping of the file
+        m_marker = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0);
+        if (m_marker == MAP_FAILED) {
+            m_marker = NULL;
+            close(fd);
+            return;
+        }
+
+        m_fp = fdopen(fd, "wb");
+        setvbuf(m_fp, NULL, _IOFBF, 256 * 1024);
+
+        JitHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = 0x4A695444; // "JiTD"
+        header.version = 1;
+        header.total_size = sizeof(header);
+#ifdef __M_X86_64
+        header.elf_mach = EM_X86_64;
+#else
+        header.elf_mach = EM_386;
+#endif
+        header.pid = m_pid;
+        header.timestamp = Timestamp();
+        fwrite(&header, sizeof(header), 1, m_fp);
+        fflush(m_fp);
+    }
+
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_fp)
+            return;
+
+        JitRecordHeader rec;
+        rec.id = JIT_CODE_CLOSE;
+        rec.total_size = sizeof(rec);
+        rec.timestamp = Timestamp();
+        fwrite(&rec, sizeof(rec), 1, m_fp);
+
+        fclose(m_fp);
+        m_fp = NULL;
+        munmap(m_marker, sysconf(_SC_PAGESIZE));
+        m_marker = NULL;
+    }
+
+    // Blocks are compiled on the EE and the MTVU threads
+    void Load(const char *name, uptr x86, u32 size)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_fp || !size)
+            return;
+
+        const u32 name_size = strlen(name) + 1;
+
+        JitCodeLoad rec;
+        rec.p.id = JIT_CODE_LOAD;
+        rec.p.total_size = sizeof(rec) + name_size + size;
+        rec.p.timestamp = Timestamp();
+        rec.pid = m_pid;
+        rec.tid = syscall(SYS_gettid);
+        rec.vma = x86;
+        rec.code_addr = x86;
+        rec.code_size = size;
+        rec.code_index = m_index++;
+
+        fwrite(&rec, sizeof(rec), 1, m_fp);
+        fwrite(name, name_size, 1, m_fp);
+        fwrite((void *)x86, size, 1, m_fp);
+    }
+
+    void Flush()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_fp)
+            fflush(m_fp);
+    }
+};
+
+JitDump jitdump;
+
+} // namespace
+
+// Code reserves are mapped as a whole for the perf map, they are mostly uncommitted
+// and would be superseded by the blocks anyway.
+static void jitdump_map(uptr x86, u32 size, const char *symbol)
+{
+    if (jitdump.IsOpen() && size < 16 * _1kb)
+        jitdump.Load(symbol, x86, size);
+}
+
+static void jitdump_map(uptr x86, u32 size, const char *prefix, u32 pc, SymbolResolver resolver)
+{
+    if (!jitdump.IsOpen())
+        return;
+
+    char name[256];
+    char symbol[200];
+    if (resolver && resolver(pc, symbol, sizeof(symbol)))
+        snprintf(name, sizeof(name), "%s_0x%08x %s", prefix, pc, symbol);
+    else
+        snprintf(name, sizeof(name), "%s_0x%08x", prefix, pc);
+
+    jitdump.Load(name, x86, size);
+}
+
+static void jitdump_flush()
+{
+    jitdump.Flush();
+}
+#else
+static void jitdump_map(uptr x86, u32 size, const char *symbol) {}
+static void jitdump_map(uptr x86, u32 size, const char *prefix, u32 pc, SymbolResolver resolver) {}
+static void jitdump_flush() {}
+#endif
+
 // Perf is only supported on linux
 #if defined(__linux__) && (defined(ProfileWithPerf) || defined(ENABLE_VTUNE))
 
@@ -74,6 +296,7 @@ void Info::Print(FILE *fp)
 ////////////////////////////////////////////////////////////////////////////////
 
 InfoVector::InfoVector(const char *prefix)
+    : m_resolver(NULL)
 {
     strncpy(m_prefix, prefix, sizeof(m_prefix));
 #ifdef ENABLE_VTUNE
@@ -101,6 +324,8 @@ void InfoVector::map(uptr x86, u32 size, const char *symbol)
     u32 max_code_size = _1gb;
 #endif
 
+    jitdump_map(x86, size, symbol);
+
     if (size < max_code_size) {
         m_v.emplace_back(x86, size, symbol);
 
@@ -125,6 +350,8 @@ void InfoVector::map(uptr x86, u32 size, const char *symbol)
 
 void InfoVector::map(uptr x86, u32 size, u32 pc)
 {
+    jitdump_map(x86, size, m_prefix, pc, m_resolver);
+
 #ifndef MERGE_BLOCK_RESULT
     m_v.emplace_back(x86, size, m_prefix, pc);
 #endif
@@ -163,6 +390,8 @@ void InfoVector::reset()
 
 void dump()
 {
+    jitdump_flush();
+
     char file[256];
     snprintf(file, 250, "/tmp/perf-%d.map", getpid());
     FILE *fp = fopen(file, "w");
@@ -194,13 +423,15 @@ void dump_and_reset()
 
 InfoVector::InfoVector(const char *prefix)
     : m_vtune_id(0)
+    , m_resolver(NULL)
 {
+    strncpy(m_prefix, prefix, sizeof(m_prefix));
 }
-void InfoVector::map(uptr x86, u32 size, const char *symbol) {}
-void InfoVector::map(uptr x86, u32 size, u32 pc) {}
+void InfoVector::map(uptr x86, u32 size, const char *symbol) { jitdump_map(x86, size, symbol); }
+void InfoVector::map(uptr x86, u32 size, u32 pc) { jitdump_map(x86, size, m_prefix, pc, m_resolver); }
 void InfoVector::reset() {}
 
-void dump() {}
+void dump() { jitdump_flush(); }
 void dump_and_reset() {}
 
 #endif
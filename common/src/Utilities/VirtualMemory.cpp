@@ -57,6 +57,7 @@ EventListener_PageFault::~EventListener_PageFault()
 void SrcType_PageFault::Dispatch(const PageFaultInfo &params)
 {
     m_handled = false;
+    m_resume = 0;
     _parent::Dispatch(params);
 }
 
@@ -225,6 +226,7 @@ VirtualMemoryReserve::VirtualMemoryReserve(const wxString &name, size_t size)
     m_baseptr = nullptr;
     m_prot_mode = PageAccess_None();
     m_allow_writes = true;
+    m_huge_pages = false;
 }
 
 VirtualMemoryReserve &VirtualMemoryReserve::SetPageAccessOnCommit(const PageProtectionMode &mode)
@@ -233,6 +235,13 @@ VirtualMemoryReserve &VirtualMemoryReserve::SetPageAccessOnCommit(const PageProt
     return *this;
 }
 
+// Takes effect on the next Commit; committed memory keeps the pages it has.
+VirtualMemoryReserve &VirtualMemoryReserve::SetHugePagesOnCommit(bool enabled)
+{
+    m_huge_pages = enabled;
+    return *this;
+}
+
 size_t VirtualMemoryReserve::GetSize(size_t requestedSize)
 {
     if (!requestedSize)
@@ -313,7 +322,14 @@ bool VirtualMemoryReserve::Commit()
         return true;
 
     m_pages_commited = m_pages_reserved;
-    return HostSys::MmapCommitPtr(m_baseptr, m_pages_reserved * __pagesize, m_prot_mode);
+    if (!HostSys::MmapCommitPtr(m_baseptr, m_pages_reserved * __pagesize, m_prot_mode))
+        return false;
+
+    // Reset maps the range anew, so the hint has to be given on every commit.
+    if (m_huge_pages)
+        HostSys::MemAdviseHugePages(m_baseptr, m_pages_reserved * __pagesize);
+
+    return true;
 }
 
 void VirtualMemoryReserve::AllowModification()
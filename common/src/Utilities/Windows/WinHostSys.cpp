@@ -133,6 +133,28 @@ void HostSys::Munmap(uptr base, size_t size)
     VirtualFree((void *)base, 0, MEM_RELEASE);
 }
 
+// Aliased views would need placeholder APIs (Windows 10 1803+); not supported for now.
+void *HostSys::CreateSharedMemory(size_t size)
+{
+    return NULL;
+}
+
+void HostSys::DestroySharedMemory(void *handle)
+{
+}
+
+void *HostSys::MapSharedMemory(void *handle, size_t offset, void *baseaddr, size_t size, const PageProtectionMode &mode)
+{
+    return NULL;
+}
+
+// Large pages need SeLockMemoryPrivilege and can't be reserved and committed separately or
+// protected per 4KB page, none of which fits the reserves.
+bool HostSys::MemAdviseHugePages(void *baseaddr, size_t size)
+{
+    return false;
+}
+
 void HostSys::MemProtect(void *baseaddr, size_t size, const PageProtectionMode &mode)
 {
     pxAssertDev(((size & (__pagesize - 1)) == 0), pxsFmt(
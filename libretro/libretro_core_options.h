@@ -78,6 +78,7 @@ struct retro_core_option_definition option_defs[] = {
 		{"D3D11", NULL},
 #endif
 		{"OpenGl", NULL},
+		{"CPU", "Software (CPU only)"},
 		{NULL, NULL},
 	},
 	"Auto"},
@@ -330,6 +331,41 @@ struct retro_core_option_definition option_defs[] = {
 	},
 	"2" },
 
+	{ "pcsx2_mtvu_spin_count",
+	"Emulation: MTVU Spin-Wait",
+	"How long the MTVU thread and the EE busy-wait on each other before yielding. Higher values help games running many short VU1 programs at the cost of CPU usage. (Content restart required)",
+	{
+		{"0", "Off"},
+		{"128", "128"},
+		{"512", "512 (default)"},
+		{"2048", "2048"},
+		{"8192", "8192"},
+		{NULL, NULL},
+	},
+	"512" },
+
+	{ "pcsx2_mtvu_yield_count",
+	"Emulation: MTVU Yield-Wait",
+	"How many times the MTVU thread and the EE yield to other threads after spinning, before going to sleep. (Content restart required)",
+	{
+		{"0", "Off"},
+		{"8", "8"},
+		{"32", "32 (default)"},
+		{"128", "128"},
+		{NULL, NULL},
+	},
+	"32" },
+
+	{ "pcsx2_mtvu_precompile",
+	"Emulation: MTVU Precompile",
+	"Compiles the VU1 programs uploaded by the game while the MTVU thread is idle, instead of when they are first run. (Content restart required)",
+	{
+		{"enabled", NULL},
+		{"disabled", NULL},
+		{NULL, NULL},
+	},
+	"enabled" },
+
 	{ "pcsx2_clamping_mode",
 	"Emulation: Clamping Mode",
 	"Clamping mode can fix some bugs on some games. Default value is fine for most games. (Content restart required)",
@@ -355,6 +391,58 @@ struct retro_core_option_definition option_defs[] = {
 	},
 	"3" },
 
+	{ "pcsx2_fastmem",
+	"Emulation: Fastmem",
+	"Lets the EE recompiler access memory through a host mapping of the PS2 address space instead of a table lookup, falling back to the lookup on I/O pages. Linux x86-64 only. (Content restart required)",
+	{
+		{"disabled", NULL},
+		{"enabled", NULL},
+		{NULL, NULL},
+	},
+	"disabled" },
+
+	{ "pcsx2_cdvd_prefetch",
+	"Emulation: Learned Disc Prefetch",
+	"Records the disc reads of each game to the settings folder and, on later runs, reads ahead along the recorded sequence on a worker thread. Mostly useful with compressed images (CHD, CSO, GZ). (Content restart required)",
+	{
+		{"disabled", NULL},
+		{"enabled", NULL},
+		{NULL, NULL},
+	},
+	"disabled" },
+
+	{ "pcsx2_ee_precompile",
+	"Emulation: EE Block Precompile",
+	"Saves the EE code blocks each game runs to the settings folder and compiles them when the game boots again, instead of on first use during gameplay. Blocks whose memory page changed since are skipped. (Content restart required)",
+	{
+		{"disabled", NULL},
+		{"enabled", NULL},
+		{NULL, NULL},
+	},
+	"disabled" },
+
+	{ "pcsx2_huge_pages",
+	"Emulation: Huge Pages",
+	"Asks the host to back PS2 main memory and the recompiler code caches with 2MB pages, which reduces TLB misses. Linux only, needs transparent huge pages set to 'always' or 'madvise'. (Content restart required)",
+	{
+		{"disabled", NULL},
+		{"enabled", NULL},
+		{NULL, NULL},
+	},
+	"disabled" },
+
+	{ "pcsx2_guest_profiler",
+	"Emulation: Guest Profiler",
+	"Samples the game code running on the EE and IOP and writes eeProfile.txt (hot functions and blocks) and eeProfile.folded (flamegraph stacks) to the log folder when the content is closed. (Content restart required)",
+	{
+		{"0", "disabled"},
+		{"100", "100 Hz"},
+		{"1000", "1000 Hz"},
+		{"4000", "4000 Hz"},
+		{NULL, NULL},
+	},
+	"0" },
+
 
 	{ "pcsx2_userhack_align_sprite",
 	"Hack: Align Sprite",
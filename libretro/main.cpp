@@ -32,6 +32,7 @@
 
 
 #include "MTVU.h"
+#include "DebugTools/GuestProfiler.h"
 
 #ifdef PERF_TEST
 static struct retro_perf_callback perf_cb;
@@ -356,6 +357,9 @@ void retro_init(void)
 	g_Conf->EmuOptions.GS.FramesToSkip = option_value(INT_PCSX2_OPT_FRAMES_TO_SKIP, KeyOptionInt::return_type);
 	g_Conf->EmuOptions.GS.VsyncQueueSize = option_value(INT_PCSX2_OPT_VSYNC_MTGS_QUEUE, KeyOptionInt::return_type);
 	g_Conf->EmuOptions.EnableCheats = option_value(BOOL_PCSX2_OPT_ENABLE_CHEATS, KeyOptionBool::return_type);
+	g_Conf->EmuOptions.Speedhacks.vuThreadSpinCount = option_value(INT_PCSX2_OPT_MTVU_SPIN_COUNT, KeyOptionInt::return_type);
+	g_Conf->EmuOptions.Speedhacks.vuThreadYieldCount = option_value(INT_PCSX2_OPT_MTVU_YIELD_COUNT, KeyOptionInt::return_type);
+	g_Conf->EmuOptions.Speedhacks.vuPrecompile = option_value(BOOL_PCSX2_OPT_MTVU_PRECOMPILE, KeyOptionBool::return_type);
 	
 
 	int clampMode = option_value(INT_PCSX2_OPT_CLAMPING_MODE, KeyOptionInt::return_type);
@@ -371,6 +375,16 @@ void retro_init(void)
 	g_Conf->EmuOptions.Cpu.sseMXCSR.SetRoundMode(roundMode);
 	g_Conf->EmuOptions.Cpu.sseVUMXCSR.SetRoundMode(roundMode);
 
+	g_Conf->EmuOptions.Cpu.Recompiler.EnableFastmem = option_value(BOOL_PCSX2_OPT_FASTMEM, KeyOptionBool::return_type);
+	g_Conf->EmuOptions.CdvdPrefetchProfiles = option_value(BOOL_PCSX2_OPT_CDVD_PREFETCH, KeyOptionBool::return_type);
+	g_Conf->EmuOptions.Cpu.Recompiler.PrecompileEE = option_value(BOOL_PCSX2_OPT_EE_PRECOMPILE, KeyOptionBool::return_type);
+	g_Conf->EmuOptions.Cpu.Recompiler.EnableHugePages = option_value(BOOL_PCSX2_OPT_HUGE_PAGES, KeyOptionBool::return_type);
+
+	const int sampleRate = option_value(INT_PCSX2_OPT_GUEST_PROFILER, KeyOptionInt::return_type);
+	g_Conf->EmuOptions.Profiler.Enabled = sampleRate != 0;
+	if (sampleRate)
+		g_Conf->EmuOptions.Profiler.SampleRate = sampleRate;
+
 
 	static retro_disk_control_ext_callback disk_control = {
 		DiskControl::set_eject_state,
@@ -430,7 +444,8 @@ void retro_get_system_info(retro_system_info* info)
 
 void retro_get_system_av_info(retro_system_av_info* info)
 {
-	if ( !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Software") || !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Null"))
+	if ( !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Software") || !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Null")
+		|| !std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "CPU"))
 	{
 		info->geometry.base_width = 640;
 		info->geometry.base_height = 448;
@@ -467,6 +482,7 @@ static void context_reset(void)
 static void context_destroy(void)
 {
 	GetMTGS().FinishTaskInThread();
+	guestProfilerStop();
 
 	while (pcsx2->HasPendingEvents())
 		pcsx2->ProcessPendingEvents();
@@ -802,6 +818,14 @@ bool retro_load_game(const struct retro_game_info* game)
 #endif
 	else if (!std::strcmp(option_renderer, "Null"))
 		context_type = RETRO_HW_CONTEXT_NONE;
+	else if (!std::strcmp(option_renderer, "CPU"))
+	{
+		// Frames go through video_cb from system memory, no context is requested so
+		// there is no context_reset either: open the GS right away.
+		hw_render.context_type = RETRO_HW_CONTEXT_NONE;
+		context_reset();
+		return true;
+	}
 
 	return set_hw_render(context_type);
 }
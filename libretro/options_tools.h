@@ -30,6 +30,11 @@ static const char* BOOL_PCSX2_OPT_ENABLE_CHEATS				= "pcsx2_enable_cheats";
 static const char* BOOL_PCSX2_OPT_USERHACK_AUTO_FLUSH		= "pcsx2_userhack_auto_flush";
 static const char* BOOL_PCSX2_OPT_CONSERVATIVE_BUFFER		= "pcsx2_conservative_buffer";
 static const char* BOOL_PCSX2_OPT_ACCURATE_DATE			    = "pcsx2_accurate_date";
+static const char* BOOL_PCSX2_OPT_FASTMEM					= "pcsx2_fastmem";
+static const char* BOOL_PCSX2_OPT_CDVD_PREFETCH				= "pcsx2_cdvd_prefetch";
+static const char* BOOL_PCSX2_OPT_MTVU_PRECOMPILE			= "pcsx2_mtvu_precompile";
+static const char* BOOL_PCSX2_OPT_EE_PRECOMPILE				= "pcsx2_ee_precompile";
+static const char* BOOL_PCSX2_OPT_HUGE_PAGES				= "pcsx2_huge_pages";
 
 
 
@@ -57,8 +62,11 @@ static const char* INT_PCSX2_OPT_DEINTERLACING_MODE			= "pcsx2_deinterlace_mode"
 static const char* INT_PCSX2_OPT_FXAA						= "pcsx2_fxaa";
 static const char* INT_PCSX2_OPT_TEXTURE_FILTERING			= "pcsx2_texture_filtering";
 static const char* INT_PCSX2_OPT_VSYNC_MTGS_QUEUE			= "pcsx2_vsync_mtgs_queue";
+static const char* INT_PCSX2_OPT_MTVU_SPIN_COUNT			= "pcsx2_mtvu_spin_count";
+static const char* INT_PCSX2_OPT_MTVU_YIELD_COUNT			= "pcsx2_mtvu_yield_count";
 static const char* INT_PCSX2_OPT_MIPMAPPING					= "pcsx2_mipmapping";
 static const char* INT_PCSX2_OPT_CLAMPING_MODE				= "pcsx2_clamping_mode";
+static const char* INT_PCSX2_OPT_GUEST_PROFILER				= "pcsx2_guest_profiler";
 static const char* INT_PCSX2_OPT_ROUND_MODE					= "pcsx2_round_mode";
 
 
@@ -358,6 +358,17 @@ static __fi ElfObject* loadElf(const wxString filename)
 	return new ElfObject(fixedname, file);
 }
 
+// Read profiles are kept per serial; the ISO source starts following the one of the game
+// (or recording it) from here on.
+static void cdvdBindPrefetchProfile()
+{
+	if (!EmuConfig.CdvdPrefetchProfiles || DiscSerial.IsEmpty())
+		return;
+
+	const wxDirName folder(GetSettingsFolder().Combine(wxDirName(L"cdvd")));
+	ISObindPrefetchProfile(folder.Combine(wxFileName(DiscSerial + L".prefetch")).GetFullPath());
+}
+
 static __fi void _reloadElfInfo(wxString elfpath)
 {
 	// Now's a good time to reload the ELF info...
@@ -373,7 +384,10 @@ static __fi void _reloadElfInfo(wxString elfpath)
 	if (!fname)
 		fname = elfpath.AfterLast(':');
 	if (fname.Matches(L"????_???.??*"))
+	{
 		DiscSerial = fname(0, 4) + L"-" + fname(5, 3) + fname(9, 2);
+		cdvdBindPrefetchProfile();
+	}
 
 	std::unique_ptr<ElfObject> elfptr(loadElf(elfpath));
 
@@ -416,6 +430,7 @@ void cdvdReloadElfInfo(wxString elfoverride)
 			wxString fname2 = fname.BeforeFirst(';');
 			DiscSerial = fname2;
 			Console.SetTitle(DiscSerial);
+			cdvdBindPrefetchProfile();
 			return;
 		}
 
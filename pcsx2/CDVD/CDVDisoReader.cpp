@@ -358,6 +358,11 @@ s32 CALLBACK ISOreadSector(u8* tempbuffer, u32 lsn, int mode)
 	return 0;
 }
 
+void ISObindPrefetchProfile(const wxString& filename)
+{
+	iso.BindPrefetchProfile(filename);
+}
+
 s32 CALLBACK ISOreadTrack(u32 lsn, int mode)
 {
 	int _lsn = lsn;
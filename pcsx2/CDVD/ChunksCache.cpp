@@ -56,3 +56,13 @@ int ChunksCache::Read(void* pDest, PX_off_t offset, int length)
 	}
 	return -1;
 }
+
+bool ChunksCache::Contains(PX_off_t offset, int length) const
+{
+	for (const CacheEntry* e : m_entries)
+	{
+		if (e && offset >= e->offset && (offset + length) <= (e->offset + e->coverage))
+			return true;
+	}
+	return false;
+}
@@ -32,6 +32,7 @@ public:
 
 	void Take(void* pMallocedSrc, PX_off_t offset, int length, int coverage);
 	int Read(void* pDest, PX_off_t offset, int length);
+	bool Contains(PX_off_t offset, int length) const;
 
 	static int CopyAvailable(void* pSrc, PX_off_t srcOffset, int srcSize,
 							 void* pDst, PX_off_t dstOffset, int maxCopySize)
@@ -185,6 +185,7 @@ void InputIsoFile::_init()
 	m_current_lsn = -1;
 	m_read_lsn = -1;
 	m_reader = NULL;
+	m_prefetch = NULL;
 }
 
 // Tests the specified filename to see if it is a supported ISO type.  This function typically
@@ -268,6 +269,9 @@ bool InputIsoFile::Open(const wxString& srcfile, bool testOnly)
 			delete m_reader_old;
 	}
 
+	if (EmuConfig.CdvdPrefetchProfiles)
+		m_reader = m_prefetch = new PrefetchFileReader(m_reader);
+
 	m_blocks = m_reader->GetBlockCount();
 
 	Console.WriteLn(Color_StrongBlue, L"isoFile open ok: %s", WX_STR(m_filename));
@@ -292,6 +296,14 @@ void InputIsoFile::Close()
 	_init();
 }
 
+// The profile is only known once the game's serial has been read from the disc, so the
+// reads done before that are recorded without prefetching.
+void InputIsoFile::BindPrefetchProfile(const wxString& filename)
+{
+	if (m_prefetch)
+		m_prefetch->BindProfile(filename);
+}
+
 bool InputIsoFile::IsOpened() const
 {
 	return m_reader != NULL;
@@ -19,6 +19,7 @@
 #include "wx/wfstream.h"
 #include "AsyncFileReader.h"
 #include "CompressedFileReader.h"
+#include "PrefetchFileReader.h"
 #include <memory>
 
 enum isoType
@@ -47,6 +48,7 @@ protected:
 protected:
 	wxString m_filename;
 	AsyncFileReader* m_reader;
+	PrefetchFileReader* m_prefetch; // m_reader when prefetch profiles are enabled
 
 	u32 m_current_lsn;
 
@@ -84,6 +86,7 @@ public:
 	bool Open(const wxString& srcfile, bool testOnly = false);
 	void Close();
 	bool Detect(bool readType = true);
+	void BindPrefetchProfile(const wxString& filename);
 
 	int ReadSync(u8* dst, uint lsn);
 
@@ -0,0 +1,384 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "PrefetchFileReader.h"
+
+#include <chrono>
+
+// Profile file: header followed by `count` Access records, in read order.
+static const u32 ProfileMagic = 0x50445643; // "CVDP"
+static const u32 ProfileVersion = 1;
+
+// Bounds the size of a recorded trace (8MB on disk).
+static const size_t MaxTraceLength = 1024 * 1024;
+
+// Profile entries searched past the cursor before falling back to the lsn index.
+static const size_t MatchWindow = 64;
+
+struct ProfileHeader
+{
+	u32 magic;
+	u32 version;
+	u32 blocks;
+	u32 count;
+};
+
+static u64 ElapsedNs(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+PrefetchFileReader::PrefetchFileReader(AsyncFileReader* source)
+	: m_source(source)
+	, m_result(0)
+	, m_cache(PREFETCH_CACHE_SIZE_MB)
+	, m_cursor(0)
+	, m_issued(0)
+	, m_quit(false)
+{
+	m_filename = source->GetFilename();
+	m_blocksize = source->GetBlockSize();
+	memzero(m_stats);
+}
+
+PrefetchFileReader::~PrefetchFileReader(void)
+{
+	Close();
+	delete m_source;
+}
+
+bool PrefetchFileReader::Open(const wxString& fileName)
+{
+	m_filename = fileName;
+	return m_source->Open(fileName);
+}
+
+void PrefetchFileReader::SetBlockSize(uint bytes)
+{
+	m_source->SetBlockSize(bytes);
+	m_blocksize = m_source->GetBlockSize();
+
+	std::lock_guard<std::mutex> lock(m_cache_lock);
+	m_cache.Clear();
+}
+
+// --------------------------------------------------------------------------------------
+//  Profiles
+// --------------------------------------------------------------------------------------
+
+bool PrefetchFileReader::LoadProfile(const wxString& filename)
+{
+	FILE* fp = wxFopen(filename, L"rb");
+	if (!fp)
+		return false;
+
+	ProfileHeader header;
+	bool ok = fread(&header, sizeof(header), 1, fp) == 1 && header.magic == ProfileMagic && header.version == ProfileVersion && header.blocks == GetBlockCount() && header.count <= MaxTraceLength;
+
+	if (ok)
+	{
+		m_profile.resize(header.count);
+		ok = fread(m_profile.data(), sizeof(Access), header.count, fp) == header.count;
+	}
+	fclose(fp);
+
+	if (!ok)
+	{
+		Console.Warning(L"(CdvdPrefetch) Ignoring profile %s recorded for another image or version.", WX_STR(filename));
+		m_profile.clear();
+		return false;
+	}
+
+	for (u32 i = 0; i < header.count; i++)
+		m_positions[m_profile[i].lsn].push_back(i);
+
+	return true;
+}
+
+void PrefetchFileReader::SaveProfile(const wxString& filename) const
+{
+	wxDirName(wxFileName(filename).GetPath()).Mkdir();
+
+	FILE* fp = wxFopen(filename, L"wb");
+	if (!fp)
+	{
+		Console.Warning(L"(CdvdPrefetch) Could not write profile %s", WX_STR(filename));
+		return;
+	}
+
+	ProfileHeader header = {ProfileMagic, ProfileVersion, GetBlockCount(), (u32)m_trace.size()};
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(m_trace.data(), sizeof(Access), m_trace.size(), fp);
+	fclose(fp);
+
+	DevCon.WriteLn(L"(CdvdPrefetch) Saved %u reads to %s", (uint)m_trace.size(), WX_STR(filename));
+}
+
+void PrefetchFileReader::BindProfile(const wxString& filename)
+{
+	if (filename == m_profile_name)
+		return;
+
+	StopWorker();
+
+	m_profile_name = filename;
+	m_profile.clear();
+	m_positions.clear();
+	m_cursor = 0;
+	m_issued = 0;
+
+	if (!LoadProfile(filename))
+	{
+		Console.WriteLn(L"(CdvdPrefetch) Recording a read profile for %s", WX_STR(wxFileName(filename).GetName()));
+		return;
+	}
+
+	Console.WriteLn(L"(CdvdPrefetch) Following %u recorded reads for %s", (uint)m_profile.size(), WX_STR(wxFileName(filename).GetName()));
+
+	m_quit = false;
+	m_worker = std::thread(&PrefetchFileReader::WorkerThread, this);
+}
+
+void PrefetchFileReader::ReportStats() const
+{
+	if (m_profile.empty() || !m_stats.reads)
+		return;
+
+	const u64 hits = m_stats.hits + m_stats.late_hits;
+	const double sector_ns = m_stats.prefetch_sectors ? (double)m_stats.prefetch_ns / m_stats.prefetch_sectors : 0.0;
+
+	Console.WriteLn("(CdvdPrefetch) %llu reads, %llu matched the profile, %.1f%% hits (%llu after waiting)",
+		m_stats.reads, m_stats.matched, 100.0 * hits / m_stats.reads, m_stats.late_hits);
+	Console.WriteLn("(CdvdPrefetch) stall %.1f ms in %llu missed sectors, about %.1f ms saved on %llu prefetched sectors",
+		m_stats.miss_ns / 1e6, m_stats.miss_sectors, m_stats.hit_sectors * sector_ns / 1e6, m_stats.hit_sectors);
+}
+
+// --------------------------------------------------------------------------------------
+//  Prefetch worker
+// --------------------------------------------------------------------------------------
+
+// Moves the cursor past the profile entry of the drive read. Reads that aren't near the
+// cursor resynchronize on the lsn, so a game taking another path than the recorded run
+// is followed again as soon as it reaches known ground.
+void PrefetchFileReader::Match(const Access& access)
+{
+	if (m_profile.empty())
+		return;
+
+	std::lock_guard<std::mutex> lock(m_queue_lock);
+
+	size_t found = m_profile.size();
+	const size_t end = std::min(m_profile.size(), m_cursor + MatchWindow);
+	for (size_t i = m_cursor; i < end; i++)
+	{
+		if (m_profile[i] == access)
+		{
+			found = i;
+			break;
+		}
+	}
+
+	if (found == m_profile.size())
+	{
+		auto it = m_positions.find(access.lsn);
+		if (it == m_positions.end())
+			return;
+
+		auto pos = std::lower_bound(it->second.begin(), it->second.end(), (u32)m_cursor);
+		found = pos != it->second.end() ? *pos : it->second.front();
+	}
+
+	m_stats.matched++;
+	m_cursor = found + 1;
+	if (m_issued < m_cursor || m_issued > m_cursor + PREFETCH_DEPTH)
+		m_issued = m_cursor;
+
+	m_queue_cv.notify_one();
+}
+
+void PrefetchFileReader::WorkerThread()
+{
+	const uint blocks = GetBlockCount();
+
+	while (true)
+	{
+		Access next;
+		{
+			std::unique_lock<std::mutex> lock(m_queue_lock);
+			m_queue_cv.wait(lock, [&] {
+				return m_quit || (m_issued < m_profile.size() && m_issued < m_cursor + PREFETCH_DEPTH);
+			});
+
+			if (m_quit)
+				return;
+
+			next = m_profile[m_issued++];
+		}
+
+		if (next.lsn >= blocks || next.count > blocks - next.lsn)
+			continue;
+
+		const int bytes = next.count * m_blocksize;
+		{
+			std::lock_guard<std::mutex> lock(m_cache_lock);
+			if (m_cache.Contains(Offset(next.lsn), bytes))
+				continue;
+		}
+
+		void* data = malloc(bytes);
+		if (!data)
+			continue;
+
+		const auto start = std::chrono::steady_clock::now();
+		int result;
+		{
+			std::lock_guard<std::mutex> lock(m_source_lock);
+			result = m_source->ReadSync(data, next.lsn, next.count);
+		}
+
+		if (result != bytes)
+		{
+			free(data);
+			continue;
+		}
+
+		m_stats.prefetch_ns += ElapsedNs(start);
+		m_stats.prefetch_sectors += next.count;
+
+		std::lock_guard<std::mutex> lock(m_cache_lock);
+		m_cache.Take(data, Offset(next.lsn), bytes, bytes);
+	}
+}
+
+void PrefetchFileReader::StopWorker()
+{
+	if (!m_worker.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_queue_lock);
+		m_quit = true;
+	}
+	m_queue_cv.notify_one();
+	m_worker.join();
+}
+
+// --------------------------------------------------------------------------------------
+//  AsyncFileReader interface
+// --------------------------------------------------------------------------------------
+
+int PrefetchFileReader::ReadSync(void* pBuffer, uint sector, uint count)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_cache_lock);
+		int result = m_cache.Read(pBuffer, Offset(sector), count * m_blocksize);
+		if (result >= 0)
+			return result;
+	}
+
+	std::lock_guard<std::mutex> lock(m_source_lock);
+	return m_source->ReadSync(pBuffer, sector, count);
+}
+
+void PrefetchFileReader::BeginRead(void* pBuffer, uint sector, uint count)
+{
+	const Access access = {sector, count};
+	if (m_trace.size() < MaxTraceLength && (m_trace.empty() || !(m_trace.back() == access)))
+		m_trace.push_back(access);
+
+	Match(access);
+	m_stats.reads++;
+
+	const int bytes = count * m_blocksize;
+	{
+		std::lock_guard<std::mutex> lock(m_cache_lock);
+		if (m_cache.Read(pBuffer, Offset(sector), bytes) >= 0)
+		{
+			m_stats.hits++;
+			m_stats.hit_sectors += count;
+			m_result = bytes;
+			return;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	m_pending = std::unique_lock<std::mutex>(m_source_lock);
+
+	// The worker may have been reading these sectors while we waited for it.
+	{
+		std::lock_guard<std::mutex> lock(m_cache_lock);
+		if (m_cache.Read(pBuffer, Offset(sector), bytes) >= 0)
+		{
+			m_pending.unlock();
+			m_stats.late_hits++;
+			m_stats.hit_sectors += count;
+			m_stats.miss_ns += ElapsedNs(start);
+			m_result = bytes;
+			return;
+		}
+	}
+
+	m_source->BeginRead(pBuffer, sector, count);
+	m_stats.miss_sectors += count;
+	m_stats.miss_ns += ElapsedNs(start);
+}
+
+int PrefetchFileReader::FinishRead(void)
+{
+	if (!m_pending.owns_lock())
+		return m_result;
+
+	const auto start = std::chrono::steady_clock::now();
+	int result = m_source->FinishRead();
+	m_pending.unlock();
+	m_stats.miss_ns += ElapsedNs(start);
+
+	return result;
+}
+
+void PrefetchFileReader::CancelRead(void)
+{
+	if (!m_pending.owns_lock())
+		return;
+
+	m_source->CancelRead();
+	m_pending.unlock();
+}
+
+void PrefetchFileReader::Close(void)
+{
+	StopWorker();
+	CancelRead();
+
+	// A longer trace covers more of the game than the stored one; keep the longest run.
+	if (!m_profile_name.IsEmpty() && m_trace.size() > m_profile.size())
+		SaveProfile(m_profile_name);
+
+	ReportStats();
+
+	m_profile_name.clear();
+	m_profile.clear();
+	m_positions.clear();
+	m_trace.clear();
+	memzero(m_stats);
+
+	{
+		std::lock_guard<std::mutex> lock(m_cache_lock);
+		m_cache.Clear();
+	}
+
+	m_source->Close();
+}
@@ -0,0 +1,121 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "AsyncFileReader.h"
+#include "ChunksCache.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define PREFETCH_CACHE_SIZE_MB 64 /* sectors read ahead of the drive, shared by all profile entries */
+#define PREFETCH_DEPTH 16         /* profile entries kept in flight ahead of the last matched read */
+
+// --------------------------------------------------------------------------------------
+//  PrefetchFileReader
+// --------------------------------------------------------------------------------------
+// Wraps the reader of a disc image, records the (lsn, count) sequence of the drive reads
+// and, once a profile recorded by an earlier run of the same game is bound, reads the
+// entries that followed the current read on a worker thread so that they are already
+// decompressed/read when the emulated drive asks for them.
+//
+// The wrapped reader isn't thread safe: the worker and the drive reads are serialized on
+// m_source_lock, which the drive keeps between BeginRead and FinishRead of a cache miss.
+class PrefetchFileReader : public AsyncFileReader
+{
+	DeclareNoncopyableObject(PrefetchFileReader);
+
+	struct Access
+	{
+		u32 lsn;
+		u32 count;
+
+		bool operator==(const Access& right) const { return lsn == right.lsn && count == right.count; }
+	};
+
+	AsyncFileReader* m_source;
+
+	std::mutex m_source_lock;
+	std::unique_lock<std::mutex> m_pending; // held by the drive from a missed BeginRead to its FinishRead
+	int m_result;
+
+	std::mutex m_cache_lock;
+	ChunksCache m_cache;
+
+	// Read sequence of this run, saved when the image is closed
+	std::vector<Access> m_trace;
+
+	// Profile of an earlier run and the first positions of each lsn in it
+	wxString m_profile_name;
+	std::vector<Access> m_profile;
+	std::unordered_map<u32, std::vector<u32>> m_positions;
+
+	std::mutex m_queue_lock;
+	std::condition_variable m_queue_cv;
+	size_t m_cursor; // profile entry expected after the last matched read
+	size_t m_issued; // next profile entry the worker will read
+	bool m_quit;
+	std::thread m_worker;
+
+	struct Stats
+	{
+		u64 reads;
+		u64 hits;       // served from the prefetched sectors without touching the image
+		u64 late_hits;  // prefetched while the drive waited for the worker's read
+		u64 matched;    // drive reads found in the profile
+		u64 miss_sectors;
+		u64 miss_ns;    // time the drive spent in missed reads
+		u64 hit_sectors;
+		u64 prefetch_sectors;
+		u64 prefetch_ns;
+	} m_stats;
+
+	void Match(const Access& access);
+	void WorkerThread();
+	void StopWorker();
+
+	bool LoadProfile(const wxString& filename);
+	void SaveProfile(const wxString& filename) const;
+	void ReportStats() const;
+
+	PX_off_t Offset(uint sector) const { return (PX_off_t)sector * m_blocksize; }
+
+public:
+	PrefetchFileReader(AsyncFileReader* source);
+	virtual ~PrefetchFileReader(void);
+
+	// Loads the profile recorded for the game (if any) and starts following it. The trace
+	// of this run is saved there when the image is closed.
+	void BindProfile(const wxString& filename);
+
+	virtual bool Open(const wxString& fileName);
+
+	virtual int ReadSync(void* pBuffer, uint sector, uint count);
+
+	virtual void BeginRead(void* pBuffer, uint sector, uint count);
+	virtual int FinishRead(void);
+	virtual void CancelRead(void);
+
+	virtual void Close(void);
+
+	virtual uint GetBlockCount(void) const { return m_source->GetBlockCount(); }
+
+	virtual void SetBlockSize(uint bytes);
+	virtual void SetDataOffset(int bytes) { m_source->SetDataOffset(bytes); }
+};
@@ -167,16 +167,20 @@ struct TraceLogFilters
 	TraceFiltersEE	EE;
 	TraceFiltersIOP	IOP;
 
+	// Size of the in-memory flight recorder, in KB (0 writes everything to the log file).
+	u32		RecorderKB;
+
 	TraceLogFilters()
 	{
 		Enabled	= false;
+		RecorderKB = 0;
 	}
 
 	void LoadSave( IniInterface& ini );
 
 	bool operator ==( const TraceLogFilters& right ) const
 	{
-		return OpEqu( Enabled ) && OpEqu( EE ) && OpEqu( IOP );
+		return OpEqu( Enabled ) && OpEqu( EE ) && OpEqu( IOP ) && OpEqu( RecorderKB );
 	}
 
 	bool operator !=( const TraceLogFilters& right ) const
@@ -208,21 +212,24 @@ struct Pcsx2Config
 				RecBlocks_EE:1,		// Enables per-block profiling for the EE recompiler [unimplemented]
 				RecBlocks_IOP:1,	// Enables per-block profiling for the IOP recompiler [unimplemented]
 				RecBlocks_VU0:1,	// Enables per-block profiling for the VU0 recompiler [unimplemented]
-				RecBlocks_VU1:1;	// Enables per-block profiling for the VU1 recompiler [unimplemented]
+				RecBlocks_VU1:1,	// Enables per-block profiling for the VU1 recompiler [unimplemented]
+				SampleStacks:1;		// The EE sampling profiler also walks the guest stack (folded stacks output)
 		BITFIELD_END
 
-		// Default is Disabled, with all recs enabled underneath.
-		ProfilerOptions() : bitset( 0xfffffffe ) {}
+		u32 SampleRate;			// EE/IOP samples per second of the sampling profiler
+
+		// Default is Disabled, with all recs enabled underneath and no stack walks.
+		ProfilerOptions() : bitset( 0xfffffffe ), SampleRate( 1000 ) { SampleStacks = false; }
 		void LoadSave( IniInterface& conf );
 
 		bool operator ==( const ProfilerOptions& right ) const
 		{
-			return OpEqu( bitset );
+			return OpEqu( bitset ) && OpEqu( SampleRate );
 		}
 
 		bool operator !=( const ProfilerOptions& right ) const
 		{
-			return !OpEqu( bitset );
+			return !this->operator ==( right );
 		}
 	};
 
@@ -257,6 +264,12 @@ struct Pcsx2Config
 				PreBlockCheckIOP:1;
 			bool
 				EnableEECache   :1;
+			bool
+				EnableFastmem	:1;		// EE loads/stores go through a host window of the EE address space
+			bool
+				PrecompileEE	:1;		// saves the blocks each game reaches and compiles them when it boots again
+			bool
+				EnableHugePages	:1;		// PS2 memory and the recompiler caches ask the host for 2MB pages
 		BITFIELD_END
 
 		RecompilerOptions();
@@ -407,12 +420,16 @@ struct Pcsx2Config
 				WaitLoop		:1,		// enables constant loop detection and fast-forwarding
 				vuFlagHack		:1,		// microVU specific flag hack
 				vuThread : 1,		// Enable Threaded VU1
-				vu1Instant : 1;		// Enable Instant VU1 (Without MTVU only)
+				vu1Instant : 1,		// Enable Instant VU1 (Without MTVU only)
+				vuPrecompile : 1;	// Compile VU1 programs uploaded with MPG on the idle MTVU thread
 		BITFIELD_END
 
 		s8	EECycleRate;		// EE cycle rate selector (1.0, 1.5, 2.0)
 		u8	EECycleSkip;		// EE Cycle skip factor (0, 1, 2, or 3)
 
+		uint	vuThreadSpinCount;	// MTVU ring waits: pause-spins before yielding
+		uint	vuThreadYieldCount;	// MTVU ring waits: yields before sleeping
+
 		SpeedhackOptions();
 		void LoadSave(IniInterface& conf);
 		SpeedhackOptions& DisableAll();
@@ -421,7 +438,8 @@ struct Pcsx2Config
 
 		bool operator ==( const SpeedhackOptions& right ) const
 		{
-			return OpEqu( bitset ) && OpEqu( EECycleRate ) && OpEqu( EECycleSkip );
+			return OpEqu( bitset ) && OpEqu( EECycleRate ) && OpEqu( EECycleSkip ) &&
+				OpEqu( vuThreadSpinCount ) && OpEqu( vuThreadYieldCount );
 		}
 
 		bool operator !=( const SpeedhackOptions& right ) const
@@ -465,6 +483,7 @@ struct Pcsx2Config
 			CdvdVerboseReads	:1,		// enables cdvd read activity verbosely dumped to the console
 			CdvdDumpBlocks		:1,		// enables cdvd block dumping
 			CdvdShareWrite		:1,		// allows the iso to be modified while it's loaded
+			CdvdPrefetchProfiles :1,	// records the iso reads of each game and prefetches them on later runs
 			EnablePatches		:1,		// enables patch detection and application
 			EnableCheats		:1,		// enables cheat detection and application
 			EnableIPC		    :1,		// enables inter-process communication 
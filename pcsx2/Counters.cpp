@@ -27,6 +27,7 @@
 
 #include "GS.h"
 #include "VUmicro.h"
+#include "MTVU.h"
 
 #include "ps2/HwInternal.h"
 
@@ -457,6 +458,10 @@ static __fi void VSyncStart(u32 sCycle)
 
 	CpuVU0->Vsync();
 	CpuVU1->Vsync();
+	if (THREAD_VU1)
+		vu1Thread.UpdateFrameStats();
+	if (CHECK_EEREC)
+		recUpdateDispatchStats();
 
 	hwIntcIrq(INTC_VBLANK_S);
 	psxVBlankStart();
@@ -26,6 +26,10 @@ u32 CBreakPoints::breakSkipFirstAt_ = 0;
 u64 CBreakPoints::breakSkipFirstTicks_ = 0;
 std::vector<MemCheck> CBreakPoints::memChecks_;
 std::vector<MemCheck *> CBreakPoints::cleanupMemChecks_;
+u32 CBreakPoints::memCheckReadPages_[MEMCHECK_PAGE_WORDS];
+u32 CBreakPoints::memCheckWritePages_[MEMCHECK_PAGE_WORDS];
+size_t CBreakPoints::numReadMemChecks_ = 0;
+size_t CBreakPoints::numWriteMemChecks_ = 0;
 bool CBreakPoints::breakpointTriggered_ = false;
 
 // called from the dynarec
@@ -294,12 +298,14 @@ void CBreakPoints::AddMemCheck(u32 start, u32 end, MemCheckCondition cond, MemCh
 		check.result = result;
 
 		memChecks_.push_back(check);
+		UpdateMemCheckPages();
 		Update();
 	}
 	else
 	{
 		memChecks_[mc].cond = (MemCheckCondition)(memChecks_[mc].cond | cond);
 		memChecks_[mc].result = (MemCheckResult)(memChecks_[mc].result | result);
+		UpdateMemCheckPages();
 		Update();
 	}
 }
@@ -313,6 +319,7 @@ void CBreakPoints::RemoveMemCheck(u32 start, u32 end)
 	if (mc != INVALID_MEMCHECK)
 	{
 		memChecks_.erase(memChecks_.begin() + mc);
+		UpdateMemCheckPages();
 		Update();
 	}
 }
@@ -324,6 +331,7 @@ void CBreakPoints::ChangeMemCheck(u32 start, u32 end, MemCheckCondition cond, Me
 	{
 		memChecks_[mc].cond = cond;
 		memChecks_[mc].result = result;
+		UpdateMemCheckPages();
 		Update();
 	}
 }
@@ -336,6 +344,7 @@ void CBreakPoints::ClearAllMemChecks()
 	if (!memChecks_.empty())
 	{
 		memChecks_.clear();
+		UpdateMemCheckPages();
 		Update();
 	}
 }
@@ -371,11 +380,55 @@ const std::vector<MemCheck> CBreakPoints::GetMemCheckRanges()
 	return ranges;
 }
 
-const std::vector<MemCheck> CBreakPoints::GetMemChecks()
+const std::vector<MemCheck>& CBreakPoints::GetMemChecks()
 {
 	return memChecks_;
 }
 
+void CBreakPoints::UpdateMemCheckPages()
+{
+	memzero(memCheckReadPages_);
+	memzero(memCheckWritePages_);
+	numReadMemChecks_ = 0;
+	numWriteMemChecks_ = 0;
+
+	for (const MemCheck& check : memChecks_)
+	{
+		if (check.result == 0)
+			continue;
+
+		// Same bounds as the dynarec/interpreter compare against (end is exclusive).
+		u32 start = standardizeBreakpointAddress(check.start);
+		u32 end = standardizeBreakpointAddress(check.end);
+		if (end <= start)
+			continue;
+
+		if (check.cond & MEMCHECK_READ)
+			numReadMemChecks_++;
+		if (check.cond & MEMCHECK_WRITE)
+			numWriteMemChecks_++;
+
+		for (u32 page = start >> MEMCHECK_PAGE_BITS; page <= (end - 1) >> MEMCHECK_PAGE_BITS; page++)
+		{
+			if (check.cond & MEMCHECK_READ)
+				memCheckReadPages_[page / 32] |= 1u << (page % 32);
+			if (check.cond & MEMCHECK_WRITE)
+				memCheckWritePages_[page / 32] |= 1u << (page % 32);
+		}
+	}
+}
+
+bool CBreakPoints::IsMemCheckPage(u32 addr, u32 size, bool write)
+{
+	const u32* pages = write ? memCheckWritePages_ : memCheckReadPages_;
+
+	// An access never spans more than two pages.
+	u32 first = standardizeBreakpointAddress(addr) >> MEMCHECK_PAGE_BITS;
+	u32 last = standardizeBreakpointAddress(addr + size - 1) >> MEMCHECK_PAGE_BITS;
+
+	return ((pages[first / 32] >> (first % 32)) & 1) || ((pages[last / 32] >> (last % 32)) & 1);
+}
+
 const std::vector<BreakPoint> CBreakPoints::GetBreakpoints()
 {
 	return breakPoints_;
@@ -139,10 +139,16 @@ public:
 	// Includes uncached addresses.
 	static const std::vector<MemCheck> GetMemCheckRanges();
 
-	static const std::vector<MemCheck> GetMemChecks();
+	static const std::vector<MemCheck>& GetMemChecks();
 	static const std::vector<BreakPoint> GetBreakpoints();
 	static size_t GetNumMemchecks() { return memChecks_.size(); }
 
+	// Page granular memcheck filter, usable for every single access.  Returns false if no
+	// enabled memcheck of the given kind can be hit by an access of size bytes at addr.
+	static bool IsMemCheckPage(u32 addr, u32 size, bool write);
+	// Any enabled memcheck that triggers on loads (or stores)?
+	static bool HasMemChecks(bool write) { return (write ? numWriteMemChecks_ : numReadMemChecks_) != 0; }
+
 	static void Update(u32 addr = 0);
 
 	static void SetBreakpointTriggered(bool b) { breakpointTriggered_ = b; };
@@ -152,6 +158,8 @@ private:
 	static size_t FindBreakpoint(u32 addr, bool matchTemp = false, bool temp = false);
 	// Finds exactly, not using a range check.
 	static size_t FindMemCheck(u32 start, u32 end);
+	// Rebuilds the memcheck page bitmaps, must be called whenever memChecks_ changes.
+	static void UpdateMemCheckPages();
 
 	static std::vector<BreakPoint> breakPoints_;
 	static u32 breakSkipFirstAt_;
@@ -160,6 +168,14 @@ private:
 
 	static std::vector<MemCheck> memChecks_;
 	static std::vector<MemCheck *> cleanupMemChecks_;
+
+	// One bit per 4k page of the (standardized) address space.
+	static const u32 MEMCHECK_PAGE_BITS = 12;
+	static const u32 MEMCHECK_PAGE_WORDS = (1u << (32 - MEMCHECK_PAGE_BITS)) / 32;
+	static u32 memCheckReadPages_[MEMCHECK_PAGE_WORDS];
+	static u32 memCheckWritePages_[MEMCHECK_PAGE_WORDS];
+	static size_t numReadMemChecks_;
+	static size_t numWriteMemChecks_;
 };
 
 
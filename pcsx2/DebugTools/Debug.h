@@ -21,6 +21,23 @@
 extern FILE *emuLog;
 extern wxString emuLogName;
 
+struct EmuLogStats
+{
+	u64 lines;		// lines written by the async writer
+	u64 bytes;
+	u32 dropped;	// lines lost because a thread's ring was full
+};
+
+// Opens emuLog and routes all trace logging through the asynchronous writer thread.
+// recorderKB != 0 selects flight recorder mode: only the last recorderKB of lines are
+// kept in memory and written out by emuLogDump (or emuLogClose).
+extern void emuLogOpen( const wxString& filename, uint recorderKB = 0 );
+extern void emuLogClose();
+// Writes the flight recorder contents to emuLog; seconds != 0 limits the dump to the
+// last few seconds of logging.
+extern void emuLogDump( uint seconds = 0 );
+extern EmuLogStats emuLogGetStats();
+
 extern char* disVU0MicroUF(u32 code, u32 pc);
 extern char* disVU0MicroLF(u32 code, u32 pc);
 extern char* disVU1MicroUF(u32 code, u32 pc);
@@ -0,0 +1,249 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "GuestProfiler.h"
+#include "DebugInterface.h"
+#include "MipsStackWalk.h"
+#include "SymbolMap.h"
+#include "../R5900.h"
+#include "../R3000A.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Only one sample out of StackDivider walks the guest stack, the walk is much more
+// expensive than a pc sample and runs on the EE thread.
+static const uint StackDivider = 8;
+// Number of entries listed by each section of the text report.
+static const size_t ReportTopCount = 100;
+
+std::atomic<bool> guestProfilerStackRequest(false);
+
+static std::thread s_thread;
+static std::atomic<bool> s_running(false);
+static wxString s_basename;
+
+// Guards the tables below between the sampler, the EE thread and the report.
+static std::mutex s_lock;
+static std::unordered_map<u32, u32> s_eeHits;
+static std::unordered_map<u32, u32> s_iopHits;
+static std::map<std::vector<u32>, u32> s_stacks;
+static u64 s_samples = 0;
+static u64 s_idle = 0;
+static u64 s_reported = 0;
+static uint s_rate = 0;
+
+static void SamplerThread(uint rateHz, bool stacks)
+{
+	const std::chrono::microseconds period(1000000 / rateHz);
+	auto next = std::chrono::steady_clock::now();
+	u32 lastCycle = cpuRegs.cycle;
+	uint count = 0;
+
+	while (s_running.load(std::memory_order_relaxed))
+	{
+		next += period;
+		const auto now = std::chrono::steady_clock::now();
+		if (next < now)
+			next = now; // don't burst after a host stall
+		std::this_thread::sleep_until(next);
+
+		// Racy word reads of the other thread's registers, which is all a sample needs.
+		const u32 cycle = *(volatile u32*)&cpuRegs.cycle;
+		const u32 eepc = *(volatile u32*)&cpuRegs.pc;
+		const u32 ioppc = *(volatile u32*)&psxRegs.pc;
+
+		std::lock_guard<std::mutex> lock(s_lock);
+
+		// The EE isn't running (frame limiter, waiting on the GS...)
+		if (cycle == lastCycle)
+		{
+			s_idle++;
+			continue;
+		}
+		lastCycle = cycle;
+
+		s_eeHits[eepc]++;
+		s_iopHits[ioppc]++;
+		s_samples++;
+
+		if (stacks && (++count % StackDivider) == 0)
+			guestProfilerStackRequest.store(true, std::memory_order_relaxed);
+	}
+}
+
+void guestProfilerSampleStack()
+{
+	guestProfilerStackRequest.store(false, std::memory_order_relaxed);
+
+	std::vector<MipsStackWalk::StackFrame> frames;
+	try {
+		frames = MipsStackWalk::Walk(&r5900Debug, cpuRegs.pc, cpuRegs.GPR.n.ra.UL[0], cpuRegs.GPR.n.sp.UL[0], 0xFFFFFFFF, 0);
+	} catch (Exception::Ps2Generic&) {
+		return;
+	}
+
+	if (frames.empty())
+		return;
+
+	// Walk returns the innermost frame first, folded stacks start from the root.
+	std::vector<u32> key;
+	key.reserve(frames.size());
+	for (auto it = frames.rbegin(); it != frames.rend(); ++it)
+		key.push_back(it->entry);
+
+	std::lock_guard<std::mutex> lock(s_lock);
+	s_stacks[key]++;
+}
+
+// ------------------------------------------------------------------------------------------
+//  Report
+// ------------------------------------------------------------------------------------------
+
+static std::string AddressName(u32 pc)
+{
+	char buf[16];
+	snprintf(buf, sizeof(buf), "0x%08x", pc);
+	return buf;
+}
+
+static std::string FunctionName(u32 start)
+{
+	std::string label = symbolMap.GetLabelString(start);
+	return label.empty() ? AddressName(start) : label;
+}
+
+static std::string BlockName(u32 pc)
+{
+	const u32 start = symbolMap.GetFunctionStart(pc);
+	if (start == SymbolMap::INVALID_ADDRESS)
+		return AddressName(pc);
+
+	char offset[16];
+	snprintf(offset, sizeof(offset), "+0x%x", pc - start);
+	return AddressName(pc) + " " + FunctionName(start) + (pc != start ? offset : "");
+}
+
+typedef std::vector<std::pair<u32, u64>> SortedHits;
+
+template <typename T>
+static SortedHits SortHits(const T& hits)
+{
+	SortedHits sorted(hits.begin(), hits.end());
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<u32, u64>& a, const std::pair<u32, u64>& b) {
+		return a.second > b.second;
+	});
+	return sorted;
+}
+
+static void WriteHits(FILE* fp, const char* title, const SortedHits& hits, u64 total, std::string (*name)(u32))
+{
+	fprintf(fp, "\n== %s\n", title);
+	for (size_t i = 0; i < std::min(hits.size(), ReportTopCount); i++)
+	{
+		fprintf(fp, "%6.2f%% %8llu  %s\n", 100.0 * hits[i].second / total, (unsigned long long)hits[i].second, name(hits[i].first).c_str());
+	}
+}
+
+static void WriteReport()
+{
+	std::lock_guard<std::mutex> lock(s_lock);
+
+	if (!s_samples || s_samples == s_reported)
+		return;
+	s_reported = s_samples;
+
+	FILE* fp = wxFopen(s_basename + L".txt", L"w");
+	if (!fp)
+		return;
+
+	fprintf(fp, "EE sampling profile: %llu samples at %u Hz (%llu idle samples skipped)\n",
+		(unsigned long long)s_samples, s_rate, (unsigned long long)s_idle);
+
+	// Blocks outside of a known function are accounted under their own pc.
+	std::unordered_map<u32, u64> functions;
+	for (auto& hit : s_eeHits)
+	{
+		const u32 start = symbolMap.GetFunctionStart(hit.first);
+		functions[start != SymbolMap::INVALID_ADDRESS ? start : hit.first] += hit.second;
+	}
+
+	// The symbol map only knows about the EE program.
+	WriteHits(fp, "EE functions", SortHits(functions), s_samples, FunctionName);
+	WriteHits(fp, "EE blocks", SortHits(s_eeHits), s_samples, BlockName);
+	WriteHits(fp, "IOP blocks", SortHits(s_iopHits), s_samples, AddressName);
+	fclose(fp);
+
+	if (s_stacks.empty())
+		return;
+
+	fp = wxFopen(s_basename + L".folded", L"w");
+	if (!fp)
+		return;
+
+	for (auto& stack : s_stacks)
+	{
+		std::string line;
+		for (u32 entry : stack.first)
+		{
+			if (!line.empty())
+				line += ';';
+			line += FunctionName(entry);
+		}
+		fprintf(fp, "%s %u\n", line.c_str(), stack.second);
+	}
+	fclose(fp);
+}
+
+void guestProfilerStart(const wxString& basename, uint rateHz, bool stacks)
+{
+	if (s_running.load())
+		return;
+
+	s_basename = basename;
+	s_rate = std::max(1u, std::min(rateHz, 10000u));
+	s_running.store(true);
+	s_thread = std::thread(SamplerThread, s_rate, stacks);
+
+	Console.WriteLn("(GuestProfiler) Sampling the EE at %u Hz%s", s_rate, stacks ? " with stacks" : "");
+}
+
+void guestProfilerStop()
+{
+	if (!s_running.exchange(false))
+		return;
+
+	s_thread.join();
+	guestProfilerStackRequest.store(false);
+
+	WriteReport();
+}
+
+void guestProfilerReset()
+{
+	std::lock_guard<std::mutex> lock(s_lock);
+
+	s_eeHits.clear();
+	s_iopHits.clear();
+	s_stacks.clear();
+	s_samples = 0;
+	s_idle = 0;
+	s_reported = 0;
+}
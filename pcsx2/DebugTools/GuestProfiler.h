@@ -0,0 +1,45 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+
+// --------------------------------------------------------------------------------------
+//  Guest sampling profiler
+// --------------------------------------------------------------------------------------
+// A timer thread samples the EE and IOP pc at a fixed rate. The recompilers store the pc
+// of every block they branch to, so a sample is the block being executed; no code is
+// instrumented and it works in regular builds. The report aggregates the samples per
+// block and per SymbolMap function.
+//
+// With stacks enabled, some samples also ask the EE thread to walk its guest stack
+// (MipsStackWalk) at the next event test, which produces flamegraph folded stacks.
+
+// Starts sampling. The reports go to basename.txt and basename.folded when stopped.
+extern void guestProfilerStart(const wxString& basename, uint rateHz, bool stacks);
+// Stops the sampler thread and writes the reports. Samples accumulate over stop/start.
+extern void guestProfilerStop();
+extern void guestProfilerReset();
+
+extern std::atomic<bool> guestProfilerStackRequest;
+extern void guestProfilerSampleStack();
+
+// Called by the EE at every event test.
+static __fi void guestProfilerTest()
+{
+	if (guestProfilerStackRequest.load(std::memory_order_relaxed))
+		guestProfilerSampleStack();
+}
@@ -354,6 +354,24 @@ public:
 	uint			m_packet_size;		// size of the packet (data only, ie. not including the 16 byte command!)
 	uint			m_packet_writepos;	// index of the data location in the ringbuffer.
 
+	// Consecutive GS packets are batched so the GS thread only sees one m_WritePos update
+	// for all of them (see BeginPacketBatch). EE thread only.
+	uint			m_LocalWritePos;	// write position including packets not published to m_WritePos yet
+	int				m_BatchDepth;		// nesting level of BeginPacketBatch
+	uint			m_BatchedPackets;	// packets queued since the last publish
+
+	// Ring statistics (times are in GetCPUTicks() units). EE thread only.
+	struct FrameStats
+	{
+		u32 packets;		// Packets sent to the ring
+		u32 publishes;		// m_WritePos updates (ie. packet batches seen by the GS thread)
+		u64 bytes;			// GS data sent to the ring (copied or referenced)
+		u64 stallTicks;		// Time spent waiting for free ring space
+		u64 vsyncTicks;		// Time spent waiting on the vsync queue limit
+	};
+	FrameStats		m_FrameStats;
+	FrameStats		m_LastFrameStats;
+
 #ifdef RINGBUF_DEBUG_STACK
 	Threading::Mutex m_lock_Stack;
 #endif
@@ -373,16 +391,24 @@ public:
 	void WaitForOpen();
 	void Freeze( int mode, MTGS_FreezeData& data );
 
+	void BeginPacketBatch();
+	void EndPacketBatch();
+
 	void SendSimpleGSPacket( MTGS_RingCommand type, u32 offset, u32 size, GIF_PATH path );
 	void SendSimplePacket( MTGS_RingCommand type, int data0, int data1, int data2 );
 	void SendPointerPacket( MTGS_RingCommand type, u32 data0, void* data1 );
 
 	u8* GetDataPacketPtr() const;
 	void SetEvent();
+	// Wakes the GS thread without touching any EE-side state; safe from any thread.
+	void WakeUp() { m_sem_event.Post(); }
 	void PostVsyncStart();
 
 	bool IsPluginOpened() const { return m_PluginOpened; }
 
+	// Ring statistics of the last frame
+	const FrameStats& GetFrameStats() const { return m_LastFrameStats; }
+
 	void ExecuteTaskInThread();
 	void FinishTaskInThread();
 	void OpenPlugin();
@@ -399,8 +425,11 @@ protected:
 
 	void GenericStall( uint size );
 
+	void PublishWritePos();
+	void CommitWritePos( uint writepos, bool batchable );
+
 	// Used internally by SendSimplePacket type functions
-	void _FinishSimplePacket();
+	void _FinishSimplePacket( bool batchable = false );
 };
 
 // GetMTGS() is a required external implementation. This function is *NOT* provided
@@ -410,6 +439,13 @@ protected:
 //
 extern SysMtgsThread& GetMTGS();
 
+// Groups all GS packets queued within its scope into as few ring publishes as possible.
+struct ScopedMTGSPacketBatch
+{
+	ScopedMTGSPacketBatch() { GetMTGS().BeginPacketBatch(); }
+	~ScopedMTGSPacketBatch() { GetMTGS().EndPacketBatch(); }
+};
+
 /////////////////////////////////////////////////////////////////////////////
 // Generalized GS Functions and Stuff
 
@@ -699,6 +699,7 @@ struct Gif_Unit
 			DevCon.Error("Gif Unit - Signal or PSE Set or Dir = GS to EE");
 			return 0;
 		}
+		ScopedMTGSPacketBatch batch;
 		bool didPath3 = false;
 		int curPath = stat.APATH > 0 ? stat.APATH - 1 : 0; //Init to zero if no path is already set.
 		gifPath[2].dmaRewind = 0;
@@ -73,10 +73,13 @@ void intMemcheck(u32 op, u32 bits, bool store)
 	if (bits == 128)
 		start &= ~0x0F;
 
+	if (!CBreakPoints::IsMemCheckPage(start, bits/8, store))
+		return;
+
 	start = standardizeBreakpointAddress(start);
 	u32 end = start + bits/8;
 	
-	auto checks = CBreakPoints::GetMemChecks();
+	const auto& checks = CBreakPoints::GetMemChecks();
 	for (size_t i = 0; i < checks.size(); i++)
 	{
 		auto& check = checks[i];
@@ -88,7 +91,7 @@ void intMemcheck(u32 op, u32 bits, bool store)
 		if ((check.cond & MEMCHECK_READ) == 0 && !store)
 			continue;
 
-		if (start < check.end && check.start < end)
+		if (start < standardizeBreakpointAddress(check.end) && standardizeBreakpointAddress(check.start) < end)
 			intBreakpoint(true);
 	}
 }
@@ -28,6 +28,17 @@
 // Uncomment this to enable profiling of the GS RingBufferCopy function.
 //#define PCSX2_GSRING_SAMPLING_STATS
 
+// Uncomment this to print the ring statistics every frame.
+//#define PCSX2_GSRING_FRAME_STATS
+
+// Maximum number of GS packets queued before the write position is published
+// to the GS thread, even if the batch isn't finished yet.
+static const uint MTGS_BatchMaxPackets = 32;
+
+// Safety valve for the libretro GS loop: wake up every now and then even if nobody
+// kicked us (queued wx events and ring data both post m_sem_event).
+static const int MTGS_SafetyWakeMs = 100;
+
 using namespace Threading;
 
 #if 0 //PCSX2_DEBUG
@@ -73,6 +84,11 @@ void SysMtgsThread::OnStart()
 	m_RingBufferIsBusy  = false;
 	m_packet_size		= 0;
 	m_packet_writepos	= 0;
+	m_LocalWritePos		= 0;
+	m_BatchDepth		= 0;
+	m_BatchedPackets	= 0;
+	memzero(m_FrameStats);
+	memzero(m_LastFrameStats);
 
 	m_QueuedFrameCount    = 0;
 	m_VsyncSignalListener = false;
@@ -106,6 +122,7 @@ void SysMtgsThread::ResetGS()
 	//  * Signal a reset.
 	//  * clear the path and byRegs structs (used by GIFtagDummy)
 
+	PublishWritePos();
 	m_ReadPos             = m_WritePos.load();
 	m_QueuedFrameCount    = 0;
 	m_VsyncSignalListener = 0;
@@ -146,6 +163,15 @@ void SysMtgsThread::PostVsyncStart()
 	// Vsyncs should always start the GS thread, regardless of how little has actually be queued.
 	if (m_CopyDataTally != 0) SetEvent();
 
+	m_LastFrameStats = m_FrameStats;
+	memzero(m_FrameStats);
+#ifdef PCSX2_GSRING_FRAME_STATS
+	Console.WriteLn("MTGS: %u packets, %u publishes, %llu kb, stall %lluus, vsync wait %lluus",
+		m_LastFrameStats.packets, m_LastFrameStats.publishes, (unsigned long long)(m_LastFrameStats.bytes / _1kb),
+		(unsigned long long)(m_LastFrameStats.stallTicks * 1000000 / GetTickFrequency()),
+		(unsigned long long)(m_LastFrameStats.vsyncTicks * 1000000 / GetTickFrequency()));
+#endif
+
 	// If the MTGS is allowed to queue a lot of frames in advance, it creates input lag.
 	// Use the Queued FrameCount to stall the EE if another vsync (or two) are already queued
 	// in the ringbuffer.  The queue limit is disabled when both FrameLimiting and Vsync are
@@ -168,7 +194,9 @@ void SysMtgsThread::PostVsyncStart()
 	// So let's ensure the ring doesn't sleep
 	m_sem_event.Post();
 
+	const u64 waitStart = GetCPUTicks();
 	m_sem_Vsync.WaitNoCancel();
+	m_FrameStats.vsyncTicks += GetCPUTicks() - waitStart;
 }
 
 union PacketTagType
@@ -304,7 +332,10 @@ void SysMtgsThread::ExecuteTaskInThread()
 		while (wxTheApp->HasPendingEvents())
 			wxTheApp->ProcessPendingEvents();
 
-		while (!m_sem_event.WaitWithoutYield(wxTimeSpan::Millisecond()))
+		// Sleep until the EE kicks us or an event gets queued (see Pcsx2App::WakeUpIdle)
+		// instead of polling the pending events every millisecond. A wake-up caused by
+		// an event just runs an empty ring pass; the events are handled at the loop top.
+		while (!m_sem_event.WaitWithoutYield(wxTimeSpan::Milliseconds(MTGS_SafetyWakeMs)))
 		{
 			while (wxTheApp->HasPendingEvents())
 				wxTheApp->ProcessPendingEvents();
@@ -681,6 +712,10 @@ void SysMtgsThread::WaitGS(bool syncRegs, bool weakWait, bool isMTVU)
 	Gif_Path&   path = gifUnit.gifPath[GIF_PATH_1];
 	u32 startP1Packs = weakWait ? path.GetPendingGSPackets() : 0;
 
+	// Packets held back by a batch must be visible before we can wait on them.
+	// The MTVU thread never owns the EE-side batch, so it leaves it alone.
+	if (!isMTVU) PublishWritePos();
+
 	// Both m_ReadPos and m_WritePos can be relaxed as we only want to test if the queue is empty but
 	// we don't want to access the content of the queue
 
@@ -720,6 +755,51 @@ void SysMtgsThread::SetEvent()
 	m_CopyDataTally = 0;
 }
 
+// Makes every packet written so far visible to the GS thread.
+// Threading info: run in EE thread
+void SysMtgsThread::PublishWritePos()
+{
+	m_BatchedPackets = 0;
+	if (m_WritePos.load(std::memory_order_relaxed) == m_LocalWritePos) return;
+
+	m_WritePos.store(m_LocalWritePos, std::memory_order_release);
+	++m_FrameStats.publishes;
+}
+
+// Advances the EE-side write position past a finished packet. Outside of a batch (or for
+// packets the GS thread must see right away) it is published immediately; inside a batch the
+// release store is deferred until the batch ends or MTGS_BatchMaxPackets packets are queued.
+void SysMtgsThread::CommitWritePos( uint writepos, bool batchable )
+{
+	m_LocalWritePos = writepos;
+	++m_FrameStats.packets;
+
+	if (batchable && m_BatchDepth && !EmuConfig.GS.SynchronousMTGS)
+	{
+		if (++m_BatchedPackets < MTGS_BatchMaxPackets) return;
+	}
+
+	PublishWritePos();
+}
+
+// Starts a group of GS packets that are published to the GS thread as one.
+// Batches nest; only the outermost EndPacketBatch publishes.
+void SysMtgsThread::BeginPacketBatch()
+{
+	++m_BatchDepth;
+}
+
+void SysMtgsThread::EndPacketBatch()
+{
+	pxAssert( m_BatchDepth > 0 );
+	if (--m_BatchDepth) return;
+
+	PublishWritePos();
+
+	// SendSimpleGSPacket doesn't kick the GS thread while batching; catch up here.
+	if (m_CopyDataTally > 0x2000) SetEvent();
+}
+
 u8* SysMtgsThread::GetDataPacketPtr() const
 {
 	return (u8*)&RingBuffer[m_packet_writepos & RingBufferMask];
@@ -738,7 +818,8 @@ void SysMtgsThread::SendDataPacket()
 	PacketTagType& tag = (PacketTagType&)RingBuffer[m_packet_startpos];
 	tag.data[0] = actualSize;
 
-	m_WritePos.store(m_packet_writepos, std::memory_order_release);
+	m_FrameStats.bytes += actualSize * 16;
+	CommitWritePos(m_packet_writepos, false);
 
 	if(EmuConfig.GS.SynchronousMTGS)
 	{
@@ -757,10 +838,10 @@ void SysMtgsThread::SendDataPacket()
 
 void SysMtgsThread::GenericStall( uint size )
 {
-	// Note on volatiles: m_WritePos is not modified by the GS thread, so there's no need
-	// to use volatile reads here.  We do cache it though, since we know it never changes,
-	// except for calls to RingbufferRestert() -- handled below.
-	const uint writepos = m_WritePos.load(std::memory_order_relaxed);
+	// Note: the EE-side write position (m_LocalWritePos) is only ever touched by this
+	// thread, so it can be cached.  Any packets still held back by a batch are published
+	// before we go to sleep below, otherwise the GS thread would never make room for us.
+	const uint writepos = m_LocalWritePos;
 
 	// Sanity checks! (within the confines of our ringbuffer please!)
 	pxAssert( size < RingBufferSize );
@@ -781,6 +862,9 @@ void SysMtgsThread::GenericStall( uint size )
 
 	if (freeroom <= size)
 	{
+		PublishWritePos();
+		const u64 stallStart = GetCPUTicks();
+
 		// writepos will overlap readpos if we commit the data, so we need to wait until
 		// readpos is out past the end of the future write pos, or until it wraps around
 		// (in which case writepos will be >= readpos).
@@ -836,6 +920,8 @@ void SysMtgsThread::GenericStall( uint size )
 				if (freeroom > size) break;
 			}
 		}
+
+		m_FrameStats.stallTicks += GetCPUTicks() - stallStart;
 	}
 }
 
@@ -847,7 +933,7 @@ void SysMtgsThread::PrepDataPacket( MTGS_RingCommand cmd, u32 size )
 
 	// Command qword: Low word is the command, and the high word is the packet
 	// length in SIMDs (128 bits).
-	const unsigned int local_WritePos = m_WritePos.load(std::memory_order_relaxed);
+	const unsigned int local_WritePos = m_LocalWritePos;
 
 	PacketTagType& tag = (PacketTagType&)RingBuffer[local_WritePos];
 	tag.command = cmd;
@@ -868,11 +954,11 @@ void SysMtgsThread::PrepDataPacket( GIF_PATH pathidx, u32 size )
 	PrepDataPacket( (MTGS_RingCommand)pathidx, size );
 }
 
-__fi void SysMtgsThread::_FinishSimplePacket()
+__fi void SysMtgsThread::_FinishSimplePacket( bool batchable )
 {
-	uint future_writepos = (m_WritePos.load(std::memory_order_relaxed) +1) & RingBufferMask;
+	uint future_writepos = (m_LocalWritePos +1) & RingBufferMask;
 	pxAssert( future_writepos != m_ReadPos.load(std::memory_order_acquire) );
-	m_WritePos.store(future_writepos, std::memory_order_release);
+	CommitWritePos(future_writepos, batchable);
 
 	if( EmuConfig.GS.SynchronousMTGS )
 		WaitGS();
@@ -885,7 +971,7 @@ void SysMtgsThread::SendSimplePacket( MTGS_RingCommand type, int data0, int data
 	//ScopedLock locker( m_PacketLocker );
 
 	GenericStall(1);
-	PacketTagType& tag = (PacketTagType&)RingBuffer[m_WritePos.load(std::memory_order_relaxed)];
+	PacketTagType& tag = (PacketTagType&)RingBuffer[m_LocalWritePos];
 
 	tag.command = type;
 	tag.data[0] = data0;
@@ -897,12 +983,23 @@ void SysMtgsThread::SendSimplePacket( MTGS_RingCommand type, int data0, int data
 
 void SysMtgsThread::SendSimpleGSPacket(MTGS_RingCommand type, u32 offset, u32 size, GIF_PATH path)
 {
-	SendSimplePacket(type, (int)offset, (int)size, (int)path);
+	GenericStall(1);
+	PacketTagType& tag = (PacketTagType&)RingBuffer[m_LocalWritePos];
+
+	tag.command = type;
+	tag.data[0] = (int)offset;
+	tag.data[1] = (int)size;
+	tag.data[2] = (int)path;
+
+	// MTVU packets are completed by the VU thread, which the GS thread will wait on;
+	// they have to reach the GS thread right away.
+	_FinishSimplePacket(type == GS_RINGTYPE_GSPACKET);
+	m_FrameStats.bytes += size;
 
 	if(!EmuConfig.GS.SynchronousMTGS) {
 		if(!m_RingBufferIsBusy.load(std::memory_order_relaxed)) {
 			m_CopyDataTally += size / 16;
-			if (m_CopyDataTally > 0x2000) SetEvent();
+			if (m_CopyDataTally > 0x2000 && !m_BatchDepth) SetEvent();
 		}
 	}
 }
@@ -912,7 +1009,7 @@ void SysMtgsThread::SendPointerPacket( MTGS_RingCommand type, u32 data0, void* d
 	//ScopedLock locker( m_PacketLocker );
 
 	GenericStall(1);
-	PacketTagType& tag = (PacketTagType&)RingBuffer[m_WritePos.load(std::memory_order_relaxed)];
+	PacketTagType& tag = (PacketTagType&)RingBuffer[m_LocalWritePos];
 
 	tag.command = type;
 	tag.data[0] = data0;
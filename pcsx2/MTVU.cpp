@@ -23,6 +23,7 @@ __aligned16 VU_Thread vu1Thread(CpuVU1, VU1);
 
 #define MTVU_ALWAYS_KICK 0
 #define MTVU_SYNC_MODE 0
+#define MTVU_PRINT_STATS 0 // Print ring statistics every frame
 
 // Rounds up a size in bytes for size in u32's
 static __fi u32 size_u32(u32 x) { return (x + 3) >> 2; }
@@ -105,11 +106,20 @@ void VU_Thread::Reset()
 	m_write_pos = 0;
 	m_ato_read_pos = 0;
 	m_read_pos = 0;
+	m_precompiling = false;
+	m_precompileHold = false;
 	memzero(vif);
 	memzero(vifRegs);
 	for (size_t i = 0; i < 4; ++i)
 		vu1Thread.vuCycles[i] = 0;
 	vu1Thread.gsInterrupts = 0;
+
+	m_vuIdleTicks = 0;
+	m_eeStallTicks = 0;
+	m_ringUsedSum = 0;
+	m_ringUsedPeak = 0;
+	m_ringCommits = 0;
+	memzero(m_lastFrameStats);
 }
 
 void VU_Thread::ExecuteTaskInThread()
@@ -125,7 +135,7 @@ void VU_Thread::ExecuteRingBuffer()
 {
 	for (;;)
 	{
-		semaEvent.WaitWithoutYield();
+		WaitForWork();
 		ScopedLockBool lock(mtxBusy, isBusy);
 		while (m_ato_read_pos.load(std::memory_order_relaxed) != GetWritePos())
 		{
@@ -188,14 +198,87 @@ void VU_Thread::ExecuteRingBuffer()
 
 			CommitReadPos();
 		}
+
+		// Nothing left to run: compile the programs just uploaded with MPG before the EE
+		// starts them, new packets interrupt this between two programs.
+		// WaitVU() holds this off: either it sees m_precompiling set, or we see its hold.
+		if (EmuConfig.Speedhacks.vuPrecompile)
+		{
+			for (;;)
+			{
+				m_precompiling.store(true, std::memory_order_seq_cst);
+				const bool more = !m_precompileHold.load(std::memory_order_seq_cst)
+					&& m_ato_read_pos.load(std::memory_order_relaxed) == GetWritePos()
+					&& vuCPU->Precompile();
+				m_precompiling.store(false, std::memory_order_release);
+				if (!more)
+					break;
+			}
+		}
+	}
+}
+
+
+// Waits for the EE to queue more packets. Short VU1 programs leave the thread
+// idle for very little time, so spin and yield for a while before paying for
+// the semaphore round trip.
+void VU_Thread::WaitForWork()
+{
+	const u32 spinCount = EmuConfig.Speedhacks.vuThreadSpinCount;
+	const u32 yieldCount = EmuConfig.Speedhacks.vuThreadYieldCount;
+	const u64 start = GetCPUTicks();
+
+	if (spinCount || yieldCount)
+	{
+		// We're awake, so KickStart() doesn't need to post the semaphore
+		isBusy.store(true, std::memory_order_seq_cst);
+		for (u32 i = 0; i < spinCount + yieldCount; i++)
+		{
+			if (m_ato_read_pos.load(std::memory_order_relaxed) != GetWritePos())
+			{
+				isBusy.store(false, std::memory_order_release);
+				m_vuIdleTicks.fetch_add(GetCPUTicks() - start, std::memory_order_relaxed);
+				return;
+			}
+			if (i < spinCount)
+				Threading::SpinWait();
+			else
+				std::this_thread::yield();
+		}
+		// Re-check after clearing isBusy, the EE might not have kicked us
+		isBusy.store(false, std::memory_order_seq_cst);
+		if (m_ato_read_pos.load(std::memory_order_relaxed) == GetWritePos())
+			semaEvent.WaitWithoutYield();
+	}
+	else
+	{
+		semaEvent.WaitWithoutYield();
 	}
+
+	m_vuIdleTicks.fetch_add(GetCPUTicks() - start, std::memory_order_relaxed);
 }
 
+// Single step of the EE side ring waits: spin, then yield, then sleep until
+// the VU thread is done with what it is currently processing.
+__fi void VU_Thread::WaitStep(u32& iteration)
+{
+	const u32 spinCount = EmuConfig.Speedhacks.vuThreadSpinCount;
+	const u32 yieldCount = EmuConfig.Speedhacks.vuThreadYieldCount;
+
+	if (iteration < spinCount)
+		Threading::SpinWait();
+	else if (iteration < spinCount + yieldCount)
+		std::this_thread::yield();
+	else
+		ScopedLock lock(mtxBusy);
+	iteration++;
+}
 
 // Should only be called by ReserveSpace()
 __ri void VU_Thread::WaitOnSize(s32 size)
 {
-	for (;;)
+	u64 stallStart = 0;
+	for (u32 iteration = 0;;)
 	{
 		s32 readPos = GetReadPos();
 		if (readPos <= m_write_pos)
@@ -208,14 +291,16 @@ __ri void VU_Thread::WaitOnSize(s32 size)
 		if (readPos > m_write_pos + size + _4kb)
 			break; // Enough free front space
 		{          // Let MTVU run to free up buffer space
+			if (!stallStart)
+				stallStart = GetCPUTicks();
 			KickStart();
-			// Locking might trigger a full flush of the ring buffer. Yield
-			// will be more aggressive, and only flush the minimal size.
-			// Performance will be smoother but it will consume extra CPU cycle
-			// on the EE thread (not an issue on 4 cores).
-			std::this_thread::yield();
+			// Locking might trigger a full flush of the ring buffer, so spin
+			// and yield first to only flush the minimal size.
+			WaitStep(iteration);
 		}
 	}
+	if (stallStart)
+		m_eeStallTicks += GetCPUTicks() - stallStart;
 }
 
 // Makes sure theres enough room in the ring buffer
@@ -260,6 +345,14 @@ __fi u32* VU_Thread::GetWritePtr()
 __fi void VU_Thread::CommitWritePos()
 {
 	m_ato_write_pos.store(m_write_pos, std::memory_order_release);
+	m_precompileHold.store(false, std::memory_order_relaxed);
+
+	s32 used = m_write_pos - GetReadPos();
+	if (used < 0)
+		used += buffer_size;
+	m_ringUsedSum += used;
+	m_ringUsedPeak = std::max(m_ringUsedPeak, (u32)used);
+	m_ringCommits++;
 
 	if (MTVU_ALWAYS_KICK)
 		KickStart();
@@ -398,22 +491,50 @@ void VU_Thread::KickStart(bool forceKick)
 
 bool VU_Thread::IsDone()
 {
-	return GetReadPos() == GetWritePos();
+	return GetReadPos() == GetWritePos() && !m_precompiling.load(std::memory_order_seq_cst);
 }
 
 void VU_Thread::WaitVU()
 {
 	MTVU_LOG("MTVU - WaitVU!");
-	for (;;)
+	// The caller may reset or free the microVU structures once we return, so the VU thread
+	// mustn't start precompiling again until more packets are queued
+	m_precompileHold.store(true, std::memory_order_seq_cst);
+	u64 stallStart = 0;
+	for (u32 iteration = 0;;)
 	{
 		if (IsDone())
 			break;
 		//DevCon.WriteLn("WaitVU()");
 		//pxAssert(THREAD_VU1);
+		if (!stallStart)
+			stallStart = GetCPUTicks();
 		KickStart();
-		std::this_thread::yield(); // Give a chance to the MTVU thread to actually start
-		ScopedLock lock(mtxBusy);
+		WaitStep(iteration); // Give a chance to the MTVU thread to actually start
 	}
+	if (stallStart)
+		m_eeStallTicks += GetCPUTicks() - stallStart;
+}
+
+void VU_Thread::UpdateFrameStats()
+{
+	m_lastFrameStats.eeStallTicks = m_eeStallTicks;
+	m_lastFrameStats.vuIdleTicks = m_vuIdleTicks.exchange(0, std::memory_order_relaxed);
+	m_lastFrameStats.ringUsedPeak = m_ringUsedPeak * sizeof(u32);
+	m_lastFrameStats.ringUsedAvg = m_ringCommits ? (u32)(m_ringUsedSum / m_ringCommits * sizeof(u32)) : 0;
+	m_lastFrameStats.ringCommits = m_ringCommits;
+
+	m_eeStallTicks = 0;
+	m_ringUsedSum = 0;
+	m_ringUsedPeak = 0;
+	m_ringCommits = 0;
+
+	if (MTVU_PRINT_STATS)
+		DevCon.WriteLn("MTVU: EE stall %lluus, VU idle %lluus, ring peak %ukb avg %ukb (%u packets)",
+			(unsigned long long)(m_lastFrameStats.eeStallTicks * 1000000 / GetTickFrequency()),
+			(unsigned long long)(m_lastFrameStats.vuIdleTicks * 1000000 / GetTickFrequency()),
+			m_lastFrameStats.ringUsedPeak / _1kb, m_lastFrameStats.ringUsedAvg / _1kb,
+			m_lastFrameStats.ringCommits);
 }
 
 void VU_Thread::ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop)
@@ -34,6 +34,8 @@ class VU_Thread : public pxThread {
 	__aligned(64) std::atomic<bool> isBusy;   // Is thread processing data?
 	__aligned(64) std::atomic<int> m_ato_read_pos; // Only modified by VU thread
 	__aligned(64) std::atomic<int> m_ato_write_pos;    // Only modified by EE thread
+	__aligned(64) std::atomic<bool> m_precompiling;    // VU thread is in vuCPU->Precompile()
+	__aligned(64) std::atomic<bool> m_precompileHold;  // Set by WaitVU(), cleared when the EE queues more packets
 	__aligned(64) int  m_read_pos; // temporary read pos (local to the VU thread)
 	int  m_write_pos; // temporary write pos (local to the EE thread)
 	Mutex     mtxBusy;
@@ -41,7 +43,23 @@ class VU_Thread : public pxThread {
 	BaseVUmicroCPU*& vuCPU;
 	VURegs&          vuRegs;
 
+	// Ring statistics of the current frame
+	__aligned(64) std::atomic<u64> m_vuIdleTicks; // Only modified by VU thread
+	u64 m_eeStallTicks; // EE thread only
+	u64 m_ringUsedSum;  // EE thread only
+	u32 m_ringUsedPeak; // EE thread only
+	u32 m_ringCommits;  // EE thread only
+
 public:
+	// Ring statistics of the last frame (times are in GetCPUTicks() units)
+	struct FrameStats {
+		u64 eeStallTicks; // Time the EE spent waiting on the VU thread in WaitOnSize()/WaitVU()
+		u64 vuIdleTicks;  // Time the VU thread spent waiting for work
+		u32 ringUsedPeak; // Highest ring occupancy seen when committing packets (in bytes)
+		u32 ringUsedAvg;  // Average ring occupancy seen when committing packets (in bytes)
+		u32 ringCommits;  // Number of packets committed
+	};
+
 	__aligned16  vifStruct        vif;
 	__aligned16  VIFregisters     vifRegs;
 	Semaphore semaXGkick;
@@ -72,6 +90,10 @@ public:
 	// Waits till MTVU is done processing
 	void WaitVU();
 
+	// Moves the current frame's ring statistics to GetFrameStats() (called on vsync)
+	void UpdateFrameStats();
+	const FrameStats& GetFrameStats() const { return m_lastFrameStats; }
+
 	void Get_GSChanges();
 
 	void ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop);
@@ -92,8 +114,12 @@ protected:
 	void ExecuteTaskInThread();
 
 private:
+	FrameStats m_lastFrameStats;
+
 	void ExecuteRingBuffer();
+	void WaitForWork();
 
+	void WaitStep(u32& iteration);
 	void WaitOnSize(s32 size);
 	void ReserveSpace(s32 size);
 
@@ -718,8 +718,15 @@ void eeMemoryReserve::Reserve(VirtualMemoryManagerPtr allocator)
 
 void eeMemoryReserve::Commit()
 {
+	const bool wasCommitted = IsCommitted();
+
 	_parent::Commit();
 	eeMem = (EEVM_MemoryAllocMess*)m_reserve.GetPtr();
+
+	// The fastmem window aliases eeMem, which has to be moved onto shared memory before
+	// anything is loaded into it.
+	if (!wasCommitted && EmuConfig.Cpu.Recompiler.EnableFastmem)
+		vtlb_FastmemAttach(eeMem, sizeof(*eeMem));
 }
 
 // Resets memory mappings, unmaps TLBs, reloads bios roms, etc.
@@ -853,6 +860,7 @@ void eeMemoryReserve::Reset()
 
 void eeMemoryReserve::Decommit()
 {
+	vtlb_FastmemDetach();
 	_parent::Decommit();
 	eeMem = NULL;
 }
@@ -951,6 +959,7 @@ void mmap_MarkCountedRamPage( u32 paddr )
 
 	m_PageProtectInfo[rampage].Mode = ProtMode_Write;
 	HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadOnly() );
+	vtlb_FastmemProtectRamPage( rampage, false );
 }
 
 // offset - offset of address relative to psM.
@@ -968,6 +977,7 @@ static __fi void mmap_ClearCpuBlock( uint offset )
 		"Attempted to clear a block that is already under manual protection." );
 
 	HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadWrite() );
+	vtlb_FastmemProtectRamPage( rampage, true );
 	m_PageProtectInfo[rampage].Mode = ProtMode_Manual;
 	Cpu->Clear( m_PageProtectInfo[rampage].ReverseRamMap, 0x400 );
 }
@@ -978,7 +988,13 @@ void mmap_PageFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& h
 
 	// get bad virtual address
 	uptr offset = info.addr - (uptr)eeMem->Main;
-	if( offset >= Ps2MemSize::MainRam ) return;
+	if( offset >= Ps2MemSize::MainRam )
+	{
+		// Recompiled code may also write through the fastmem window's alias of the page.
+		u32 alias_offset;
+		if( !vtlb_FastmemGetRamOffset( info.addr, alias_offset ) ) return;
+		offset = alias_offset;
+	}
 
 	mmap_ClearCpuBlock( offset );
 	handled = true;
@@ -993,4 +1009,5 @@ void mmap_ResetBlockTracking()
 	//DbgCon.WriteLn( "vtlb/mmap: Block Tracking reset..." );
 	memzero( m_PageProtectInfo );
 	if (eeMem) HostSys::MemProtect( eeMem->Main, Ps2MemSize::MainRam, PageAccess_ReadWrite() );
+	vtlb_FastmemUnprotectRam();
 }
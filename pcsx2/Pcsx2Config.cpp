@@ -34,6 +34,7 @@ void TraceLogFilters::LoadSave( IniInterface& ini )
 
 	IniEntry( EE.bitset );
 	IniEntry( IOP.bitset );
+	IniEntry( RecorderKB );
 }
 
 const wxChar* const tbl_SpeedhackNames[] =
@@ -70,6 +71,10 @@ Pcsx2Config::SpeedhackOptions::SpeedhackOptions()
 	IntcStat = true;
 	vuFlagHack = true;
 	vu1Instant = true;
+	vuPrecompile = true;
+
+	vuThreadSpinCount = 512;
+	vuThreadYieldCount = 32;
 }
 
 Pcsx2Config::SpeedhackOptions& Pcsx2Config::SpeedhackOptions::DisableAll()
@@ -93,6 +98,9 @@ void Pcsx2Config::SpeedhackOptions::LoadSave( IniInterface& ini )
 	IniBitBool(vuFlagHack);
 	IniBitBool(vuThread);
 	IniBitBool(vu1Instant);
+	IniBitBool(vuPrecompile);
+	IniEntry(vuThreadSpinCount);
+	IniEntry(vuThreadYieldCount);
 }
 
 void Pcsx2Config::ProfilerOptions::LoadSave( IniInterface& ini )
@@ -104,6 +112,8 @@ void Pcsx2Config::ProfilerOptions::LoadSave( IniInterface& ini )
 	IniBitBool( RecBlocks_IOP );
 	IniBitBool( RecBlocks_VU0 );
 	IniBitBool( RecBlocks_VU1 );
+	IniBitBool( SampleStacks );
+	IniEntry( SampleRate );
 }
 
 Pcsx2Config::RecompilerOptions::RecompilerOptions()
@@ -175,6 +185,9 @@ void Pcsx2Config::RecompilerOptions::LoadSave( IniInterface& ini )
 	IniBitBool( EnableEE );
 	IniBitBool( EnableIOP );
 	IniBitBool( EnableEECache );
+	IniBitBool( EnableFastmem );
+	IniBitBool( PrecompileEE );
+	IniBitBool( EnableHugePages );
 	IniBitBool( EnableVU0 );
 	IniBitBool( EnableVU1 );
 
@@ -470,6 +483,7 @@ void Pcsx2Config::LoadSave( IniInterface& ini )
 	IniBitBool( CdvdVerboseReads );
 	IniBitBool( CdvdDumpBlocks );
 	IniBitBool( CdvdShareWrite );
+	IniBitBool( CdvdPrefetchProfiles );
 	IniBitBool( EnablePatches );
 	IniBitBool( EnableCheats );
 	IniBitBool( EnableIPC );
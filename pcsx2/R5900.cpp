@@ -36,6 +36,7 @@
 #include "GameDatabase.h"
 
 #include "../DebugTools/Breakpoints.h"
+#include "../DebugTools/GuestProfiler.h"
 #include "R5900OpcodeTables.h"
 
 using namespace R5900;	// for R5900 disasm tools
@@ -370,6 +371,8 @@ __fi void _cpuEventTest_Shared()
 	ScopedBool etest(eeEventTestIsActive);
 	g_nextEventCycle = cpuRegs.cycle + eeWaitCycles;
 
+	guestProfilerTest();
+
 	// ---- INTC / DMAC (CPU-level Exceptions) -----------------
 	// Done first because exceptions raised during event tests need to be postponed a few
 	// cycles (fixes Grandia II [PAL], which does a spin loop on a vsync and expects to
@@ -788,8 +791,16 @@ int isMemcheckNeeded(u32 pc)
 	u32 op = memRead32(addr);
 	const OPCODE& opcode = GetInstruction(op);
 
-	if (opcode.flags & IS_MEMORY)
-		return addr == pc ? 1 : 2;
+	if (!(opcode.flags & IS_MEMORY))
+		return 0;
+
+	// Skip accesses no memcheck can ever trigger on: wrong access type, or an
+	// absolute ($zero based) address in a page without any memcheck.
+	bool store = (opcode.flags & IS_STORE) != 0;
+	if (!CBreakPoints::HasMemChecks(store))
+		return 0;
+	if (((op >> 21) & 0x1F) == 0 && !CBreakPoints::IsMemCheckPage((s16)op, 16, store))
+		return 0;
 
-	return 0;
+	return addr == pc ? 1 : 2;
 }
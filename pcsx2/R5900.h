@@ -400,6 +400,18 @@ extern R5900cpu *Cpu;
 extern R5900cpu intCpu;
 extern R5900cpu recCpu;
 
+// EE recompiler register jump statistics for the previous frame.
+struct recDispatchStats
+{
+	u32 dispatches;		// entries into the generic dispatcher (recLUT lookup)
+	u32 rasHits;		// JR $ra predicted by the return stack
+	u32 cacheHits;		// register jumps predicted by their site's last target
+	u32 cacheRefills;	// register jump site caches updated with a new target
+};
+
+extern void recUpdateDispatchStats();
+extern recDispatchStats recGetDispatchStats();
+
 enum EE_EventType
 {
 	DMAC_VIF0	= 0,
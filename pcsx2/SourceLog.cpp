@@ -27,8 +27,15 @@
 #	include <sys/time.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdarg>
 #include <ctype.h>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "R3000A.h"
 #include "iR5900.h"
@@ -45,13 +52,377 @@ SysConsoleLogPack SysConsole;
 
 typedef void Fntype_SrcLogPrefix( FastFormatAscii& dest );
 
+// Uncomment this to run a quick sync vs. async trace log benchmark every time the log is opened.
+//#define PCSX2_TRACELOG_BENCHMARK
+
+// --------------------------------------------------------------------------------------
+//  Asynchronous emuLog writer
+// --------------------------------------------------------------------------------------
+// Lines are formatted on the calling thread and copied into a per-thread single producer /
+// single consumer ring, along with a binary timestamp.  A background thread drains all the
+// rings (merged in timestamp order) and does the file I/O, so emulation threads never block
+// on fputs/fflush.  If a ring is full the line is dropped and counted instead of stalling.
+//
+// In flight recorder mode only the most recent RecorderKB worth of lines are kept in memory,
+// overwriting the oldest ones.  They are written to the log by emuLogDump() or on close.
+
+static const u32 TraceRingSize = _256kb;
+static const u32 TraceRingMask = TraceRingSize - 1;
+static const u32 TraceMaxLine = 4096;
+static const u32 TraceWrapMarker = ~0u;
+
+struct TraceRecordHeader
+{
+	u64 ticks;
+	u32 length;		// text length, or TraceWrapMarker to skip to the ring start
+	u32 thread;		// index of the producer's ring
+};
+
+static_assert( sizeof(TraceRecordHeader) == 16, "TraceRecordHeader must stay 16 bytes" );
+
+struct TraceThreadBuffer
+{
+	std::atomic<u32> writePos;		// producer only (monotonic, masked on access)
+	std::atomic<u32> readPos;		// consumer only
+	std::atomic<u32> dropped;
+	u32 index;
+	__aligned16 u8 data[TraceRingSize];
+
+	TraceThreadBuffer( u32 idx ) : writePos(0), readPos(0), dropped(0), index(idx) {}
+};
+
+struct TraceLine
+{
+	u64 ticks;
+	u32 thread;
+	std::string text;
+};
+
+// Rings are never freed: a thread may still hold its pointer after the log is closed.
+static std::mutex s_trace_buffers_lock;
+static std::vector<std::unique_ptr<TraceThreadBuffer>> s_trace_buffers;
+static DeclareTls(TraceThreadBuffer*) s_trace_tls = NULL;
+
+static std::atomic<bool> s_trace_async(false);
+static std::thread s_trace_thread;
+static std::mutex s_trace_notify_lock;
+static std::condition_variable s_trace_notify_cv;
+static bool s_trace_quit = false;
+
+// Held while draining, the rings have a single consumer no matter who drains them.
+static std::mutex s_trace_drain_lock;
+static std::vector<TraceLine> s_trace_pending;
+static std::deque<TraceLine> s_trace_recorder;
+static size_t s_trace_recorder_bytes = 0;
+static size_t s_trace_recorder_limit = 0;
+static u64 s_trace_start_ticks = 0;
+
+static std::atomic<u64> s_trace_lines(0);
+static std::atomic<u64> s_trace_bytes(0);
+
+static TraceThreadBuffer& emuLogThreadBuffer()
+{
+	if( s_trace_tls == NULL )
+	{
+		std::lock_guard<std::mutex> guard(s_trace_buffers_lock);
+		s_trace_buffers.emplace_back( new TraceThreadBuffer((u32)s_trace_buffers.size()) );
+		s_trace_tls = s_trace_buffers.back().get();
+	}
+	return *s_trace_tls;
+}
+
+static void emuLogPush( const char* text, u32 length )
+{
+	TraceThreadBuffer& buf = emuLogThreadBuffer();
+	length = std::min( length, TraceMaxLine );
+
+	const u32 recSize = (sizeof(TraceRecordHeader) + length + 15) & ~15;
+	u32 writepos = buf.writePos.load(std::memory_order_relaxed);
+	const u32 readpos = buf.readPos.load(std::memory_order_acquire);
+	u32 offset = writepos & TraceRingMask;
+
+	// Records never wrap, the tail of the ring is skipped instead.
+	const u32 pad = (offset + recSize > TraceRingSize) ? TraceRingSize - offset : 0;
+	const u32 used = writepos - readpos;
+	if( used + pad + recSize > TraceRingSize )
+	{
+		buf.dropped.fetch_add(1, std::memory_order_relaxed);
+		s_trace_notify_cv.notify_one();
+		return;
+	}
+
+	if( pad )
+	{
+		((TraceRecordHeader*)&buf.data[offset])->length = TraceWrapMarker;
+		writepos += pad;
+		offset = 0;
+	}
+
+	TraceRecordHeader& hdr = (TraceRecordHeader&)buf.data[offset];
+	hdr.ticks = GetCPUTicks();
+	hdr.length = length;
+	hdr.thread = buf.index;
+	memcpy( &buf.data[offset + sizeof(TraceRecordHeader)], text, length );
+
+	writepos += recSize;
+	buf.writePos.store(writepos, std::memory_order_release);
+
+	// Wake the writer early when a ring fills up; otherwise it polls on its own.
+	if( used + pad + recSize > TraceRingSize / 2 )
+		s_trace_notify_cv.notify_one();
+}
+
+static void emuLogWriteLine( FILE* fp, const TraceLine& line )
+{
+	const double secs = (double)(s64)(line.ticks - s_trace_start_ticks) / (double)GetTickFrequency();
+	fprintf( fp, "[%12.6f] %s\n", secs, line.text.c_str() );
+}
+
+// Moves every queued line out of the rings and into the log (or the flight recorder).
+static void emuLogDrain()
+{
+	std::lock_guard<std::mutex> drain(s_trace_drain_lock);
+
+	{
+		std::lock_guard<std::mutex> guard(s_trace_buffers_lock);
+		for( auto& ptr : s_trace_buffers )
+		{
+			TraceThreadBuffer& buf = *ptr;
+			u32 readpos = buf.readPos.load(std::memory_order_relaxed);
+			const u32 writepos = buf.writePos.load(std::memory_order_acquire);
+
+			while( readpos != writepos )
+			{
+				const u32 offset = readpos & TraceRingMask;
+				const TraceRecordHeader& hdr = (TraceRecordHeader&)buf.data[offset];
+				if( hdr.length == TraceWrapMarker )
+				{
+					readpos += TraceRingSize - offset;
+					continue;
+				}
+
+				TraceLine line;
+				line.ticks = hdr.ticks;
+				line.thread = hdr.thread;
+				line.text.assign( (const char*)&buf.data[offset + sizeof(TraceRecordHeader)], hdr.length );
+				s_trace_pending.push_back( std::move(line) );
+
+				readpos += (sizeof(TraceRecordHeader) + hdr.length + 15) & ~15;
+			}
+
+			buf.readPos.store(readpos, std::memory_order_release);
+		}
+	}
+
+	if( s_trace_pending.empty() ) return;
+
+	std::stable_sort( s_trace_pending.begin(), s_trace_pending.end(),
+		[]( const TraceLine& a, const TraceLine& b ) { return a.ticks < b.ticks; } );
+
+	u64 bytes = 0;
+	for( auto& line : s_trace_pending )
+	{
+		bytes += line.text.size() + 1;
+		if( s_trace_recorder_limit )
+		{
+			s_trace_recorder_bytes += line.text.size();
+			s_trace_recorder.push_back( std::move(line) );
+		}
+		else if( emuLog != NULL )
+		{
+			emuLogWriteLine( emuLog, line );
+		}
+	}
+
+	while( s_trace_recorder_bytes > s_trace_recorder_limit && !s_trace_recorder.empty() )
+	{
+		s_trace_recorder_bytes -= s_trace_recorder.front().text.size();
+		s_trace_recorder.pop_front();
+	}
+
+	s_trace_lines.fetch_add( s_trace_pending.size(), std::memory_order_relaxed );
+	s_trace_bytes.fetch_add( bytes, std::memory_order_relaxed );
+	s_trace_pending.clear();
+
+	if( emuLog != NULL && !s_trace_recorder_limit )
+		fflush( emuLog );
+}
+
+static void emuLogThread()
+{
+	std::unique_lock<std::mutex> guard(s_trace_notify_lock);
+	while( !s_trace_quit )
+	{
+		s_trace_notify_cv.wait_for( guard, std::chrono::milliseconds(10) );
+
+		guard.unlock();
+		emuLogDrain();
+		guard.lock();
+	}
+}
+
+#ifdef PCSX2_TRACELOG_BENCHMARK
+// Compares the old synchronous fputs/fflush path against the async rings (emulation thread
+// cost per line), and measures how fast the writer thread drains them.
+static void emuLogBenchmark( uint lines )
+{
+	FILE* fp = tmpfile();
+	if( fp == NULL ) return;
+
+	const double freq = (double)GetTickFrequency();
+	const char* text = "eDis(001a2b3c 00dead00): lq      a0, 0x0010(sp)";
+	const u32 length = strlen(text);
+
+	u64 start = GetCPUTicks();
+	for( uint i = 0; i < lines; ++i )
+	{
+		fputs( text, fp );
+		fputs( "\n", fp );
+		fflush( fp );
+	}
+	const double syncSecs = (GetCPUTicks() - start) / freq;
+
+	// Keep the benchmark lines out of the real log.
+	FILE* log = emuLog;
+	emuLog = fp;
+
+	const u64 startLines = s_trace_lines.load();
+	const u32 startDropped = emuLogGetStats().dropped;
+	start = GetCPUTicks();
+	for( uint i = 0; i < lines; ++i )
+		emuLogPush( text, length );
+	const double pushSecs = (GetCPUTicks() - start) / freq;
+	emuLogDrain();
+	const double drainSecs = (GetCPUTicks() - start) / freq;
+
+	emuLog = log;
+	fclose( fp );
+
+	Console.WriteLn( Color_StrongGreen, "TraceLog benchmark (%u lines):", lines );
+	Console.Indent().WriteLn( "sync  : %8.0f lines/s, %6.0f ns per line on the caller", lines / syncSecs, syncSecs * 1e9 / lines );
+	Console.Indent().WriteLn( "async : %8.0f lines/s, %6.0f ns per line on the caller, %u dropped",
+		lines / pushSecs, pushSecs * 1e9 / lines, emuLogGetStats().dropped - startDropped );
+	Console.Indent().WriteLn( "writer: %8.0f lines/s", (s_trace_lines.load() - startLines) / drainSecs );
+}
+#endif
+
+void emuLogOpen( const wxString& filename, uint recorderKB )
+{
+	if( s_trace_async.load() || emuLog != NULL ) return;
+
+	emuLogName = filename;
+	emuLog = wxFopen( filename, L"w" );
+	if( emuLog == NULL )
+	{
+		Console.Error( L"TraceLog: Could not open %s", WX_STR(filename) );
+		return;
+	}
+
+	// Anything left over from a previous session is stale.
+	s_trace_recorder_limit = 0;
+	emuLogDrain();
+	s_trace_recorder.clear();
+	s_trace_recorder_bytes = 0;
+	s_trace_recorder_limit = (size_t)recorderKB * _1kb;
+	s_trace_start_ticks = GetCPUTicks();
+	s_trace_lines = 0;
+	s_trace_bytes = 0;
+
+	s_trace_quit = false;
+	try
+	{
+		s_trace_thread = std::thread(emuLogThread);
+	}
+	catch( std::system_error& )
+	{
+		// Falls back to synchronous writes.
+		Console.Error( "TraceLog: Could not start the writer thread" );
+		return;
+	}
+
+	s_trace_async.store(true, std::memory_order_release);
+
+#ifdef PCSX2_TRACELOG_BENCHMARK
+	emuLogBenchmark( 1000000 );
+#endif
+}
+
+void emuLogClose()
+{
+	if( s_trace_async.exchange(false) )
+	{
+		{
+			std::lock_guard<std::mutex> guard(s_trace_notify_lock);
+			s_trace_quit = true;
+		}
+		s_trace_notify_cv.notify_one();
+		s_trace_thread.join();
+
+		emuLogDrain();
+		if( s_trace_recorder_limit )
+			emuLogDump();
+
+		const EmuLogStats stats( emuLogGetStats() );
+		const double secs = (double)(GetCPUTicks() - s_trace_start_ticks) / (double)GetTickFrequency();
+		DevCon.WriteLn( "TraceLog: %llu lines (%llu kb) in %.1f s, %u dropped",
+			(unsigned long long)stats.lines, (unsigned long long)(stats.bytes / _1kb), secs, stats.dropped );
+	}
+
+	if( emuLog != NULL )
+	{
+		fclose( emuLog );
+		emuLog = NULL;
+	}
+}
+
+void emuLogDump( uint seconds )
+{
+	if( !s_trace_recorder_limit || emuLog == NULL ) return;
+
+	emuLogDrain();
+
+	std::lock_guard<std::mutex> drain(s_trace_drain_lock);
+	if( s_trace_recorder.empty() ) return;
+
+	const u64 last = s_trace_recorder.back().ticks;
+	const u64 window = (u64)seconds * GetTickFrequency();
+
+	fprintf( emuLog, "---- flight recorder dump (%u lines) ----\n", (uint)s_trace_recorder.size() );
+	for( const TraceLine& line : s_trace_recorder )
+	{
+		if( seconds && last - line.ticks > window ) continue;
+		emuLogWriteLine( emuLog, line );
+	}
+	fflush( emuLog );
+}
+
+EmuLogStats emuLogGetStats()
+{
+	EmuLogStats stats;
+	stats.lines = s_trace_lines.load(std::memory_order_relaxed);
+	stats.bytes = s_trace_bytes.load(std::memory_order_relaxed);
+	stats.dropped = 0;
+
+	std::lock_guard<std::mutex> guard(s_trace_buffers_lock);
+	for( auto& buf : s_trace_buffers )
+		stats.dropped += buf->dropped.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
 // writes text directly to the logfile, no newlines appended.
 void __Log( const char* fmt, ... )
 {
 	va_list list;
 	va_start(list, fmt);
 
-	if( emuLog != NULL )
+	if( s_trace_async.load(std::memory_order_acquire) )
+	{
+		FastFormatAscii ascii;
+		ascii.WriteV(fmt,list);
+		emuLogPush( ascii.c_str(), strlen(ascii.c_str()) );
+	}
+	else if( emuLog != NULL )
 	{
 		fputs( FastFormatAscii().WriteV(fmt,list), emuLog );
 		fputs( "\n", emuLog );
@@ -63,6 +434,12 @@ void __Log( const char* fmt, ... )
 
 void SysTraceLog::DoWrite( const char *msg ) const
 {
+	if( s_trace_async.load(std::memory_order_acquire) )
+	{
+		emuLogPush( msg, strlen(msg) );
+		return;
+	}
+
 	if( emuLog == NULL ) return;
 
 	fputs( msg, emuLog );
@@ -77,6 +77,8 @@ void RecompiledCodeReserve::Reset()
 
 bool RecompiledCodeReserve::Commit()
 {
+	SetHugePagesOnCommit(EmuConfig.Cpu.Recompiler.EnableHugePages);
+
 #ifdef __LIBRETRO__
    return _parent::Commit();
 #else
@@ -153,6 +153,14 @@ public:
 	// there is another gif path 2/3 transfer already taking place.
 	// Use this method to resume execution of VU1.
 	virtual void ResumeXGkick() {}
+
+	// Compiles one of the programs expected to be started from the micro memory written since
+	// the last execution, ahead of that execution. Returns true while candidates remain.
+	//
+	// Thread Affinity:
+	//   Called from the thread owning the VU (the MTVU thread for VU1), when it is idle.
+	//
+	virtual bool Precompile() { return false; }
 };
 
 
@@ -246,6 +254,7 @@ public:
 	void Clear(u32 addr, u32 size);
 	void Vsync() noexcept;
 	void ResumeXGkick();
+	bool Precompile();
 
 	uint GetCacheReserve() const;
 	void SetCacheReserve( uint reserveInMegs ) const;
@@ -396,6 +396,11 @@ public:
 	void DispatchUiSettingsEvent( IniInterface& ini );
 	void DispatchVmSettingsEvent( IniInterface& ini );
 
+#ifdef __LIBRETRO__
+	// There's no wx event loop in the core: queued events are pumped by the GS thread.
+	void WakeUpIdle() override;
+#endif
+
 	// ----------------------------------------------------------------------------
 protected:
 	int								m_PendingSaves;
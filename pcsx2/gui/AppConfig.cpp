@@ -988,6 +988,9 @@ bool AppConfig::IsOkApplyPreset(int n, bool ignoreMTVU)
 	EmuOptions.Speedhacks.bitset	= 0; //Turn off individual hacks to make it visually clear they're not used.
 	EmuOptions.Speedhacks.vuThread	= original_SpeedHacks.vuThread;
 	EmuOptions.Speedhacks.vu1Instant = original_SpeedHacks.vu1Instant;
+	EmuOptions.Speedhacks.vuPrecompile = original_SpeedHacks.vuPrecompile;
+	EmuOptions.Speedhacks.vuThreadSpinCount = original_SpeedHacks.vuThreadSpinCount;
+	EmuOptions.Speedhacks.vuThreadYieldCount = original_SpeedHacks.vuThreadYieldCount;
 	EnableSpeedHacks = true;
 	// Actual application of current preset over the base settings which all presets use (mostly pcsx2's default values).
 
@@ -1042,6 +1045,7 @@ void AppConfig::ResetPresetSettingsToDefault() {
 	EmuOptions.Speedhacks.EECycleSkip = 0;
 	EmuOptions.Speedhacks.vuThread = false;
 	EmuOptions.Speedhacks.vu1Instant = true;
+	EmuOptions.Speedhacks.vuPrecompile = true;
 	EmuOptions.Speedhacks.IntcStat = true;
 	EmuOptions.Speedhacks.WaitLoop = true;
 	EmuOptions.Speedhacks.vuFlagHack = true;
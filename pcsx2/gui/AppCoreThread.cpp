@@ -30,6 +30,8 @@
 #include "Elfheader.h"
 #include "Patch.h"
 #include "R5900Exceptions.h"
+#include "DebugTools/GuestProfiler.h"
+#include "x86/iR5900HotBlocks.h"
 #include "Sio.h"
 
 
@@ -587,6 +589,9 @@ void LoadAllPatchesAndStuff(const Pcsx2Config& cfg)
 	Pcsx2Config dummy;
 	PatchesVerboseReset();
 	_ApplySettings(cfg, dummy);
+
+	// The entry block compiled after this precompiles the profiled blocks from there.
+	eeHotBlocks.SetFolder(GetSettingsFolder().Combine(wxDirName(L"eerec")));
 }
 
 void AppCoreThread::ApplySettings(const Pcsx2Config& src)
@@ -639,12 +644,21 @@ void AppCoreThread::OnResumeInThread(bool isSuspended)
 		m_resetCdvd = false;
 	}
 
+	if (EmuConfig.Trace.Enabled)
+		emuLogOpen(GetLogFolder().Combine(wxFileName(L"emuLog.txt")).GetFullPath(), EmuConfig.Trace.RecorderKB);
+	else
+		emuLogClose();
+
+	if (EmuConfig.Profiler.Enabled)
+		guestProfilerStart(GetLogFolder().Combine(wxFileName(L"eeProfile")).GetFullPath(), EmuConfig.Profiler.SampleRate, EmuConfig.Profiler.SampleStacks);
+
 	_parent::OnResumeInThread(isSuspended);
 	PostCoreStatus(CoreThread_Resumed);
 }
 
 void AppCoreThread::OnSuspendInThread()
 {
+	guestProfilerStop();
 	_parent::OnSuspendInThread();
 	PostCoreStatus(CoreThread_Suspended);
 }
@@ -658,6 +672,9 @@ void AppCoreThread::OnCleanupInThread()
 	m_ExecMode = ExecMode_Closing;
 	PostCoreStatus(CoreThread_Stopped);
 	_parent::OnCleanupInThread();
+	emuLogClose();
+	guestProfilerStop();
+	guestProfilerReset();
 }
 
 void AppCoreThread::GameStartingInThread()
@@ -350,6 +350,15 @@ void Pcsx2App::PostAppMethod( FnPtr_Pcsx2App method )
 	PostEvent( Pcsx2AppMethodEvent( method ) );
 }
 
+#ifdef __LIBRETRO__
+// Called by wx whenever an event is queued; the GS thread sleeps on its ring semaphore
+// in between frames, so kick it to get the event processed.
+void Pcsx2App::WakeUpIdle()
+{
+	mtgsThread.WakeUp();
+}
+#endif
+
 SysMainMemory& Pcsx2App::GetVmReserve()
 {
 	if (!m_VmReserve) m_VmReserve = std::unique_ptr<SysMainMemory>(new SysMainMemory());
@@ -658,6 +658,239 @@ __fi u32 vtlb_V2P(u32 vaddr)
 	return paddr;
 }
 
+// --------------------------------------------------------------------------------------
+//  Fastmem window
+// --------------------------------------------------------------------------------------
+// EE memory is backed by a shared memory object, and every vmap entry that points into it is
+// also mapped at s_fastmem_base + vaddr.  The rest of the window (I/O, unmapped pages and
+// memory owned by other components) stays inaccessible, so the recompiler can access
+// s_fastmem_base[vaddr] directly and count on a page fault to send it back to the vtlb path.
+//
+// Only supported on hosts that can alias memory (see HostSys::CreateSharedMemory), and only
+// set up when EnableFastmem is set at the time EE memory is committed.
+
+static const u64 FASTMEM_WINDOW_SIZE = 0x100000000ull;
+static const u32 FASTMEM_RAM_PAGES = Ps2MemSize::MainRam >> VTLB_PAGE_BITS;
+
+static u8* s_fastmem_base = NULL;
+static void* s_fastmem_shm = NULL;
+static uptr s_fastmem_shm_ptr = 0;
+static u32 s_fastmem_shm_pages = 0;
+
+// State of each window page: shared memory page + 1, or 0 when inaccessible.
+static u32* s_fastmem_pages = NULL;
+
+// Window aliases of each main ram page, so that the block tracking write protection
+// (see mmap_MarkCountedRamPage) can be mirrored onto them.
+static std::vector<u32> s_fastmem_ram_alias[FASTMEM_RAM_PAGES];
+static bool s_fastmem_ram_readonly[FASTMEM_RAM_PAGES];
+
+static __fi u8* FastmemPagePtr(u32 vpage)
+{
+	return s_fastmem_base + ((uptr)vpage << VTLB_PAGE_BITS);
+}
+
+// Main ram sits at the start of EEVM_MemoryAllocMess, so shared memory page N is ram page N.
+static __fi bool FastmemIsRam(u32 state)
+{
+	return state && (state - 1) < FASTMEM_RAM_PAGES;
+}
+
+static u32 FastmemWantedState(u32 vpage)
+{
+	const u32 vaddr = vpage << VTLB_PAGE_BITS;
+	const VTLBVirtual vmv = vtlbdata.vmap[vpage];
+	if (vmv.isHandler(vaddr))
+		return 0;
+
+	const uptr offset = vmv.assumePtr(vaddr) - s_fastmem_shm_ptr;
+	if ((offset & VTLB_PAGE_MASK) || offset >= ((uptr)s_fastmem_shm_pages << VTLB_PAGE_BITS))
+		return 0;
+
+	return (offset >> VTLB_PAGE_BITS) + 1;
+}
+
+static void FastmemSetState(u32 vpage, u32 state)
+{
+	const u32 old = s_fastmem_pages[vpage];
+	if (FastmemIsRam(old))
+	{
+		std::vector<u32>& alias = s_fastmem_ram_alias[old - 1];
+		alias.erase(std::find(alias.begin(), alias.end(), vpage));
+	}
+	if (FastmemIsRam(state))
+		s_fastmem_ram_alias[state - 1].push_back(vpage);
+
+	s_fastmem_pages[vpage] = state;
+}
+
+// Applies a run of pages whose state has already been updated: either all inaccessible,
+// or mapping consecutive shared memory pages starting at state.
+static void FastmemApplyRun(u32 vpage, u32 count, u32 state)
+{
+	const size_t size = (size_t)count << VTLB_PAGE_BITS;
+
+	if (state && !HostSys::MapSharedMemory(s_fastmem_shm, (size_t)(state - 1) << VTLB_PAGE_BITS, FastmemPagePtr(vpage), size, PageAccess_ReadWrite()))
+	{
+		// Most likely out of mappings (vm.max_map_count).  Leave the pages inaccessible;
+		// recompiled code will fault and fall back to the vtlb path.
+		Console.Warning("(vtlb) Fastmem: failed to alias 0x%08x -> 0x%08x", vpage << VTLB_PAGE_BITS, (vpage + count) << VTLB_PAGE_BITS);
+		for (u32 i = 0; i < count; i++)
+			FastmemSetState(vpage + i, 0);
+		state = 0;
+	}
+
+	if (!state)
+	{
+		HostSys::MmapResetPtr(FastmemPagePtr(vpage), size);
+		return;
+	}
+
+	for (u32 i = 0; i < count; i++)
+	{
+		const u32 page_state = state + i;
+		if (FastmemIsRam(page_state) && s_fastmem_ram_readonly[page_state - 1])
+			HostSys::MemProtect(FastmemPagePtr(vpage + i), __pagesize, PageAccess_ReadOnly());
+	}
+}
+
+// Brings the window in line with the vmap for the given range, coalescing runs of pages
+// so that large (un)mappings only cost a handful of mmap calls.
+static void vtlb_FastmemSync(u32 vaddr, u32 size)
+{
+	if (!s_fastmem_base) return;
+
+	u32 vpage = vaddr >> VTLB_PAGE_BITS;
+	const u32 end = vpage + (size >> VTLB_PAGE_BITS);
+
+	u32 run_start = 0, run_count = 0, run_state = 0;
+	for (; vpage < end; vpage++)
+	{
+		const u32 want = FastmemWantedState(vpage);
+		if (want == s_fastmem_pages[vpage])
+		{
+			if (run_count) FastmemApplyRun(run_start, run_count, run_state);
+			run_count = 0;
+			continue;
+		}
+
+		if (run_count && (run_state ? want == run_state + run_count : !want))
+		{
+			run_count++;
+		}
+		else
+		{
+			if (run_count) FastmemApplyRun(run_start, run_count, run_state);
+			run_start = vpage;
+			run_count = 1;
+			run_state = want;
+		}
+
+		FastmemSetState(vpage, want);
+	}
+
+	if (run_count) FastmemApplyRun(run_start, run_count, run_state);
+}
+
+bool vtlb_FastmemAttach(void* base, size_t size)
+{
+	vtlb_FastmemDetach();
+
+	size = (size + __pagesize - 1) & ~(size_t)(__pagesize - 1);
+
+#ifdef __M_X86_64
+	void* shm = HostSys::CreateSharedMemory(size);
+	u8* window = shm ? (u8*)HostSys::MmapReserve(0, FASTMEM_WINDOW_SIZE) : NULL;
+	if (window == (u8*)-1)
+		window = NULL;
+
+	if (!window || !HostSys::MapSharedMemory(shm, 0, base, size, PageAccess_ReadWrite()))
+	{
+		Console.Warning("(vtlb) Fastmem is not available on this host, using the vtlb path.");
+		if (window) HostSys::Munmap((uptr)window, FASTMEM_WINDOW_SIZE);
+		HostSys::DestroySharedMemory(shm);
+		return false;
+	}
+
+	// The shared memory replaced the mapping the reserve advised; shmem only gets huge pages
+	// when /sys/kernel/mm/transparent_hugepage/shmem_enabled allows it.
+	if (EmuConfig.Cpu.Recompiler.EnableHugePages)
+		HostSys::MemAdviseHugePages(base, size);
+
+	s_fastmem_base = window;
+	s_fastmem_shm = shm;
+	s_fastmem_shm_ptr = (uptr)base;
+	s_fastmem_shm_pages = size >> VTLB_PAGE_BITS;
+	s_fastmem_pages = new u32[VTLB_VMAP_ITEMS]();
+
+	DevCon.WriteLn("(vtlb) Fastmem window @ 0x%p", window);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void vtlb_FastmemDetach()
+{
+	if (!s_fastmem_base) return;
+
+	HostSys::Munmap((uptr)s_fastmem_base, FASTMEM_WINDOW_SIZE);
+	HostSys::DestroySharedMemory(s_fastmem_shm);
+
+	for (std::vector<u32>& alias : s_fastmem_ram_alias)
+		alias.clear();
+	memzero(s_fastmem_ram_readonly);
+	safe_delete_array(s_fastmem_pages);
+
+	s_fastmem_base = NULL;
+	s_fastmem_shm = NULL;
+	s_fastmem_shm_ptr = 0;
+	s_fastmem_shm_pages = 0;
+}
+
+u8* vtlb_FastmemBase()
+{
+	return s_fastmem_base;
+}
+
+bool vtlb_FastmemIsWindowAddress(uptr hostaddr)
+{
+	return s_fastmem_base && (hostaddr - (uptr)s_fastmem_base) < FASTMEM_WINDOW_SIZE;
+}
+
+// Translates a window address aliasing main ram into its offset in eeMem->Main.
+bool vtlb_FastmemGetRamOffset(uptr hostaddr, u32& offset)
+{
+	if (!vtlb_FastmemIsWindowAddress(hostaddr)) return false;
+
+	const uptr woffset = hostaddr - (uptr)s_fastmem_base;
+	const u32 state = s_fastmem_pages[woffset >> VTLB_PAGE_BITS];
+	if (!FastmemIsRam(state)) return false;
+
+	offset = ((state - 1) << VTLB_PAGE_BITS) | (woffset & VTLB_PAGE_MASK);
+	return true;
+}
+
+void vtlb_FastmemProtectRamPage(u32 rampage, bool writable)
+{
+	if (!s_fastmem_base) return;
+
+	s_fastmem_ram_readonly[rampage] = !writable;
+	for (u32 vpage : s_fastmem_ram_alias[rampage])
+		HostSys::MemProtect(FastmemPagePtr(vpage), __pagesize, writable ? PageAccess_ReadWrite() : PageAccess_ReadOnly());
+}
+
+void vtlb_FastmemUnprotectRam()
+{
+	if (!s_fastmem_base) return;
+
+	for (u32 rampage = 0; rampage < FASTMEM_RAM_PAGES; rampage++)
+	{
+		if (s_fastmem_ram_readonly[rampage])
+			vtlb_FastmemProtectRamPage(rampage, true);
+	}
+}
+
 //virtual mappings
 //TODO: Add invalid paddr checks
 void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
@@ -666,6 +899,8 @@ void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
 	verify(0==(paddr&VTLB_PAGE_MASK));
 	verify(0==(size&VTLB_PAGE_MASK) && size>0);
 
+	const u32 vstart = vaddr, vsize = size;
+
 	while (size > 0)
 	{
 		VTLBVirtual vmv;
@@ -688,6 +923,8 @@ void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
 		paddr += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
+
+	vtlb_FastmemSync(vstart, vsize);
 }
 
 void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
@@ -695,6 +932,8 @@ void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
 	verify(0==(vaddr&VTLB_PAGE_MASK));
 	verify(0==(size&VTLB_PAGE_MASK) && size>0);
 
+	const u32 vstart = vaddr, vsize = size;
+
 	uptr bu8 = (uptr)buffer;
 	while (size > 0)
 	{
@@ -703,6 +942,8 @@ void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
 		bu8 += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
+
+	vtlb_FastmemSync(vstart, vsize);
 }
 
 void vtlb_VMapUnmap(u32 vaddr,u32 size)
@@ -710,6 +951,8 @@ void vtlb_VMapUnmap(u32 vaddr,u32 size)
 	verify(0==(vaddr&VTLB_PAGE_MASK));
 	verify(0==(size&VTLB_PAGE_MASK) && size>0);
 
+	const u32 vstart = vaddr, vsize = size;
+
 	while (size > 0)
 	{
 
@@ -724,6 +967,8 @@ void vtlb_VMapUnmap(u32 vaddr,u32 size)
 		vaddr += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
+
+	vtlb_FastmemSync(vstart, vsize);
 }
 
 // vtlb_Init -- Clears vtlb handlers and memory mappings.
@@ -860,6 +1105,7 @@ void VtlbMemoryReserve::Reserve( VirtualMemoryManagerPtr allocator, sptr offset
 void VtlbMemoryReserve::Commit()
 {
 	if (IsCommitted()) return;
+	m_reserve.SetHugePagesOnCommit(EmuConfig.Cpu.Recompiler.EnableHugePages);
 	if (!m_reserve.Commit())
 	{
 		throw Exception::OutOfMemory( m_reserve.GetName() )
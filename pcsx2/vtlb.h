@@ -103,6 +103,27 @@ extern void vtlb_DynGenWrite_Const( u32 bits, u32 addr_const );
 extern void vtlb_DynGenRead64_Const( u32 bits, u32 addr_const );
 extern void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const );
 
+// Fastmem: a host window mirroring the whole EE virtual address space (see vtlb.cpp).
+extern bool vtlb_FastmemAttach(void* base, size_t size);
+extern void vtlb_FastmemDetach();
+extern u8*  vtlb_FastmemBase();
+extern bool vtlb_FastmemIsWindowAddress(uptr hostaddr);
+extern bool vtlb_FastmemGetRamOffset(uptr hostaddr, u32& offset);
+extern void vtlb_FastmemProtectRamPage(u32 rampage, bool writable);
+extern void vtlb_FastmemUnprotectRam();
+
+struct vtlb_FastmemStats
+{
+	u32 sites;			// fastmem loads/stores emitted since the last rec reset
+	u32 backpatches;	// sites sent back to the vtlb path after faulting
+	u32 blocks;			// blocks with at least one backpatched site
+};
+
+extern void vtlb_DynGenFastmemReset();
+extern void vtlb_DynGenFastmemBegin();
+extern void vtlb_DynGenFastmemEnd(u32 startpc);
+extern vtlb_FastmemStats vtlb_GetFastmemStats();
+
 // --------------------------------------------------------------------------------------
 //  VtlbMemoryReserve
 // --------------------------------------------------------------------------------------
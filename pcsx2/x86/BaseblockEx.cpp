@@ -17,66 +17,288 @@
 #include "PrecompiledHeader.h"
 #include "BaseblockEx.h"
 
+BaseBlocks::BaseBlocks()
+	: m_orphans(NULL)
+	, m_freeBlocks(NULL)
+	, m_freeLinks(NULL)
+	, m_blockChunkUsed(PoolChunk)
+	, m_linkChunkUsed(PoolChunk)
+	, recompiler(0)
+	, m_span(4)
+	, m_count(0)
+	, m_trace(NULL)
+{
+}
+
+void BaseBlocks::SetTrace(FILE* fp)
+{
+	if (m_trace)
+		fclose(m_trace);
+	m_trace = fp;
+}
+
+BaseBlocks::Page& BaseBlocks::AddPage(u32 pc)
+{
+	std::unique_ptr<Page[]>& segment = m_segments[pc >> SegmentShift];
+	if (!segment)
+	{
+		segment.reset(new Page[SegmentPages]);
+		memset(segment.get(), 0, sizeof(Page) * SegmentPages);
+	}
+
+	return segment[(pc >> PageShift) & (SegmentPages - 1)];
+}
+
+BASEBLOCKEX* BaseBlocks::AllocBlock()
+{
+	if (BASEBLOCKEX* block = m_freeBlocks)
+	{
+		m_freeBlocks = block->next;
+		return block;
+	}
+
+	if (m_blockChunkUsed == PoolChunk)
+	{
+		m_blockPool.emplace_back(new BASEBLOCKEX[PoolChunk]);
+		m_blockChunkUsed = 0;
+	}
+
+	return &m_blockPool.back()[m_blockChunkUsed++];
+}
+
+BASEBLOCKLINK* BaseBlocks::AllocLink()
+{
+	if (BASEBLOCKLINK* link = m_freeLinks)
+	{
+		m_freeLinks = link->next;
+		return link;
+	}
+
+	if (m_linkChunkUsed == PoolChunk)
+	{
+		m_linkPool.emplace_back(new BASEBLOCKLINK[PoolChunk]);
+		m_linkChunkUsed = 0;
+	}
+
+	return &m_linkPool.back()[m_linkChunkUsed++];
+}
+
+// Prepends a list of jumps to the ones waiting for a block at pc.
+void BaseBlocks::Wait(BASEBLOCKLINK* links, u32 pc)
+{
+	BASEBLOCKLINK*& waiting = m_unlinked[pc];
+
+	BASEBLOCKLINK* last = links;
+	while (last->next)
+		last = last->next;
+
+	last->next = waiting;
+	if (waiting)
+		waiting->pprev = &last->next;
+
+	links->pprev = &waiting;
+	waiting = links;
+}
+
 BASEBLOCKEX* BaseBlocks::New(u32 startpc, uptr fnptr)
 {
-	std::pair<linkiter_t, linkiter_t> range = links.equal_range(startpc);
-	for (linkiter_t i = range.first; i != range.second; ++i)
-		*(u32*)i->second = fnptr - (i->second + 4);
-	
-	return blocks.insert(startpc, fnptr);;
+	if (m_trace)
+		fprintf(m_trace, "n %x\n", startpc);
+
+	BASEBLOCKEX* block = AllocBlock();
+	memzero(*block);
+	block->startpc = startpc;
+	block->fnptr = fnptr;
+
+	Page& page = AddPage(startpc);
+
+	BASEBLOCKEX** prev = &page.blocks;
+	while (*prev && (*prev)->startpc < startpc)
+		prev = &(*prev)->next;
+
+	pxAssert(!*prev || (*prev)->startpc != startpc);
+	block->next = *prev;
+	*prev = block;
+
+	// Take over the jumps that were waiting for this pc.
+	auto waiting = m_unlinked.find(startpc);
+	if (waiting != m_unlinked.end())
+	{
+		if (BASEBLOCKLINK* links = waiting->second)
+		{
+			block->links = links;
+			links->pprev = &block->links;
+
+			for (BASEBLOCKLINK* i = links; i; i = i->next)
+				*i->jumpptr = (s32)(fnptr - (uptr)(i->jumpptr + 1));
+		}
+
+		m_unlinked.erase(waiting);
+	}
+
+	m_count++;
+	return block;
 }
 
-int BaseBlocks::LastIndex(u32 startpc) const
+void BaseBlocks::SetSize(BASEBLOCKEX* block, u32 size)
 {
-	if (0 == blocks.size())
-		return -1;
+	pxAssert(size <= 0xffff);
+	if (m_trace)
+		fprintf(m_trace, "s %x %x\n", block->startpc, size);
+
+	block->size = size;
+	m_span = std::max(m_span, block->endpc() - block->startpc);
+}
+
+void BaseBlocks::Unlink(BASEBLOCKEX& block)
+{
+	if (BASEBLOCKLINK* links = block.links)
+	{
+		for (BASEBLOCKLINK* i = links; i; i = i->next)
+			*i->jumpptr = (s32)(recompiler - (uptr)(i->jumpptr + 1));
+
+		Wait(links, block.startpc);
+	}
 
-	int imin = 0, imax = blocks.size() - 1, imid;
+	if (BASEBLOCKLINK* out = block.outlinks)
+	{
+		BASEBLOCKLINK* last = out;
+		while (last->nextOut)
+			last = last->nextOut;
 
-	while(imin != imax) {
-		imid = (imin+imax+1)>>1;
+		last->nextOut = m_orphans;
+		m_orphans = out;
+	}
+
+	if( IsDevBuild )
+	{
+		// Clear the first instruction to 0xcc (breakpoint), as a way to assert if some
+		// static jumps get left behind to this block.  Note: Do not clear more than the
+		// first byte, since this code is called during exception handlers and event handlers
+		// both of which expect to be able to return to the recompiled code.
 
-		if (blocks[imid].startpc > startpc)
-			imax = imid - 1;
-		else
-			imin = imid;
+		memset( (void*)block.fnptr, 0xcc, 1 );
 	}
 
-	return imin;
+	block.next = m_freeBlocks;
+	m_freeBlocks = &block;
+	m_count--;
 }
 
-#if 0
-BASEBLOCKEX* BaseBlocks::GetByX86(uptr ip)
+void BaseBlocks::ReleaseOrphans()
 {
-	if (0 == blocks.size())
-		return 0;
+	while (BASEBLOCKLINK* link = m_orphans)
+	{
+		m_orphans = link->nextOut;
 
-	int imin = 0, imax = blocks.size() - 1, imid;
+		*link->pprev = link->next;
+		if (link->next)
+			link->next->pprev = link->pprev;
 
-	while(imin != imax) {
-		imid = (imin+imax+1)>>1;
+		link->next = m_freeLinks;
+		m_freeLinks = link;
+	}
+}
 
-		if (blocks[imid].fnptr > ip)
-			imax = imid - 1;
-		else
-			imin = imid;
+BASEBLOCKEX* BaseBlocks::Get(u32 pc) const
+{
+	const u32 first = ReachBack(pc) >> PageShift;
+
+	for (u32 page = pc >> PageShift; page + 1 > first; page--)
+	{
+		const Page* bucket = GetPage(page << PageShift);
+		if (!bucket)
+			continue;
+
+		BASEBLOCKEX* found = NULL;
+		for (BASEBLOCKEX* block = bucket->blocks; block && block->startpc <= pc; block = block->next)
+		{
+			if (block->endpc() > pc)
+				found = block;
+		}
+
+		if (found)
+			return found;
 	}
 
-	if (ip < blocks[imin].fnptr ||
-		ip >= blocks[imin].fnptr + blocks[imin].x86size)
-		return 0;
+	return NULL;
+}
+
+BASEBLOCKEX* BaseBlocks::Next(u32 pc, u32 limit) const
+{
+	for (u32 page = pc >> PageShift; page <= (limit - 1) >> PageShift; page++)
+	{
+		const Page* bucket = GetPage(page << PageShift);
+		if (!bucket)
+			continue;
 
-	return &blocks[imin];
+		for (BASEBLOCKEX* block = bucket->blocks; block && block->startpc < limit; block = block->next)
+		{
+			if (block->startpc >= pc)
+				return block;
+		}
+	}
+
+	return NULL;
 }
-#endif
 
-void BaseBlocks::Link(u32 pc, s32* jumpptr)
+void BaseBlocks::Link(u32 pc, s32* jumpptr, BASEBLOCKEX* from)
 {
-	BASEBLOCKEX *targetblock = Get(pc);
+	if (m_trace)
+		fprintf(m_trace, "l %x %x\n", pc, from ? from->startpc : 0);
+
+	BASEBLOCKLINK* link = AllocLink();
+	link->pc = pc;
+	link->jumpptr = jumpptr;
+	link->next = NULL;
+
+	BASEBLOCKEX* targetblock = Get(pc);
 	if (targetblock && targetblock->startpc == pc)
+	{
 		*jumpptr = (s32)(targetblock->fnptr - (sptr)(jumpptr + 1));
+
+		link->next = targetblock->links;
+		if (link->next)
+			link->next->pprev = &link->next;
+		link->pprev = &targetblock->links;
+		targetblock->links = link;
+	}
 	else
+	{
 		*jumpptr = (s32)(recompiler - (sptr)(jumpptr + 1));
-	links.insert(std::pair<u32, uptr>(pc, (uptr)jumpptr));
+		Wait(link, pc);
+	}
+
+	if (from)
+	{
+		link->nextOut = from->outlinks;
+		from->outlinks = link;
+	}
+	else
+		link->nextOut = NULL;
 }
 
+// Keeps the page segments and the first chunk of each pool for the next run.
+void BaseBlocks::Reset()
+{
+	if (m_trace)
+		fprintf(m_trace, "x\n");
+
+	for (std::unique_ptr<Page[]>& segment : m_segments)
+	{
+		if (segment)
+			memset(segment.get(), 0, sizeof(Page) * SegmentPages);
+	}
+
+	m_unlinked.clear();
+	m_orphans = NULL;
+	m_freeBlocks = NULL;
+	m_freeLinks = NULL;
+	m_blockChunkUsed = m_blockPool.empty() ? PoolChunk : 0;
+	m_linkChunkUsed = m_linkPool.empty() ? PoolChunk : 0;
+	m_blockPool.resize(std::min<size_t>(m_blockPool.size(), 1));
+	m_linkPool.resize(std::min<size_t>(m_linkPool.size(), 1));
+
+	m_span = 4;
+	m_count = 0;
+}
@@ -15,7 +15,9 @@
 
 #pragma once
 
-#include <map>			// used by BaseBlockEx
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 // Every potential jump point in the PS2's addressable memory has a BASEBLOCK
 // associated with it. So that means a BASEBLOCK for every 4 bytes of PS2
@@ -28,6 +30,17 @@ struct BASEBLOCK
 	void __inline SetFnptr( uptr ptr ) { m_pFnptr = ptr; }
 };
 
+// A jump of recompiled code to the block at pc, patched when that block is compiled or
+// removed.
+struct BASEBLOCKLINK
+{
+	u32 pc;
+	s32* jumpptr;			// rel32 of the jmp/jcc
+	BASEBLOCKLINK* next;	// jumps to the same pc
+	BASEBLOCKLINK** pprev;
+	BASEBLOCKLINK* nextOut;	// jumps of the same block
+};
+
 // extra block info (only valid for start of fn)
 struct BASEBLOCKEX
 {
@@ -36,126 +49,90 @@ struct BASEBLOCKEX
 	u16  size;	 // The size in dwords (equivalent to the number of instructions)
 	u16  x86size; // The size in byte of the translated x86 instructions
 
+	BASEBLOCKEX* next;		// next block starting in the same 4KB page, by startpc
+	BASEBLOCKLINK* links;	// jumps to this block
+	BASEBLOCKLINK* outlinks;	// jumps of this block
+
 #ifdef PCSX2_DEVBUILD
 	// Could be useful to instrument the block
 	//u32 visited; // number of times called
 	//u64 ltime; // regs it assumes to have set already
 #endif
 
+	// An empty block (still being compiled) covers its first instruction.
+	__fi u32 endpc() const { return startpc + std::max<u32>(size, 1) * 4; }
 };
 
-class BaseBlockArray {
-	s32 _Reserved;
-	s32 _Size;
-	BASEBLOCKEX *blocks;
-
-	__fi void resize(s32 size)
-	{
-		pxAssert(size > 0);
-		BASEBLOCKEX *newMem = new BASEBLOCKEX[size];
-		if(blocks) {
-			memcpy(newMem, blocks, _Reserved * sizeof(BASEBLOCKEX));
-			delete[] blocks;
-		}
-		blocks = newMem;
-		pxAssert(blocks != NULL);
-	}
-
-	void reserve(u32 size)
-	{
-		resize(size);
-		_Reserved = size;
-	}
-public:
-	~BaseBlockArray()
-	{
-		if(blocks) {
-			delete[] blocks;
-		}
-	}
-
-	BaseBlockArray (s32 size) : _Reserved(0),
-		_Size(0), blocks(NULL)
-	{
-		reserve(size);
-	}
-
-	BASEBLOCKEX *insert(u32 startpc, uptr fnptr)
+// --------------------------------------------------------------------------------------
+//  BaseBlocks
+// --------------------------------------------------------------------------------------
+// Compiled blocks by ps2 physical address. Blocks are chained by start pc in a bucket per
+// 4KB page, so adding one only walks the blocks of its page, and the blocks overlapping a
+// range are found by walking the pages of the range plus the pages the longest block can
+// reach back over. Each block holds the jumps linked to it; the jumps to pcs without a
+// block wait in a hash by pc.
+//
+// The jumps of a removed block stay patched until ReleaseOrphans, since a block cleared by
+// its own stores still runs to its end. Without that, a self-modifying game would keep
+// adding links with each recompile and every compile or clear of a block would patch all
+// the jumps ever made to it.
+//
+// Block and link records come from pools and keep their address until released.
+//
+// SetTrace writes the operations to a text file that tools/blocks_bench replays:
+// "n pc", "s pc size", "l pc from", "r start end" and "x" for New, SetSize, Link, Remove and
+// Reset.
+class BaseBlocks
+{
+protected:
+	struct Page
 	{
-		if(_Size + 1 >= _Reserved) {
-			reserve(_Reserved + 0x2000); // some games requires even more!
-		}
+		BASEBLOCKEX* blocks;
+	};
 
-		// Insert the the new BASEBLOCKEX by startpc order
-		int imin = 0, imax = _Size, imid;
+	static const uint PageShift = 12;
+	static const uint SegmentShift = 22;	// 1024 pages, allocated on first use
+	static const uint SegmentPages = 1 << (SegmentShift - PageShift);
+	static const uint PoolChunk = 0x1000;
 
-		while (imin < imax) {
-			imid = (imin+imax)>>1;
-
-			if (blocks[imid].startpc > startpc)
-				imax = imid;
-			else
-				imin = imid + 1;
-		}
-	
-		pxAssert(imin == _Size || blocks[imin].startpc > startpc);
+	std::unique_ptr<Page[]> m_segments[1 << (32 - SegmentShift)];
 
-		if(imin < _Size) {
-			// make a hole for a new block.
-			memmove(blocks + imin + 1, blocks + imin, (_Size - imin) * sizeof(BASEBLOCKEX));
-		}
+	std::vector<std::unique_ptr<BASEBLOCKEX[]>> m_blockPool;
+	std::vector<std::unique_ptr<BASEBLOCKLINK[]>> m_linkPool;
+	std::unordered_map<u32, BASEBLOCKLINK*> m_unlinked;	// by target pc
+	BASEBLOCKLINK* m_orphans;		// jumps of removed blocks, by nextOut
+	BASEBLOCKEX* m_freeBlocks;
+	BASEBLOCKLINK* m_freeLinks;
+	uint m_blockChunkUsed;
+	uint m_linkChunkUsed;
 
-		memset((blocks + imin), 0, sizeof(BASEBLOCKEX));
-		blocks[imin].startpc = startpc;
-		blocks[imin].fnptr = fnptr;
+	uptr recompiler;
+	u32 m_span;				// bytes covered by the longest block since Reset
+	u32 m_count;
 
-		_Size++;
-		return &blocks[imin];
-	}
+	FILE* m_trace;
 
-	__fi BASEBLOCKEX &operator[](int idx) const
+	__fi Page* GetPage(u32 pc) const
 	{
-		return *(blocks + idx);
+		Page* segment = m_segments[pc >> SegmentShift].get();
+		return segment ? &segment[(pc >> PageShift) & (SegmentPages - 1)] : NULL;
 	}
 
-	void clear()
-	{
-		_Size = 0;
-	}
+	Page& AddPage(u32 pc);
+	BASEBLOCKEX* AllocBlock();
+	BASEBLOCKLINK* AllocLink();
+	void Unlink(BASEBLOCKEX& block);
+	void Wait(BASEBLOCKLINK* links, u32 pc);
 
-	__fi u32 size() const
+	// First pc whose page may hold a block overlapping pc.
+	__fi u32 ReachBack(u32 pc) const
 	{
-		return _Size;
+		return pc > m_span ? pc - m_span + 4 : 0;
 	}
 
-	__fi void erase(s32 first, s32 last)
-	{
-		int range = last - first;
-
-		if(last < _Size) {
-			memmove(blocks + first, blocks + last, (_Size - last) * sizeof(BASEBLOCKEX));
-		}
-
-		_Size -= range;
-	}
-};
-
-class BaseBlocks
-{
-protected:
-	typedef std::multimap<u32, uptr>::iterator linkiter_t;
-
-	// switch to a hash map later?
-	std::multimap<u32, uptr> links;
-	uptr recompiler;
-	BaseBlockArray blocks;
-
 public:
-	BaseBlocks() :
-		recompiler(0)
-	,	blocks(0x4000)
-	{
-	}
+	BaseBlocks();
+	~BaseBlocks() { SetTrace(NULL); }
 
 	void SetJITCompile( void (*recompiler_)() )
 	{
@@ -163,69 +140,92 @@ public:
 	}
 
 	BASEBLOCKEX* New(u32 startpc, uptr fnptr);
-	int LastIndex (u32 startpc) const;
-	//BASEBLOCKEX* GetByX86(uptr ip);
+	void SetSize(BASEBLOCKEX* block, u32 size);
 
-	__fi int Index (u32 startpc) const
-	{
-		int idx = LastIndex(startpc);
+	// The block covering pc that starts last, or NULL.
+	BASEBLOCKEX* Get(u32 pc) const;
 
-		if ((idx == -1) || (startpc < blocks[idx].startpc) ||
-			((blocks[idx].size) && (startpc >= blocks[idx].startpc + blocks[idx].size * 4)))
-			return -1;
-		else
-			return idx;
-	}
+	// First block starting in [pc, limit), or NULL.
+	BASEBLOCKEX* Next(u32 pc, u32 limit) const;
 
-	__fi BASEBLOCKEX* operator[](int idx)
-	{
-		if (idx < 0 || idx >= (int)blocks.size())
-			return 0;
+	u32 Count() const { return m_count; }
 
-		return &blocks[idx];
-	}
+	void SetTrace(FILE* fp);	// takes ownership, closes the previous trace
+	bool IsTracing() const { return m_trace != NULL; }
 
-	__fi BASEBLOCKEX* Get(u32 startpc)
+	// Calls func on the blocks overlapping [start, end) until it returns false. The callback
+	// must not add or remove blocks.
+	template <typename Func>
+	void ForEach(u32 start, u32 end, Func func) const
 	{
-		return (*this)[Index(startpc)];
+		const u32 first = ReachBack(start) >> PageShift;
+		const u32 last = (end - 1) >> PageShift;
+
+		for (u32 page = first; page <= last; page++)
+		{
+			const Page* bucket = GetPage(page << PageShift);
+			if (!bucket)
+			{
+				page |= SegmentPages - 1;
+				continue;
+			}
+
+			for (BASEBLOCKEX* block = bucket->blocks; block && block->startpc < end; block = block->next)
+			{
+				if (block->endpc() > start && !func(*block))
+					return;
+			}
+		}
 	}
 
-	__fi void Remove(int first, int last)
+	// Removes the blocks overlapping [start, end) but keep, calling func on each one first.
+	// Their links go back to the recompiler.
+	template <typename Func>
+	void Remove(u32 start, u32 end, const BASEBLOCKEX* keep, Func func)
 	{
-		pxAssert(first <= last);
-		int idx = first;
-		do{
-			pxAssert(idx <= last);
+		if (m_trace)
+			fprintf(m_trace, "r %x %x\n", start, end);
+
+		const u32 first = ReachBack(start) >> PageShift;
+		const u32 last = (end - 1) >> PageShift;
 
-			//u32 startpc = blocks[idx].startpc;
-			std::pair<linkiter_t, linkiter_t> range = links.equal_range(blocks[idx].startpc);
-			for (linkiter_t i = range.first; i != range.second; ++i)
-				*(u32*)i->second = recompiler - (i->second + 4);
+		for (u32 page = first; page <= last; page++)
+		{
+			Page* bucket = GetPage(page << PageShift);
+			if (!bucket)
+			{
+				page |= SegmentPages - 1;
+				continue;
+			}
 
-			if( IsDevBuild )
+			BASEBLOCKEX** prev = &bucket->blocks;
+			while (BASEBLOCKEX* block = *prev)
 			{
-				// Clear the first instruction to 0xcc (breakpoint), as a way to assert if some
-				// static jumps get left behind to this block.  Note: Do not clear more than the
-				// first byte, since this code is called during exception handlers and event handlers
-				// both of which expect to be able to return to the recompiled code.
+				if (block->startpc >= end)
+					break;
+
+				if (block == keep || block->endpc() <= start)
+				{
+					prev = &block->next;
+					continue;
+				}
+
+				func(*block);
 
-				BASEBLOCKEX effu( blocks[idx] );
-				memset( (void*)effu.fnptr, 0xcc, 1 );
+				*prev = block->next;
+				Unlink(*block);
 			}
 		}
-		while(idx++ < last);
-
-		// TODO: remove links from this block?
-		blocks.erase(first, last + 1);
 	}
 
-	void Link(u32 pc, s32* jumpptr);
+	// from is the block being compiled, which holds the jump.
+	void Link(u32 pc, s32* jumpptr, BASEBLOCKEX* from);
 
-	__fi void Reset()
-	{
-		blocks.clear();
-		links.clear();
-	}
+	// Drops the jumps of the removed blocks. Only call it when no block can be running,
+	// i.e. from the dispatcher.
+	void ReleaseOrphans();
+
+	void Reset();
 };
 
 #define PC_GETBLOCK_(x, reclut) ((BASEBLOCK*)(reclut[((u32)(x)) >> 16] + (x)*(sizeof(BASEBLOCK)/4)))
@@ -810,41 +810,19 @@ static __fi u32 psxRecClearMem(u32 pc)
 	pc = HWADDR(pc);
 
 	u32 lowerextent = pc, upperextent = pc + 4;
-	int blockidx = recBlocks.Index(pc);
-	pxAssert(blockidx != -1);
+	pxAssert(recBlocks.Get(pc));
 
-	while (BASEBLOCKEX* pexblock = recBlocks[blockidx - 1]) {
-		if (pexblock->startpc + pexblock->size * 4 <= lowerextent)
-			break;
-
-		lowerextent = std::min(lowerextent, pexblock->startpc);
-		blockidx--;
-	}
-
-	int toRemoveFirst = blockidx;
+	// The blocks overlapping a removed one go too, the lut of all of them is cleared at once.
+	u32 start, end;
+	do {
+		start = lowerextent;
+		end = upperextent;
 
-	while (BASEBLOCKEX* pexblock = recBlocks[blockidx]) {
-		if (pexblock->startpc >= upperextent)
-			break;
-
-		lowerextent = std::min(lowerextent, pexblock->startpc);
-		upperextent = std::max(upperextent, pexblock->startpc + pexblock->size * 4);
-
-		blockidx++;
-	}
-
-	if(toRemoveFirst != blockidx) {
-		recBlocks.Remove(toRemoveFirst, (blockidx - 1));
-	}
-
-	blockidx=0;
-	while(BASEBLOCKEX* pexblock = recBlocks[blockidx++])
-	{
-		if (pc >= pexblock->startpc && pc < pexblock->startpc + pexblock->size * 4) {
-			DevCon.Error("Impossible block clearing failure");
-			pxFailDev( "Impossible block clearing failure" );
-		}
-	}
+		recBlocks.Remove(start, end, NULL, [&](BASEBLOCKEX& block) {
+			lowerextent = std::min(lowerextent, block.startpc);
+			upperextent = std::max(upperextent, block.startpc + block.size * 4);
+		});
+	} while (lowerextent < start || upperextent > end);
 
 	iopClearRecLUT(PSX_GETBLOCK(lowerextent), (upperextent - lowerextent) / 4);
 
@@ -908,7 +886,7 @@ void psxSetBranchImm( u32 imm )
 	_psxFlushCall(FLUSH_EVERYTHING);
 	iPsxBranchTest(imm, imm <= psxpc);
 
-	recBlocks.Link(HWADDR(imm), xJcc32());
+	recBlocks.Link(HWADDR(imm), xJcc32(), s_pCurBlockEx);
 }
 
 static __fi u32 psxScaleBlockCycles()
@@ -1083,6 +1061,9 @@ static void __fastcall iopRecRecompile( const u32 startpc )
 	u32 i;
 	u32 willbranch3 = 0;
 
+	// Compiles come from the dispatcher, no block is running.
+	recBlocks.ReleaseOrphans();
+
 	// Inject IRX hack
 	if (startpc == 0x1630 && g_Conf->CurrentIRX.Length() > 3) {
 		if (iopMemRead32(0x20018) == 0x1F) {
@@ -1261,7 +1242,7 @@ StartRecomp:
 		iIopDumpBlock(startpc, recPtr);
 
 	pxAssert( (psxpc-startpc)>>2 <= 0xffff );
-	s_pCurBlockEx->size = (psxpc-startpc)>>2;
+	recBlocks.SetSize(s_pCurBlockEx, (psxpc-startpc)>>2);
 
 	for(i = 1; i < (u32)s_pCurBlockEx->size; ++i) {
 		if (s_pCurBlock[i].GetFnptr() == (uptr)iopJITCompile)
@@ -1290,7 +1271,7 @@ StartRecomp:
 			pxAssert( psxpc == s_nEndBlock );
 			_psxFlushCall(FLUSH_EVERYTHING);
 			xMOV(ptr32[&psxRegs.pc], psxpc);
-			recBlocks.Link(HWADDR(s_nEndBlock), xJcc32() );
+			recBlocks.Link(HWADDR(s_nEndBlock), xJcc32(), s_pCurBlockEx );
 			psxbranch = 3;
 		}
 	}
@@ -68,8 +68,9 @@ void SaveBranchState();
 void LoadBranchState();
 
 void recompileNextInstruction(int delayslot);
-void SetBranchReg( u32 reg );
+void SetBranchReg( u32 reg, bool isReturn = false );
 void SetBranchImm( u32 imm );
+void recPushReturnAddress( u32 retpc );
 
 void iFlushCall(int flushtype);
 void recBranchCall( void (*func)() );
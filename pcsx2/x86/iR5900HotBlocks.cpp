@@ -0,0 +1,220 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+#include "iR5900HotBlocks.h"
+
+// Profile file: header followed by `count` Entry records, the blocks of the boot first.
+static const u32 ProfileMagic = 0x4B4C4245; // "EBLK"
+static const u32 ProfileVersion = 1;
+
+struct ProfileHeader
+{
+	u32 magic;
+	u32 version;
+	u32 count;
+	u32 reserved;
+};
+
+EEHotBlocks eeHotBlocks;
+
+EEHotBlocks::EEHotBlocks()
+{
+	memzero(m_used);
+}
+
+// FNV-1a over the 1024 words of the page.
+u64 EEHotBlocks::HashPage(const void* page)
+{
+	const u32* words = (const u32*)page;
+	u64 hash = 0xcbf29ce484222325ULL;
+
+	for (uint i = 0; i < 0x1000 / 4; i++)
+		hash = (hash ^ words[i]) * 0x100000001b3ULL;
+
+	return hash;
+}
+
+bool EEHotBlocks::Load(const wxString& filename)
+{
+	FILE* fp = wxFopen(filename, L"rb");
+	if (!fp)
+		return false;
+
+	ProfileHeader header;
+	bool ok = fread(&header, sizeof(header), 1, fp) == 1 && header.magic == ProfileMagic && header.version == ProfileVersion && header.count <= MaxBlocks;
+
+	if (ok)
+	{
+		m_profile.resize(header.count);
+		ok = fread(m_profile.data(), sizeof(Entry), header.count, fp) == header.count;
+	}
+	fclose(fp);
+
+	if (!ok)
+	{
+		Console.Warning(L"(EErec) Ignoring block profile %s recorded by another version.", WX_STR(filename));
+		m_profile.clear();
+	}
+
+	return ok;
+}
+
+void EEHotBlocks::Save(const wxString& filename) const
+{
+	std::vector<Entry> blocks;
+	blocks.reserve(m_profile.size() + m_trace.size());
+
+	// Blocks whose page was rewritten before they ran, or that no longer matched at boot,
+	// won't be precompiled again; the ones not reached this time may be on the next run.
+	for (size_t i = 0; i < m_profile.size(); i++)
+	{
+		if (m_state[i] != Discarded && m_state[i] != Skipped)
+			blocks.push_back(m_profile[i]);
+	}
+
+	for (const Entry& entry : m_trace)
+	{
+		if (blocks.size() == MaxBlocks)
+			break;
+		blocks.push_back(entry);
+	}
+
+	if (blocks.empty())
+		return;
+
+	wxDirName(wxFileName(filename).GetPath()).Mkdir();
+
+	FILE* fp = wxFopen(filename, L"wb");
+	if (!fp)
+	{
+		Console.Warning(L"(EErec) Could not write block profile %s", WX_STR(filename));
+		return;
+	}
+
+	ProfileHeader header = {ProfileMagic, ProfileVersion, (u32)blocks.size(), 0};
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(blocks.data(), sizeof(Entry), blocks.size(), fp);
+	fclose(fp);
+
+	DevCon.WriteLn(L"(EErec) Saved %u blocks to %s", (uint)blocks.size(), WX_STR(filename));
+}
+
+void EEHotBlocks::Clear()
+{
+	m_filename.clear();
+	m_profile.clear();
+	m_state.clear();
+	m_fnptr.clear();
+	m_trace.clear();
+	m_seen.clear();
+	memzero(m_used);
+}
+
+void EEHotBlocks::Begin(const wxString& filename)
+{
+	Clear();
+
+	m_filename = filename;
+	m_seen.resize(Ps2MemSize::MainRam / 4);
+
+	if (!Load(filename))
+	{
+		Console.WriteLn(L"(EErec) Recording the blocks of %s", WX_STR(wxFileName(filename).GetName()));
+		return;
+	}
+
+	m_state.resize(m_profile.size(), Pending);
+	m_fnptr.resize(m_profile.size(), 0);
+
+	for (const Entry& entry : m_profile)
+		m_seen[(entry.startpc & (Ps2MemSize::MainRam - 1)) / 4] = true;
+}
+
+void EEHotBlocks::End(IsCompiledFn* isCompiled)
+{
+	if (!IsActive())
+		return;
+
+	uint compiled = 0, used = 0, evicted = 0, discarded = 0, skipped = 0;
+
+	for (size_t i = 0; i < m_profile.size(); i++)
+	{
+		if (m_state[i] == Skipped)
+		{
+			skipped++;
+			continue;
+		}
+
+		if (m_state[i] == Pending)
+			continue;
+
+		compiled++;
+		if (m_used[i])
+			used++;
+		else if (m_state[i] == Evicted)
+			evicted++;
+		else if (!isCompiled(m_profile[i].startpc, m_fnptr[i]))
+		{
+			m_state[i] = Discarded;
+			discarded++;
+		}
+	}
+
+	if (!m_profile.empty())
+	{
+		Console.WriteLn("(EErec) %u of %u profiled blocks precompiled, %u skipped (page changed)",
+			compiled, (uint)m_profile.size(), skipped);
+		Console.WriteLn("(EErec) precompiled blocks: %u used, %u discarded before use, %u evicted by a reset, %u not reached",
+			used, discarded, evicted, compiled - used - discarded - evicted);
+	}
+
+	Save(m_filename);
+	Clear();
+}
+
+void EEHotBlocks::Precompiled(u32 index, uptr fnptr)
+{
+	m_state[index] = Compiled;
+	m_fnptr[index] = fnptr;
+}
+
+// Lets the block be recorded again if the game loads the page later on.
+void EEHotBlocks::Stale(u32 index)
+{
+	m_state[index] = Skipped;
+	m_seen[(m_profile[index].startpc & (Ps2MemSize::MainRam - 1)) / 4] = false;
+}
+
+void EEHotBlocks::Evict()
+{
+	for (size_t i = 0; i < m_state.size(); i++)
+	{
+		if (m_state[i] == Compiled && !m_used[i])
+			m_state[i] = Evicted;
+	}
+}
+
+void EEHotBlocks::Record(u32 startpc, u32 hwaddr, const void* page)
+{
+	if (m_profile.size() + m_trace.size() >= MaxBlocks || m_seen[hwaddr / 4])
+		return;
+
+	m_seen[hwaddr / 4] = true;
+
+	const Entry entry = {startpc, 0, HashPage(page)};
+	m_trace.push_back(entry);
+}
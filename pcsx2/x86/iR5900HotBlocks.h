@@ -0,0 +1,97 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+// --------------------------------------------------------------------------------------
+//  EEHotBlocks
+// --------------------------------------------------------------------------------------
+// Start pcs of the EE blocks a game reached, each with a hash of the 4KB page it was
+// compiled from. The list is saved per ELF when the session ends; on the next boot the
+// recompiler compiles the blocks whose page still hashes the same from the ELF entry point,
+// and each of those blocks sets its byte in Used() on its first run, so the session end can
+// tell the precompiled blocks the game used from the ones it rewrote first.
+class EEHotBlocks
+{
+	DeclareNoncopyableObject(EEHotBlocks);
+
+public:
+	static const u32 MaxBlocks = 65536;
+
+	struct Entry
+	{
+		u32 startpc;
+		u32 reserved;
+		u64 hash;
+	};
+
+	// Answers whether the block compiled at fnptr for startpc is still in the cache.
+	typedef bool IsCompiledFn(u32 startpc, uptr fnptr);
+
+	EEHotBlocks();
+
+	static u64 HashPage(const void* page);
+
+	// Profiles are kept there, one file per ELF. Set by the frontend, nothing is
+	// recorded or precompiled until it is.
+	void SetFolder(const wxDirName& folder) { m_folder = folder; }
+	const wxDirName& GetFolder() const { return m_folder; }
+
+	bool IsActive() const { return !m_filename.IsEmpty(); }
+	const wxString& GetFilename() const { return m_filename; }
+
+	void Begin(const wxString& filename);
+	void End(IsCompiledFn* isCompiled);
+
+	const std::vector<Entry>& GetProfile() const { return m_profile; }
+	void Precompiled(u32 index, uptr fnptr);
+	void Stale(u32 index);
+	void Evict();
+
+	u8* Used(u32 index) { return &m_used[index]; }
+
+	// Blocks compiled on first use, from pages of main ram. The page is only hashed
+	// for blocks not in the profile or trace yet.
+	void Record(u32 startpc, u32 hwaddr, const void* page);
+
+protected:
+	enum State : u8
+	{
+		Pending,		// not compiled at boot, kept
+		Compiled,		// compiled at boot
+		Evicted,		// compiled at boot, then dropped by a reset of the recompiler before use
+		Discarded,		// compiled at boot, then cleared because its page was written before use
+		Skipped,		// page content differs from the recorded one, dropped
+	};
+
+	wxDirName m_folder;
+	wxString m_filename;
+
+	std::vector<Entry> m_profile;
+	std::vector<State> m_state;
+	std::vector<uptr> m_fnptr;
+	std::vector<Entry> m_trace;
+	std::vector<bool> m_seen;			// per word of main ram, block start pcs in the profile or trace
+
+	u8 m_used[MaxBlocks];				// set by the precompiled blocks, needs a static address
+
+	bool Load(const wxString& filename);
+	void Save(const wxString& filename) const;
+	void Clear();
+};
+
+extern EEHotBlocks eeHotBlocks;
@@ -21,6 +21,7 @@
 #include "R5900Exceptions.h"
 #include "R5900OpcodeTables.h"
 #include "iR5900.h"
+#include "iR5900HotBlocks.h"
 #include "BaseblockEx.h"
 #include "System/RecTypes.h"
 
@@ -33,6 +34,7 @@
 #include "Elfheader.h"
 
 #include "../DebugTools/Breakpoints.h"
+#include "../DebugTools/SymbolMap.h"
 #include "Patch.h"
 
 #if !PCSX2_SEH
@@ -47,6 +49,10 @@
 using namespace x86Emitter;
 using namespace R5900;
 
+// Set to 1 to write the block index operations of the session to blocks.trace in the log
+// folder, for tools/blocks_bench.
+#define EE_BLOCK_TRACE 0
+
 #define PC_GETBLOCK(x) PC_GETBLOCK_(x, recLUT)
 
 u32 maxrecmem = 0;
@@ -111,6 +117,7 @@ static u32 dumplog = 0;
 #endif
 
 static void iBranchTest(u32 newpc = 0xffffffff);
+static void iBranchTestReg(bool isReturn);
 static void ClearRecLUT(BASEBLOCK* base, int count);
 static u32 scaleblockcycles();
 
@@ -326,6 +333,7 @@ typedef void DynGenFunc();
 
 static DynGenFunc* DispatcherEvent		= NULL;
 static DynGenFunc* DispatcherReg		= NULL;
+static DynGenFunc* DispatcherRegRefill	= NULL;
 static DynGenFunc* JITCompile			= NULL;
 static DynGenFunc* JITCompileInBlock	= NULL;
 static DynGenFunc* EnterRecompiledCode	= NULL;
@@ -338,6 +346,62 @@ static void recEventTest()
 	_cpuEventTest_Shared();
 }
 
+// --------------------------------------------------------------------------------------
+//  Register jump prediction
+// --------------------------------------------------------------------------------------
+// Register jumps would otherwise all go through DispatcherReg and its recLUT lookup.
+// JR $ra is predicted by a small return stack filled by JAL/JALR, and other register
+// jumps by a per-site cache of their last target.  Both hold the target's BASEBLOCK
+// rather than its x86 code, so a block cleared by recClear just leads to JITCompile.
+
+// Uncomment to print the dispatch statistics every frame.
+//#define PCSX2_EE_DISPATCH_STATS
+
+struct recIndirectCache
+{
+	u32 pc;				// first, the generated code addresses it as [cache]
+	BASEBLOCK* block;
+};
+
+static const u32 RecReturnStackSize = 32;	// must be a power of 2
+static const u32 RecIndirectCacheCount = 0x4000;
+
+static u32 s_rasTop = 0;
+static __aligned16 u32 s_rasPC[RecReturnStackSize];
+static __aligned16 BASEBLOCK* s_rasBlock[RecReturnStackSize];
+
+static recIndirectCache s_indirectCache[RecIndirectCacheCount];
+static u32 s_indirectCacheUsed = 0;
+
+static recDispatchStats s_dispatchCounts;
+static recDispatchStats s_dispatchStats;
+
+static void recResetIndirectPrediction()
+{
+	// pc values are word aligned, so 1 never matches.
+	for (u32 i = 0; i < RecReturnStackSize; i++)
+		s_rasPC[i] = 1;
+	memzero(s_rasBlock);
+	s_rasTop = 0;
+	s_indirectCacheUsed = 0;
+}
+
+void recUpdateDispatchStats()
+{
+	s_dispatchStats = s_dispatchCounts;
+	memzero(s_dispatchCounts);
+
+#ifdef PCSX2_EE_DISPATCH_STATS
+	DevCon.WriteLn("EE dispatch: %u lookups, %u return stack hits, %u site cache hits, %u refills",
+		s_dispatchStats.dispatches, s_dispatchStats.rasHits, s_dispatchStats.cacheHits, s_dispatchStats.cacheRefills);
+#endif
+}
+
+recDispatchStats recGetDispatchStats()
+{
+	return s_dispatchStats;
+}
+
 // The address for all cleared blocks.  It recompiles the current pc and then
 // dispatches to the recompiled block address.
 static DynGenFunc* _DynGen_JITCompile()
@@ -373,6 +437,8 @@ static DynGenFunc* _DynGen_DispatcherReg()
 {
 	u8* retval = xGetPtr();		// fallthrough target, can't align it!
 
+	xADD( ptr32[&s_dispatchCounts.dispatches], 1 );
+
 	// C equivalent:
 	// u32 addr = cpuRegs.pc;
 	// void(**base)() = (void(**)())recLUT[addr >> 16];
@@ -386,6 +452,30 @@ static DynGenFunc* _DynGen_DispatcherReg()
 	return (DynGenFunc*)retval;
 }
 
+// called on a register jump site cache miss, with the site's recIndirectCache in rdx
+static DynGenFunc* _DynGen_DispatcherRegRefill()
+{
+	u8* retval = xGetAlignedCallTarget();
+
+	xADD( ptr32[&s_dispatchCounts.cacheRefills], 1 );
+
+	// C equivalent:
+	// u32 addr = cpuRegs.pc;
+	// cache->pc = addr;
+	// cache->block = PC_GETBLOCK(addr);
+	// cache->block->fnptr();
+	xMOV( eax, ptr[&cpuRegs.pc] );
+	xMOV( ebx, eax );
+	xMOV( ptr32[rdx], eax );
+	xSHR( eax, 16 );
+	xMOV( rcx, ptrNative[xComplexAddress(rcx, recLUT, rax*wordsize)] );
+	xLEA( rcx, ptr[rbx*(wordsize/4) + rcx] );
+	xMOV( ptrNative[rdx + (int)offsetof(recIndirectCache, block)], rcx );
+	xJMP( ptrNative[rcx] );
+
+	return (DynGenFunc*)retval;
+}
+
 static DynGenFunc* _DynGen_DispatcherEvent()
 {
 	u8* retval = xGetPtr();
@@ -450,6 +540,7 @@ static void _DynGen_Dispatchers()
 	DispatcherEvent = _DynGen_DispatcherEvent();
 	DispatcherReg	= _DynGen_DispatcherReg();
 
+	DispatcherRegRefill  = _DynGen_DispatcherRegRefill();
 	JITCompile           = _DynGen_JITCompile();
 	JITCompileInBlock    = _DynGen_JITCompileInBlock();
 	EnterRecompiledCode  = _DynGen_EnterRecompiledCode();
@@ -460,6 +551,11 @@ static void _DynGen_Dispatchers()
 
 	recBlocks.SetJITCompile( JITCompile );
 
+#if EE_BLOCK_TRACE
+	if (!recBlocks.IsTracing())
+		recBlocks.SetTrace(wxFopen(GetLogFolder().Combine(wxFileName(L"blocks.trace")).GetFullPath(), L"w"));
+#endif
+
 	Perf::any.map((uptr)&eeRecDispatchers, 4096, "EE Dispatcher");
 }
 
@@ -591,10 +687,28 @@ static bool eeCpuExecuting = false;
 static bool g_resetEeScalingStats = false;
 static int g_patchesNeedRedo = 0;
 
+// Names the blocks of the perf jitdump after the game symbols, when the ELF has any.
+static bool recPerfSymbol(u32 pc, char* name, size_t size)
+{
+	const u32 start = symbolMap.GetFunctionStart(pc);
+	const bool inFunction = start != SymbolMap::INVALID_ADDRESS;
+	const std::string label = symbolMap.GetLabelString(inFunction ? start : pc);
+	if (label.empty())
+		return false;
+
+	if (inFunction && start != pc)
+		snprintf(name, size, "%s+0x%x", label.c_str(), pc - start);
+	else
+		snprintf(name, size, "%s", label.c_str());
+
+	return true;
+}
+
 ////////////////////////////////////////////////////
 static void recResetRaw()
 {
 	Perf::ee.reset();
+	Perf::ee.set_resolver(recPerfSymbol);
 
 	EE::Profiler.Reset();
 
@@ -618,6 +732,9 @@ static void recResetRaw()
 
 	recBlocks.Reset();
 	mmap_ResetBlockTracking();
+	vtlb_DynGenFastmemReset();
+	recResetIndirectPrediction();
+	eeHotBlocks.Evict();
 
 	x86SetPtr(*recMem);
 
@@ -629,13 +746,21 @@ static void recResetRaw()
 	g_patchesNeedRedo = 1;
 }
 
+static bool recHotBlockCompiled(u32 startpc, uptr fnptr);
+
 static void recShutdown()
 {
+	if (recMem)
+		eeHotBlocks.End(recHotBlockCompiled);
+
 	safe_delete( recMem );
 	safe_aligned_free( recRAMCopy );
 	safe_aligned_free( recLutReserve_RAM );
 
 	recBlocks.Reset();
+#if EE_BLOCK_TRACE
+	recBlocks.SetTrace(NULL);
+#endif
 
 	recRAM = recROM = recROM1 = recROM2 = NULL;
 
@@ -788,64 +913,29 @@ void recClear(u32 addr, u32 size)
 		return;
 	addr = HWADDR(addr);
 
-	int blockidx = recBlocks.LastIndex(addr + size * 4 - 4);
+	const u32 end = addr + size * 4;
+	u32 lowerextent = (u32)-1, upperextent = 0;
 
-	if (blockidx == -1)
-		return;
-
-	u32 lowerextent = (u32)-1, upperextent = 0, ceiling = (u32)-1;
-
-	BASEBLOCKEX* pexblock = recBlocks[blockidx + 1];
-	if (pexblock)
-		ceiling = pexblock->startpc;
-
-	int toRemoveLast = blockidx;
-
-	while (pexblock = recBlocks[blockidx]) {
-		u32 blockstart = pexblock->startpc;
-		u32 blockend = pexblock->startpc + pexblock->size * 4;
-		BASEBLOCK* pblock = PC_GETBLOCK(blockstart);
-
-		if (pblock == s_pCurBlock) {
-			if(toRemoveLast != blockidx) {
-				recBlocks.Remove((blockidx + 1), toRemoveLast);
-			}
-			toRemoveLast = --blockidx;
-			continue;
-		}
-
-		if (blockend <= addr) {
-			lowerextent = std::max(lowerextent, blockend);
-			break;
-		}
-
-		lowerextent = std::min(lowerextent, blockstart);
-		upperextent = std::max(upperextent, blockend);
+	recBlocks.Remove(addr, end, s_pCurBlockEx, [&](BASEBLOCKEX& block) {
+		lowerextent = std::min(lowerextent, block.startpc);
+		upperextent = std::max(upperextent, block.startpc + block.size * 4);
 		// This might end up inside a block that doesn't contain the clearing range,
 		// so set it to recompile now.  This will become JITCompile if we clear it.
-		pblock->SetFnptr((uptr)JITCompileInBlock);
+		PC_GETBLOCK(block.startpc)->SetFnptr((uptr)JITCompileInBlock);
+	});
 
-		blockidx--;
-	}
+	if (upperextent <= lowerextent)
+		return;
 
-	if(toRemoveLast != blockidx) {
-		recBlocks.Remove((blockidx + 1), toRemoveLast);
-	}
+	// Keep the lut of the blocks around the range that survive.
+	recBlocks.ForEach(lowerextent, addr, [&](BASEBLOCKEX& block) {
+		if (&block != s_pCurBlockEx)
+			lowerextent = std::max(lowerextent, block.startpc + block.size * 4);
+		return true;
+	});
 
-	upperextent = std::min(upperextent, ceiling);
-
-	for (int i = 0; pexblock = recBlocks[i]; i++) {
-		if (s_pCurBlock == PC_GETBLOCK(pexblock->startpc))
-			continue;
-		u32 blockend = pexblock->startpc + pexblock->size * 4;
-		if (pexblock->startpc >= addr && pexblock->startpc < addr + size * 4
-		 || pexblock->startpc < addr && blockend > addr) {
-			if( !IsDevBuild )
-				Console.Error( "Impossible block clearing failure" );
-			else
-				pxFailDev( "Impossible block clearing failure" );
-		}
-	}
+	if (BASEBLOCKEX* ceiling = recBlocks.Next(end, upperextent))
+		upperextent = ceiling->startpc;
 
 	if (upperextent > lowerextent)
 		ClearRecLUT(PC_GETBLOCK(lowerextent), upperextent - lowerextent);
@@ -854,7 +944,8 @@ void recClear(u32 addr, u32 size)
 
 static int *s_pCode;
 
-void SetBranchReg( u32 reg )
+// isReturn - the jump is a JR $ra, predicted with the return stack
+void SetBranchReg( u32 reg, bool isReturn )
 {
 	g_branch = 1;
 
@@ -901,7 +992,61 @@ void SetBranchReg( u32 reg )
 
 	iFlushCall(FLUSH_EVERYTHING);
 
-	iBranchTest();
+	iBranchTestReg(isReturn);
+}
+
+// Pushes a call's return address on the return stack.  Registers must be flushed.
+void recPushReturnAddress( u32 retpc )
+{
+	// Goemon's TLB hack translates jump targets, so returns would never match.
+	if (EmuConfig.Gamefixes.GoemonTlbHack) return;
+	// Unmapped pages resolve to a NULL page base, the same way PC_GETBLOCK indexes them.
+	if (!PC_GETBLOCK(retpc & ~0xFFFFu)) return;
+
+	xMOV(eax, ptr[&s_rasTop]);
+	xADD(eax, 1);
+	xAND(eax, RecReturnStackSize - 1);
+	xMOV(ptr[&s_rasTop], eax);
+	xMOV(ptr32[xComplexAddress(rcx, s_rasPC, rax*4)], retpc);
+	xLoadFarAddr(rdx, PC_GETBLOCK(retpc));
+	xMOV(ptrNative[xComplexAddress(rcx, s_rasBlock, rax*wordsize)], rdx);
+}
+
+// Dispatches to cpuRegs.pc at the end of a register jump.
+// isReturn - ecx holds the return stack slot popped by iBranchTestReg
+static void recDispatchReg( bool isReturn )
+{
+	xMOV(eax, ptr[&cpuRegs.pc]);
+
+	if (isReturn)
+	{
+		xCMP(eax, ptr32[xComplexAddress(rdx, s_rasPC, rcx*4)]);
+		xForwardJNE8 rasMiss;
+
+		xMOV(rdx, ptrNative[xComplexAddress(rdx, s_rasBlock, rcx*wordsize)]);
+		xADD(ptr32[&s_dispatchCounts.rasHits], 1);
+		xJMP(ptrNative[rdx]);
+
+		rasMiss.SetTarget();
+	}
+
+	if (s_indirectCacheUsed >= RecIndirectCacheCount)
+	{
+		xJMP((void*)DispatcherReg);
+		return;
+	}
+
+	recIndirectCache* cache = &s_indirectCache[s_indirectCacheUsed++];
+	cache->pc = 1;
+	cache->block = NULL;
+
+	xLoadFarAddr(rdx, cache);
+	xCMP(eax, ptr32[rdx]);
+	xJNE((void*)DispatcherRegRefill);
+
+	xMOV(rdx, ptrNative[rdx + (int)offsetof(recIndirectCache, block)]);
+	xADD(ptr32[&s_dispatchCounts.cacheHits], 1);
+	xJMP(ptrNative[rdx]);
 }
 
 void SetBranchImm( u32 imm )
@@ -1090,12 +1235,37 @@ static void iBranchTest(u32 newpc)
 		if (newpc == 0xffffffff)
 			xJS( DispatcherReg );
 		else
-			recBlocks.Link(HWADDR(newpc), xJcc32(Jcc_Signed));
+			recBlocks.Link(HWADDR(newpc), xJcc32(Jcc_Signed), s_pCurBlockEx);
 
 		xJMP( (void*)DispatcherEvent );
 	}
 }
 
+// Same as iBranchTest(0xffffffff), but dispatches through the register jump prediction.
+static void iBranchTestReg(bool isReturn)
+{
+	// Pop the return stack even when leaving for the event test, so that it stays in
+	// step with the guest's calls and returns.
+	if (isReturn)
+	{
+		xMOV(ecx, ptr[&s_rasTop]);
+		xLEA(edx, ptr[rcx - 1]);
+		xAND(edx, RecReturnStackSize - 1);
+		xMOV(ptr[&s_rasTop], edx);
+	}
+
+	xMOV(eax, ptr[&cpuRegs.cycle]);
+	xADD(eax, scaleblockcycles());
+	xMOV(ptr[&cpuRegs.cycle], eax); // update cycles
+	xSUB(eax, ptr[&g_nextEventCycle]);
+
+	xForwardJNS32 eventTest;
+	recDispatchReg(isReturn);
+
+	eventTest.SetTarget();
+	xJMP( (void*)DispatcherEvent );
+}
+
 #ifdef PCSX2_DEVBUILD
 // opcode 'code' modifies:
 // 1: status
@@ -1213,26 +1383,15 @@ void __fastcall dynarecMemLogcheck(u32 start, bool store)
 		DevCon.WriteLn("Hit load breakpoint @0x%x", start);
 }
 
-void recMemcheck(u32 op, u32 bits, bool store)
+// Slow path of the memcheck test, only reached for accesses that
+// touch a page with at least one memcheck of the right kind.
+static void dynarecMemcheckRange(u32 start, u32 size, bool store)
 {
-	iFlushCall(FLUSH_EVERYTHING|FLUSH_PC);
-
-	// compute accessed address
-	_eeMoveGPRtoR(ecx, (op >> 21) & 0x1F);
-	if ((s16)op != 0)
-		xADD(ecx, (s16)op);
-	if (bits == 128)
-		xAND(ecx, ~0x0F);
-
-	xFastCall((void*)standardizeBreakpointAddress, ecx);
-	xMOV(ecx,eax);
-	xMOV(edx,eax);
-	xADD(edx,bits/8);
+	start = standardizeBreakpointAddress(start);
+	u32 end = start + size;
 
-	// ecx = access address
-	// edx = access address+size
-
-	auto checks = CBreakPoints::GetMemChecks();
+	bool hit = false;
+	const auto& checks = CBreakPoints::GetMemChecks();
 	for (size_t i = 0; i < checks.size(); i++)
 	{
 		if (checks[i].result == 0)
@@ -1243,27 +1402,58 @@ void recMemcheck(u32 op, u32 bits, bool store)
 			continue;
 
 		// logic: memAddress < bpEnd && bpStart < memAddress+memSize
+		if (start >= standardizeBreakpointAddress(checks[i].end) || standardizeBreakpointAddress(checks[i].start) >= end)
+			continue;
 
-		xMOV(eax,standardizeBreakpointAddress(checks[i].end));
-		xCMP(ecx,eax);				// address < end
-		xForwardJGE8 next1;			// if address >= end then goto next1
+		if (checks[i].result & MEMCHECK_LOG)
+			dynarecMemLogcheck(start, store);
+		if (checks[i].result & MEMCHECK_BREAK)
+			hit = true;
+	}
 
-		xMOV(eax,standardizeBreakpointAddress(checks[i].start));
-		xCMP(eax,edx);				// start < address+size
-		xForwardJGE8 next2;			// if start >= address+size then goto next2
+	if (hit)
+		dynarecMemcheck();
+}
 
-		// hit the breakpoint
-		if (checks[i].result & MEMCHECK_LOG) {
-			xMOV(edx, store);
-			xFastCall((void*)dynarecMemLogcheck, ecx, edx);
-		}
-		if (checks[i].result & MEMCHECK_BREAK) {
-			xFastCall((void*)dynarecMemcheck);
-		}
+template< bool store >
+static void __fastcall dynarecMemcheckAccess(u32 start, u32 size)
+{
+	if (CBreakPoints::IsMemCheckPage(start, size, store))
+		dynarecMemcheckRange(start, size, store);
+}
 
-		next1.SetTarget();
-		next2.SetTarget();
+void recMemcheck(u32 op, u32 bits, bool store)
+{
+	const int rs = (op >> 21) & 0x1F;
+
+	// Known address: only emit the check if its page can hit a memcheck at all.
+	if (GPR_IS_CONST1(rs))
+	{
+		u32 start = g_cpuConstRegs[rs].UL[0] + (s16)op;
+		if (bits == 128)
+			start &= ~0x0F;
+
+		if (!CBreakPoints::IsMemCheckPage(start, bits/8, store))
+			return;
 	}
+
+	iFlushCall(FLUSH_EVERYTHING|FLUSH_PC);
+
+	// compute accessed address
+	_eeMoveGPRtoR(ecx, rs);
+	if ((s16)op != 0)
+		xADD(ecx, (s16)op);
+	if (bits == 128)
+		xAND(ecx, ~0x0F);
+
+	// ecx = access address
+	// edx = access size
+	// The page test is done in C so the emitted code doesn't grow with the number of memchecks.
+	xMOV(edx, bits/8);
+	if (store)
+		xFastCall((void*)dynarecMemcheckAccess<true>, ecx, edx);
+	else
+		xFastCall((void*)dynarecMemcheckAccess<false>, ecx, edx);
 }
 
 void encodeBreakpoint()
@@ -1651,6 +1841,96 @@ void doPlace0Patches()
     ApplyLoadedPatches(PPT_ONCE_ON_LOAD);
 }
 
+// --------------------------------------------------------------------------------------
+//  Block profiles
+// --------------------------------------------------------------------------------------
+// Games run a few thousand blocks before they settle, and compiling them all on first use
+// is what makes the first minutes of heavy titles stutter. The blocks a game compiled are
+// saved per ELF (see EEHotBlocks); when it boots again the ones whose page of main ram
+// hashes the same are compiled before the entry point runs.
+
+// Set while a block of the profile is compiled; the block writes 1 there when it runs.
+static u8* s_precompileUsed = NULL;
+
+static bool recHotBlockCompiled(u32 startpc, uptr fnptr)
+{
+	const BASEBLOCKEX* block = recBlocks.Get(HWADDR(startpc));
+	return block && block->startpc == HWADDR(startpc) && block->fnptr == fnptr;
+}
+
+// Code below 1MB is the kernel and EELOAD, compiled during the boot anyway and home of the
+// eeload hooks.
+static bool recHotBlockEligible(u32 startpc)
+{
+	const u32 hwaddr = HWADDR(startpc);
+	return hwaddr >= _1mb && hwaddr < Ps2MemSize::MainRam && PSM(startpc);
+}
+
+// Precompiling leaves at least half of the code cache and const buffer to the game, and
+// never resets the recompiler: this runs from the entry block.
+static bool recPrecompileHasRoom()
+{
+	return !eeRecNeedsReset
+		&& recPtr < recMem->GetPtr() + (recMem->GetPtrEnd() - recMem->GetPtr()) / 2
+		&& (recConstBufPtr - recConstBuf) < RECCONSTBUF_SIZE / 2;
+}
+
+// Called from the ELF entry block, after eeGameStarting and the patches.
+static void recPrecompileHotBlocks()
+{
+	if (!g_GameStarted || !ElfCRC || !eeHotBlocks.GetFolder().IsOk())
+		return;
+
+	const wxString filename(eeHotBlocks.GetFolder().Combine(wxFileName(wxsFormat(L"%08X.blocks", ElfCRC))).GetFullPath());
+
+	// The entry point is run again by some games, that isn't a new session.
+	if (eeHotBlocks.GetFilename() == filename)
+		return;
+
+	eeHotBlocks.End(recHotBlockCompiled);
+	eeHotBlocks.Begin(filename);
+
+	const std::vector<EEHotBlocks::Entry>& profile = eeHotBlocks.GetProfile();
+	if (profile.empty())
+		return;
+
+	const u32 code = cpuRegs.code;
+	u64 start = GetCPUTicks();
+	uint compiled = 0;
+
+	for (u32 i = 0; i < profile.size() && recPrecompileHasRoom(); i++)
+	{
+		const u32 startpc = profile[i].startpc;
+		if (!recHotBlockEligible(startpc))
+		{
+			eeHotBlocks.Stale(i);
+			continue;
+		}
+
+		BASEBLOCK* block = PC_GETBLOCK(startpc);
+		if (block->GetFnptr() != (uptr)JITCompile && block->GetFnptr() != (uptr)JITCompileInBlock)
+			continue;
+
+		if (EEHotBlocks::HashPage(PSM(startpc & ~0xfff)) != profile[i].hash)
+		{
+			eeHotBlocks.Stale(i);
+			continue;
+		}
+
+		s_precompileUsed = eeHotBlocks.Used(i);
+		recRecompile(startpc);
+		s_precompileUsed = NULL;
+
+		eeHotBlocks.Precompiled(i, block->GetFnptr());
+		compiled++;
+	}
+
+	cpuRegs.code = code;
+
+	Console.WriteLn("(EErec) Precompiled %u of %u profiled blocks in %.1f ms", compiled, (uint)profile.size(),
+		(GetCPUTicks() - start) * 1000.0 / GetTickFrequency());
+}
+
 static void __fastcall recRecompile( const u32 startpc )
 {
 	u32 i = 0;
@@ -1674,6 +1954,11 @@ static void __fastcall recRecompile( const u32 startpc )
 
 	if (eeRecNeedsReset) recResetRaw();
 
+	// Compiles come from the dispatcher, no block is running, but for the precompile of
+	// the profiled blocks that runs from the entry block.
+	if (!s_precompileUsed)
+		recBlocks.ReleaseOrphans();
+
 	xSetPtr( recPtr );
 	recPtr = xGetAlignedCallTarget();
 
@@ -1692,6 +1977,8 @@ static void __fastcall recRecompile( const u32 startpc )
 
 	pxAssert(s_pCurBlockEx);
 
+	vtlb_DynGenFastmemBegin();
+
 	if (HWADDR(startpc) == EELOAD_START)
 	{
 		// The EELOAD _start function is the same across all BIOS versions
@@ -1736,12 +2023,27 @@ static void __fastcall recRecompile( const u32 startpc )
 	if (g_GameLoading && HWADDR(startpc) == ElfEntry) {
 		Console.WriteLn(L"Elf entry point @ 0x%08x about to get recompiled. Load patches first.", startpc);
 		xFastCall((void*)eeGameStarting);
+		if (EmuConfig.Cpu.Recompiler.PrecompileEE)
+			xFastCall((void*)recPrecompileHotBlocks);
 
 		// Apply patch as soon as possible. Normally it is done in
 		// eeGameStarting but first block is already compiled.
 		doPlace0Patches();
 	}
 
+	// A precompiled block sets its used byte on its first run only: the second store turns
+	// the jump in front of them into a jump over both, later runs don't touch memory.
+	if (s_precompileUsed) {
+		xWrite8(0xEB);			// jmp rel8, to the next instruction for now
+		xWrite8(0);
+		u8* skip = xGetPtr() - 1;
+		xMOV(ptr8[s_precompileUsed], 1);
+		xMOV(ptr8[skip], 0);
+		const sptr dist = xGetPtr() - (skip + 1);
+		pxAssert(dist <= 0x7f);
+		xGetPtr()[-1] = (u8)dist;
+	}
+
 	g_branch = 0;
 
 	// reset recomp state variables
@@ -2057,30 +2359,20 @@ StartRecomp:
 #endif
 
 	pxAssert( (pc-startpc)>>2 <= 0xffff );
-	s_pCurBlockEx->size = (pc-startpc)>>2;
+	recBlocks.SetSize(s_pCurBlockEx, (pc-startpc)>>2);
 
 	if (HWADDR(pc) <= Ps2MemSize::MainRam) {
-		BASEBLOCKEX *oldBlock;
-		int i;
+		bool modified = false;
 
-		i = recBlocks.LastIndex(HWADDR(pc) - 4);
-		while (oldBlock = recBlocks[i--]) {
-			if (oldBlock == s_pCurBlockEx)
-				continue;
-			if (oldBlock->startpc >= HWADDR(pc))
-				continue;
-			if ((oldBlock->startpc + oldBlock->size * 4) <= HWADDR(startpc))
-				break;
+		recBlocks.ForEach(HWADDR(startpc), HWADDR(pc), [&](BASEBLOCKEX& oldBlock) {
+			if (&oldBlock != s_pCurBlockEx)
+				modified = memcmp(&recRAMCopy[oldBlock.startpc / 4], PSM(oldBlock.startpc), oldBlock.size * 4) != 0;
+			return !modified;
+		});
 
-			if (memcmp(&recRAMCopy[oldBlock->startpc / 4], PSM(oldBlock->startpc),
-			           oldBlock->size * 4))
-			{
-				recClear(startpc, (pc - startpc) / 4);
-				s_pCurBlockEx = recBlocks.Get(HWADDR(startpc));
-				pxAssert(s_pCurBlockEx->startpc == HWADDR(startpc));
-				break;
-			}
-		}
+		// recClear keeps the current block
+		if (modified)
+			recClear(startpc, (pc - startpc) / 4);
 
 		memcpy(&recRAMCopy[HWADDR(startpc) / 4], PSM(startpc), pc - startpc);
 	}
@@ -2128,11 +2420,14 @@ StartRecomp:
 			{
 				xMOV( ptr32[&cpuRegs.pc], pc );
 				xADD( ptr32[&cpuRegs.cycle], scaleblockcycles() );
-				recBlocks.Link( HWADDR(pc), xJcc32() );
+				recBlocks.Link( HWADDR(pc), xJcc32(), s_pCurBlockEx );
 			}
 		}
 	}
 
+	// Out of line slow paths for the block's fastmem accesses
+	vtlb_DynGenFastmemEnd(s_pCurBlockEx->startpc);
+
 	pxAssert( xGetPtr() < recMem->GetPtrEnd() );
 	pxAssert( recConstBufPtr < recConstBuf + RECCONSTBUF_SIZE );
 
@@ -2147,6 +2442,9 @@ StartRecomp:
 #endif
 	Perf::ee.map(s_pCurBlockEx->fnptr, s_pCurBlockEx->x86size, s_pCurBlockEx->startpc);
 
+	if (g_GameStarted && !s_precompileUsed && eeHotBlocks.IsActive() && recHotBlockEligible(startpc))
+		eeHotBlocks.Record(startpc, HWADDR(startpc), PSM(startpc & ~0xfff));
+
 	recPtr = xGetPtr();
 
 	pxAssert( (g_cpuHasConstReg&g_cpuFlushedConstReg) == g_cpuHasConstReg );
@@ -64,6 +64,7 @@ void recJAL()
 	EE::Profiler.EmitOp(eeOpcode::JAL);
 
 	u32 newpc = (_InstrucTarget_ << 2) + ( pc & 0xf0000000 );
+	u32 retpc = pc + 4;
 	_deleteEEreg(31, 0);
 	if(EE_CONST_PROP)
 	{
@@ -78,6 +79,10 @@ void recJAL()
 	}
 
 	recompileNextInstruction(1);
+
+	iFlushCall(FLUSH_EVERYTHING);
+	recPushReturnAddress(retpc);
+
 	if (EmuConfig.Gamefixes.GoemonTlbHack)
 		SetBranchImm(vtlb_V2P(newpc));
 	else
@@ -94,7 +99,7 @@ void recJR()
 {
 	EE::Profiler.EmitOp(eeOpcode::JR);
 
-	SetBranchReg( _Rs_);
+	SetBranchReg( _Rs_, _Rs_ == 31 );
 }
 
 ////////////////////////////////////////////////////
@@ -157,6 +162,11 @@ void recJALR()
 		xMOV(ptr[&cpuRegs.pc], eax);
 	}
 
+	iFlushCall(FLUSH_EVERYTHING);
+	// Only calls linking $ra come back through jr $ra
+	if (_Rd_ == 31)
+		recPushReturnAddress(newpc);
+
 	SetBranchReg(0xffffffff);
 }
 
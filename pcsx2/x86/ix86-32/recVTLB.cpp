@@ -22,6 +22,10 @@
 #include "iCore.h"
 #include "iR5900.h"
 #include "Utilities/Perf.h"
+#include "Utilities/PageFaultSource.h"
+
+#include <map>
+#include <unordered_map>
 
 using namespace vtlb_private;
 using namespace x86Emitter;
@@ -30,6 +34,9 @@ using namespace x86Emitter;
 // iAllocRegSSE -- allocates an xmm register.  If no xmm register is available, xmm0 is
 // saved into g_globalXMMData and returned as a free register.
 //
+// allowAlloc - false for code emitted out of line (fastmem slow paths), where the register
+//   allocator state doesn't match the state at the point the code runs.
+//
 class iAllocRegSSE
 {
 protected:
@@ -37,9 +44,9 @@ protected:
 	bool m_free;
 
 public:
-	iAllocRegSSE() :
+	iAllocRegSSE( bool allowAlloc = true ) :
 		m_reg( xmm0 ),
-		m_free( !!_hasFreeXMMreg() )
+		m_free( allowAlloc && !!_hasFreeXMMreg() )
 	{
 		if( m_free )
 			m_reg = xRegisterSSE( _allocTempXMMreg( XMMT_INT, -1 ) );
@@ -62,9 +69,9 @@ public:
 // This instruction always uses an SSE register, even if all registers are allocated!  It
 // saves an SSE register to memory first, performs the copy, and restores the register.
 //
-static void iMOV128_SSE( const xIndirectVoid& destRm, const xIndirectVoid& srcRm )
+static void iMOV128_SSE( const xIndirectVoid& destRm, const xIndirectVoid& srcRm, bool allowAlloc = true )
 {
-	iAllocRegSSE reg;
+	iAllocRegSSE reg( allowAlloc );
 	xMOVDQA( reg, srcRm );
 	xMOVDQA( destRm, reg );
 }
@@ -154,10 +161,11 @@ namespace vtlb_private
 	// Prepares eax, ecx, and, ebx for Direct or Indirect operations.
 	// Returns the writeback pointer for ebx (return address from indirect handling)
 	//
-	static u32* DynGen_PrepRegs()
+	static u32* DynGen_PrepRegs( bool profile = true )
 	{
 		// Warning dirty ebx (in case someone got the very bad idea to move this code)
-		EE::Profiler.EmitMem();
+		if( profile )
+			EE::Profiler.EmitMem();
 
 		xMOV( eax, arg1regd );
 		xSHR( eax, VTLB_PAGE_BITS );
@@ -169,34 +177,36 @@ namespace vtlb_private
 	}
 
 	// ------------------------------------------------------------------------
-	static void DynGen_DirectRead( u32 bits, bool sign )
+	// addr - host address of the data
+	// inln - false when emitted out of line (see iAllocRegSSE)
+	static void DynGen_DirectRead( u32 bits, bool sign, const xAddressReg& addr = arg1reg, bool inln = true )
 	{
 		switch( bits )
 		{
 			case 8:
 				if( sign )
-					xMOVSX( eax, ptr8[arg1reg] );
+					xMOVSX( eax, ptr8[addr] );
 				else
-					xMOVZX( eax, ptr8[arg1reg] );
+					xMOVZX( eax, ptr8[addr] );
 			break;
 
 			case 16:
 				if( sign )
-					xMOVSX( eax, ptr16[arg1reg] );
+					xMOVSX( eax, ptr16[addr] );
 				else
-					xMOVZX( eax, ptr16[arg1reg] );
+					xMOVZX( eax, ptr16[addr] );
 			break;
 
 			case 32:
-				xMOV( eax, ptr[arg1reg] );
+				xMOV( eax, ptr[addr] );
 			break;
 
 			case 64:
-				iMOV64_Smart( ptr[arg2reg], ptr[arg1reg] );
+				iMOV64_Smart( ptr[arg2reg], ptr[addr] );
 			break;
 
 			case 128:
-				iMOV128_SSE( ptr[arg2reg], ptr[arg1reg] );
+				iMOV128_SSE( ptr[arg2reg], ptr[addr], inln );
 			break;
 
 			jNO_DEFAULT
@@ -204,7 +214,7 @@ namespace vtlb_private
 	}
 
 	// ------------------------------------------------------------------------
-	static void DynGen_DirectWrite( u32 bits )
+	static void DynGen_DirectWrite( u32 bits, const xAddressReg& addr = arg1reg, bool inln = true )
 	{
 		// TODO: x86Emitter can't use dil (and xRegister8(rdi.Id) is not dil)
 		switch(bits)
@@ -212,23 +222,23 @@ namespace vtlb_private
 			//8 , 16, 32 : data on EDX
 			case 8:
 				xMOV( edx, arg2regd );
-				xMOV( ptr[arg1reg], dl );
+				xMOV( ptr[addr], dl );
 			break;
 
 			case 16:
-				xMOV( ptr[arg1reg], xRegister16(arg2reg.Id) );
+				xMOV( ptr[addr], xRegister16(arg2reg.Id) );
 			break;
 
 			case 32:
-				xMOV( ptr[arg1reg], arg2regd );
+				xMOV( ptr[addr], arg2regd );
 			break;
 
 			case 64:
-				iMOV64_Smart( ptr[arg1reg], ptr[arg2reg] );
+				iMOV64_Smart( ptr[addr], ptr[arg2reg] );
 			break;
 
 			case 128:
-				iMOV128_SSE( ptr[arg1reg], ptr[arg2reg] );
+				iMOV128_SSE( ptr[addr], ptr[arg2reg], inln );
 			break;
 		}
 	}
@@ -367,12 +377,191 @@ static void vtlb_SetWriteback(u32 *writeback)
 	*writeback = val;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//                            Fastmem
+//
+// When the vtlb has a fastmem window (see vtlb.cpp), non-const loads and stores access
+// window[addr] directly:
+//
+//	mov ebx, ecx
+//	mov rax, window
+//	add rbx, rax
+//	mov eax, [rbx]		; or the store / 64 / 128 bit flavor
+//
+// Pages which are not plain memory (I/O, unmapped, other components' memory) are not mapped
+// in the window.  Touching one faults; the fault handler below then patches the start of
+// the site into a jump to its regular vtlb sequence (emitted after the block) and resumes
+// there, so each site pays for at most one fault.
+
+struct FastmemSite
+{
+	u8* code;		// start of the fast access, overwritten with a jmp when patched
+	u8* resume;		// first instruction after the fast access
+	u8* stub;		// the regular vtlb sequence, which jumps back to resume
+	u32 blockpc;
+	u8 mode;
+	u8 bits;
+	bool sign;
+};
+
+// Uncomment to print backpatch statistics on every EE rec reset.
+//#define PCSX2_FASTMEM_STATS
+
+static bool s_fastmem_codegen = false;
+static std::vector<FastmemSite> s_fastmem_pending;
+
+// Sites of every block compiled since the last rec reset, keyed by resume address.
+static std::map<uptr, FastmemSite> s_fastmem_sites;
+static std::unordered_map<u32, u32> s_fastmem_block_patches;
+static vtlb_FastmemStats s_fastmem_stats;
+
+class FastmemFaultHandler : public EventListener_PageFault
+{
+public:
+	void OnPageFaultEvent( const PageFaultInfo& info, bool& handled );
+};
+
+static FastmemFaultHandler* s_fastmem_handler = NULL;
+
+void FastmemFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& handled )
+{
+	// Only the EE thread touches the window, which keeps other threads away from the
+	// site map below.
+	if( !s_fastmem_codegen || !vtlb_FastmemIsWindowAddress( info.addr ) ) return;
+
+	// Writes to block-tracked ram are mmap_PageFaultHandler's business.
+	u32 ramoffset;
+	if( vtlb_FastmemGetRamOffset( info.addr, ramoffset ) ) return;
+
+	auto it = s_fastmem_sites.upper_bound( info.pc );
+	if( it == s_fastmem_sites.end() || info.pc < (uptr)it->second.code ) return;
+
+	const FastmemSite& site = it->second;
+
+	site.code[0] = 0xe9;	// jmp rel32
+	*(s32*)(site.code + 1) = (s32)(site.stub - (site.code + 5));
+
+	u32& block_patches = s_fastmem_block_patches[site.blockpc];
+	if( !block_patches++ )
+		s_fastmem_stats.blocks++;
+	s_fastmem_stats.backpatches++;
+
+	eeRecPerfLog.Write( "Fastmem: backpatched %s%u @ 0x%08x (block 0x%08x, %u patched)",
+		site.mode ? "write" : "read", site.bits, (u32)(info.addr - (uptr)vtlb_FastmemBase()),
+		site.blockpc, block_patches );
+
+	Source_PageFault->SetResumeAddress( (uptr)site.stub );
+	handled = true;
+}
+
+// Called on EE rec reset: all sites are gone along with the code cache.
+void vtlb_DynGenFastmemReset()
+{
+#ifdef PCSX2_FASTMEM_STATS
+	if( s_fastmem_stats.sites )
+	{
+		Console.WriteLn( "(vtlb) Fastmem: %u sites, %u backpatched in %u blocks",
+			s_fastmem_stats.sites, s_fastmem_stats.backpatches, s_fastmem_stats.blocks );
+
+		std::vector<std::pair<u32, u32>> blocks( s_fastmem_block_patches.begin(), s_fastmem_block_patches.end() );
+		std::sort( blocks.begin(), blocks.end(), []( const std::pair<u32, u32>& a, const std::pair<u32, u32>& b ) {
+			return a.second > b.second;
+		});
+		for( size_t i = 0; i < std::min<size_t>( blocks.size(), 8 ); i++ )
+			Console.WriteLn( "\tblock 0x%08x: %u", blocks[i].first, blocks[i].second );
+	}
+#endif
+
+	s_fastmem_pending.clear();
+	s_fastmem_sites.clear();
+	s_fastmem_block_patches.clear();
+	s_fastmem_stats = vtlb_FastmemStats();
+
+	s_fastmem_codegen = EmuConfig.Cpu.Recompiler.EnableFastmem && vtlb_FastmemBase() != NULL;
+
+	if( s_fastmem_codegen && !s_fastmem_handler )
+	{
+		pxAssert( Source_PageFault );
+		s_fastmem_handler = new FastmemFaultHandler();
+	}
+}
+
+void vtlb_DynGenFastmemBegin()
+{
+	s_fastmem_pending.clear();
+}
+
+// Emits the out of line vtlb sequences for the fastmem sites of the block just compiled.
+void vtlb_DynGenFastmemEnd( u32 startpc )
+{
+	for( FastmemSite& site : s_fastmem_pending )
+	{
+		site.stub = xGetPtr();
+		site.blockpc = startpc;
+
+		u32* writeback = DynGen_PrepRegs( false );
+		DynGen_IndirectDispatch( site.mode, site.bits, site.sign );
+		if( site.mode )
+			DynGen_DirectWrite( site.bits, arg1reg, false );
+		else
+			DynGen_DirectRead( site.bits, site.sign, arg1reg, false );
+		vtlb_SetWriteback( writeback );
+
+		xJMP( site.resume );
+
+		s_fastmem_sites[(uptr)site.resume] = site;
+	}
+
+	s_fastmem_pending.clear();
+}
+
+vtlb_FastmemStats vtlb_GetFastmemStats()
+{
+	return s_fastmem_stats;
+}
+
+// Emits a fastmem access if enabled; returns false if the regular sequence is needed.
+static bool DynGen_FastmemAccess( int mode, u32 bits, bool sign )
+{
+#ifdef __M_X86_64
+	if( !s_fastmem_codegen ) return false;
+
+	EE::Profiler.EmitMem();
+
+	FastmemSite site;
+	site.code = xGetPtr();
+	site.mode = mode;
+	site.bits = bits;
+	site.sign = sign;
+
+	xMOV( ebx, arg1regd );
+	xMOV64( rax, (sptr)vtlb_FastmemBase() );
+	xADD( rbx, rax );
+
+	if( mode )
+		DynGen_DirectWrite( bits, rbx );
+	else
+		DynGen_DirectRead( bits, sign, rbx );
+
+	site.resume = xGetPtr();
+	pxAssert( site.resume - site.code >= 5 );
+
+	s_fastmem_pending.push_back( site );
+	s_fastmem_stats.sites++;
+	return true;
+#else
+	return false;
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //                            Dynarec Load Implementations
 void vtlb_DynGenRead64(u32 bits)
 {
 	pxAssume( bits == 64 || bits == 128 );
 
+	if( DynGen_FastmemAccess( 0, bits, false ) ) return;
+
 	u32* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 0, bits );
@@ -389,6 +578,8 @@ void vtlb_DynGenRead32(u32 bits, bool sign)
 {
 	pxAssume( bits <= 32 );
 
+	if( DynGen_FastmemAccess( 0, bits, sign && bits < 32 ) ) return;
+
 	u32* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 0, bits, sign && bits < 32 );
@@ -523,6 +714,8 @@ void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const )
 
 void vtlb_DynGenWrite(u32 sz)
 {
+	if( DynGen_FastmemAccess( 1, sz, false ) ) return;
+
 	u32* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 1, sz );
@@ -105,6 +105,9 @@ void mVUreset(microVU& mVU, bool resetReserve) {
 	mVU.prog.total		=  0;
 	mVU.prog.curFrame	=  0;
 
+	// Micro memory contents are unknown (savestate load, etc), so rehash all of it on the next search
+	memset(mVU.prog.chunkDirty, 0xff, sizeof(mVU.prog.chunkDirty));
+
 	// Setup Dynarec Cache Limits for Each Program
 	u8* z = mVU.cache;
 	mVU.prog.x86start	= z;
@@ -150,6 +153,17 @@ void mVUclose(microVU& mVU) {
 
 // Clears Block Data in specified range
 __fi void mVUclear(mV, u32 addr, u32 size) {
+	// Mark the written chunks so their hashes get recomputed by the next program search
+	u32 chunks = mVU.microMemSize / mProgChunkSize;
+	u32 first  = (addr & (mVU.microMemSize - 1)) / mProgChunkSize;
+	u32 count  = std::min((size + (addr % mProgChunkSize) + mProgChunkSize - 1) / mProgChunkSize, chunks);
+	for (u32 i = 0; i < count; i++) {
+		u32 chunk = (first + i) & (chunks - 1);
+		mVU.prog.chunkDirty[chunk / 32] |= 1u << (chunk % 32);
+		mVU.prog.uploaded  [chunk / 32] |= 1u << (chunk % 32);
+	}
+	mVU.prog.specCount = 0; // Candidates are picked again with this upload
+
 	if(!mVU.prog.cleared) {
 		mVU.prog.cleared = 1;		// Next execution searches/creates a new microprogram
 		memzero(mVU.prog.lpState); // Clear pipeline state
@@ -167,10 +181,28 @@ __fi void mVUclear(mV, u32 addr, u32 size) {
 // Finds and Ages/Kills Programs if they haven't been used in a while.
 __ri void mVUvsyncUpdate(mV) {
 	//mVU.prog.curFrame++;
+	mVU.progStats.lastLookups  = mVU.progStats.lookups.exchange(0, std::memory_order_relaxed);
+	mVU.progStats.lastProbes   = mVU.progStats.probes.exchange(0, std::memory_order_relaxed);
+	mVU.progStats.lastFullCmps = mVU.progStats.fullCmps.exchange(0, std::memory_order_relaxed);
+	mVU.progStats.lastPrecompiles    = mVU.progStats.precompiles.exchange(0, std::memory_order_relaxed);
+	mVU.progStats.lastPrecompileHits = mVU.progStats.precompileHits.exchange(0, std::memory_order_relaxed);
+#ifdef mVUprofileProgCache
+	if (mVU.progStats.lastLookups || mVU.progStats.lastPrecompiles) {
+		DevCon.WriteLn("microVU%d: Prog Cache [Lookups=%d] [Probes=%d] [FullCmps=%d] [Precompiled=%d] [CompilesAvoided=%d]", mVU.index,
+			mVU.progStats.lastLookups, mVU.progStats.lastProbes, mVU.progStats.lastFullCmps,
+			mVU.progStats.lastPrecompiles, mVU.progStats.lastPrecompileHits);
+	}
+#endif
 }
 
 // Deletes a program
 __ri void mVUdeleteProg(microVU& mVU, microProgram*& prog) {
+#ifdef mVUprofileRegAlloc
+	if (prog->regStats.spills || prog->regStats.reloads) {
+		DevCon.WriteLn("microVU%d: Prog [%03d] [PC=%04x] [Spills=%d] [Reloads=%d]", mVU.index,
+			prog->idx, prog->startPC*8, prog->regStats.spills, prog->regStats.reloads);
+	}
+#endif
 	for (u32 i = 0; i < (mVU.progSize / 2); i++) {
 		safe_delete(prog->block[i]);
 	}
@@ -199,25 +231,71 @@ __ri microProgram* mVUcreateProg(microVU& mVU, int startPC) {
 __ri void mVUcacheProg(microVU& mVU, microProgram& prog) {
 	if (!mVU.index)	memcpy(prog.data, mVU.regs().Micro, 0x1000);
 	else			memcpy(prog.data, mVU.regs().Micro, 0x4000);
+	prog.rangesHashOk = false;
 	mVUdumpProg(mVU, prog);
 }
 
+// Hashes one chunk of micro memory (FNV-1a over 32bit words, seeded by the chunk index)
+static __fi u64 mVUchunkHash(const u32* data, u32 chunk) {
+	u64 hash = 0xcbf29ce484222325ull ^ chunk;
+	for (u32 i = 0; i < mProgChunkSize / 4; i++) {
+		hash ^= data[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+// Rehashes the chunks of mVU.regs().Micro which were written to since the last search
+static __fi void mVUupdateChunkHashes(microVU& mVU) {
+	const u32* micro = (u32*)mVU.regs().Micro;
+	u32 chunks = mVU.microMemSize / mProgChunkSize;
+	for (u32 i = 0; i < chunks / 32; i++) {
+		u32 dirty = mVU.prog.chunkDirty[i];
+		if (!dirty) continue;
+		mVU.prog.chunkDirty[i] = 0;
+		for (u32 chunk = i * 32; dirty; dirty >>= 1, chunk++) {
+			if (dirty & 1) mVU.prog.chunkHash[chunk] = mVUchunkHash(&micro[chunk * (mProgChunkSize / 4)], chunk);
+		}
+	}
+}
+
 // Generate Hash for partial program based on compiled ranges...
 u64 mVUrangesHash(microVU& mVU, microProgram& prog) {
-	union {
-		u64 v64;
-		u32 v32[2];
-	} hash = {0};
-
-	std::deque<microRange>::const_iterator it(prog.ranges->begin());
-	for ( ; it != prog.ranges->end(); ++it) {
-		if((it[0].start<0)||(it[0].end<0))  { DevCon.Error("microVU%d: Negative Range![%d][%d]", mVU.index, it[0].start, it[0].end); }
-		for(int i = it[0].start/4; i < it[0].end/4; i++) {
-			hash.v32[0] -= prog.data[i];
-			hash.v32[1] ^= prog.data[i];
+	if (prog.rangesHashOk) return prog.rangesHash;
+
+	u32 chunks = mVU.microMemSize / mProgChunkSize;
+	memzero(prog.rangesChunks);
+	for (const auto& range : *prog.ranges) {
+		if ((range.start < 0) || (range.end < 0)) { DevCon.Error("microVU%d: Negative Range![%d][%d]", mVU.index, range.start, range.end); }
+		// Same bytes as mVUcmpProg() compares: [start, end + 8)
+		u32 first = std::max(range.start, 0) / mProgChunkSize;
+		u32 last  = std::min<u32>((std::max(range.end, range.start) + 7) / mProgChunkSize, chunks - 1);
+		for (u32 chunk = first; chunk <= last; chunk++) {
+			prog.rangesChunks[chunk / 32] |= 1u << (chunk % 32);
 		}
 	}
-	return hash.v64;
+
+	prog.rangesHash = 0;
+	for (u32 chunk = 0; chunk < chunks; chunk++) {
+		if (prog.rangesChunks[chunk / 32] & (1u << (chunk % 32)))
+			prog.rangesHash += mVUchunkHash(&prog.data[chunk * (mProgChunkSize / 4)], chunk);
+	}
+	prog.rangesHashOk = true;
+	return prog.rangesHash;
+}
+
+// Checks if mVU.regs().Micro can match the cached microProgram without touching the program data
+// (chunk hashes need to be current, see mVUupdateChunkHashes)
+static __fi bool mVUprobeProg(microVU& mVU, microProgram& prog) {
+	u64 progHash = mVUrangesHash(mVU, prog);
+	u64 liveHash = 0;
+	for (u32 i = 0; i < mProgChunks / 32; i++) {
+		u32 chunk = i * 32;
+		for (u32 bits = prog.rangesChunks[i]; bits; bits >>= 1, chunk++) {
+			if (bits & 1) liveHash += mVU.prog.chunkHash[chunk];
+		}
+	}
+	return liveHash == progHash;
 }
 
 // Prints the ratio of unique programs to total programs
@@ -268,9 +346,17 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 	microProgramList* list = mVU.prog.prog[mVU.regs().start_pc / 8];
 
 	if(!quick.prog) { // If null, we need to search for new program
+		mVUupdateChunkHashes(mVU);
+		mVU.progStats.lookups.fetch_add(1, std::memory_order_relaxed);
 		std::deque<microProgram*>::iterator it(list->begin());
 		for ( ; it != list->end(); ++it) {
-			bool b = mVUcmpProg(mVU, *it[0], 0);
+			// Only programs whose fingerprint matches need the (up to 16kb) compare
+			mVU.progStats.probes.fetch_add(1, std::memory_order_relaxed);
+			bool b = mVUprobeProg(mVU, *it[0]);
+			if (b) {
+				mVU.progStats.fullCmps.fetch_add(1, std::memory_order_relaxed);
+				b = mVUcmpProg(mVU, *it[0], 0);
+			}
 			if (EmuConfig.Gamefixes.ScarfaceIbit) {
 				if (isVU1 && ((((u32*)mVU.regs().Micro)[startPC / 4 + 1]) == 0x80200118) &&
 						     ((((u32*)mVU.regs().Micro)[startPC / 4 + 3]) == 0x81000062)) {
@@ -327,6 +413,63 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 	return mVUentryGet(mVU, quick.block, startPC, pState);
 }
 
+// Picks the start PCs the micro memory uploaded since the last execution will likely be run from:
+// the last start PC (games tend to reupload the program they keep calling), then the start PCs
+// earlier programs were executed from which lie in the uploaded chunks.
+static void mVUpickPrecompileCandidates(microVU& mVU) {
+	bool uploaded = false;
+	for (u32 i = 0; i < mProgChunks / 32; i++) uploaded |= !!mVU.prog.uploaded[i];
+	if (!uploaded) return;
+
+	auto add = [&](u32 pc) {
+		for (u32 i = 0; i < mVU.prog.specCount; i++) {
+			if (mVU.prog.specPC[i] == pc) return;
+		}
+		mVU.prog.specPC[mVU.prog.specCount++] = pc;
+	};
+
+	add(mVU.regs().start_pc & (mVU.microMemSize - 8));
+	for (u32 pc = 0; pc < mVU.microMemSize && mVU.prog.specCount < mVUprecompileMax; pc += 8) {
+		u32 chunk = pc / mProgChunkSize;
+		if ((mVU.prog.entryPCs[pc / 8 / 32] & (1u << (pc / 8 % 32))) &&
+		    (mVU.prog.uploaded[chunk / 32]  & (1u << (chunk % 32)))) {
+			add(pc);
+		}
+	}
+	memzero(mVU.prog.uploaded);
+}
+
+// Compiles the program for the next candidate start PC, the same way mVUexecute() would find or
+// compile it, so the execution only has to look it up (returns true while candidates remain)
+_mVUt bool mVUprecompile() {
+	microVU& mVU = mVUx;
+	if (!mVU.prog.specCount) mVUpickPrecompileCandidates(mVU);
+	if (!mVU.prog.specCount) return false;
+
+	u32 startPC = mVU.prog.specPC[--mVU.prog.specCount];
+	if (mVU.prog.quick[startPC / 8].prog) return mVU.prog.specCount != 0; // Already looked up since the upload
+
+	// Programs are listed by the start PC they're executed from
+	u32 savedStartPC = mVU.regs().start_pc;
+	mVU.regs().start_pc = startPC;
+
+	xSetPtr(mVU.prog.x86ptr);
+	mVUsearchProg<vuIndex>(startPC, (uptr)&mVU.prog.lpState);
+	if (xGetPtr() != mVU.prog.x86ptr) {
+		mVU.prog.cur->precompiled = true;
+		mVU.progStats.precompiles.fetch_add(1, std::memory_order_relaxed);
+	}
+	mVU.prog.x86ptr = x86Ptr;
+	mVU.regs().start_pc = savedStartPC;
+
+	if ((xGetPtr() < mVU.prog.x86start) || (xGetPtr() >= mVU.prog.x86end)) {
+		Console.WriteLn(vuIndex ? Color_Orange : Color_Magenta, "microVU%d: Program cache limit reached.", mVU.index);
+		mVUreset(mVU, false);
+		return false;
+	}
+	return mVU.prog.specCount != 0;
+}
+
 //------------------------------------------------------------------
 // recMicroVU0 / recMicroVU1
 //------------------------------------------------------------------
@@ -422,6 +565,11 @@ void recMicroVU1::Clear(u32 addr, u32 size) {
 	mVUclear(microVU1, addr, size);
 }
 
+bool recMicroVU1::Precompile() {
+	pxAssert(m_Reserved); // please allocate me first! :|
+	return mVUprecompile<1>();
+}
+
 uint recMicroVU0::GetCacheReserve() const {
 	return microVU0.cacheSize;
 }
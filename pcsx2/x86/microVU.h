@@ -16,6 +16,8 @@
 #pragma once
 //#define mVUlogProg // Dumps MicroPrograms to \logs\*.html
 //#define mVUprofileProg // Shows opcode statistics in console
+//#define mVUprofileProgCache // Shows program cache lookup statistics in console every frame
+//#define mVUprofileRegAlloc // Shows register spills/reloads of each microProgram when it's deleted
 
 class AsciiFile;
 using namespace x86Emitter;
@@ -23,6 +25,7 @@ using namespace x86Emitter;
 #include <deque>
 #include <algorithm>
 #include <memory>
+#include <atomic>
 #include "Common.h"
 #include "VU.h"
 #include "MTVU.h"
@@ -143,10 +146,18 @@ struct microRange {
 };
 
 #define mProgSize (0x4000/4)
+#define mProgChunkSize 64 // Bytes of micro memory covered by each fingerprint chunk
+#define mProgChunks (mProgSize*4/mProgChunkSize)
+#define mVUprecompileMax 4 // Start PCs compiled ahead of execution per upload
 struct microProgram {
 	u32				   data [mProgSize];   // Holds a copy of the VU microProgram
 	microBlockManager* block[mProgSize/2]; // Array of Block Managers
 	std::deque<microRange>* ranges;			   // The ranges of the microProgram that have already been recompiled
+	u32 rangesChunks[mProgChunks/32]; // Bitmask of the chunks of data[] covered by ranges
+	u64 rangesHash;   // Fingerprint of data[] over rangesChunks
+	bool rangesHashOk; // rangesChunks/rangesHash are up to date with ranges and data[]
+	bool precompiled;  // Compiled by mVUprecompile() and not executed yet
+	microRegStats regStats; // Register spills/reloads of the compiled blocks
 	u32 startPC; // Start PC of this program
 	int idx;	 // Program index
 };
@@ -171,6 +182,26 @@ struct microProgManager {
 	u8*					x86start;			// Start of program's rec-cache
 	u8*					x86end;				// Limit of program's rec-cache
 	microRegInfo		lpState;			// Pipeline state from where program left off (useful for continuing execution)
+	u64					chunkHash [mProgChunks];	// Hash of each chunk of mVU.regs().Micro
+	u32					chunkDirty[mProgChunks/32];	// Chunks written to since their hash was last computed
+	u32					entryPCs  [mProgSize/2/32];	// Start PCs programs have been executed from
+	u32					uploaded  [mProgChunks/32];	// Chunks written to since the last execution
+	u32					specPC    [mVUprecompileMax];	// Start PCs left to precompile for the uploaded chunks
+	u32					specCount;
+};
+
+// Program cache lookup counters (VU1 lookups run on the MTVU thread, vsync reads them from the EE thread)
+struct microProgStats {
+	std::atomic<u32> lookups;	// Program searches which had to walk the program list
+	std::atomic<u32> probes;	// Cached programs whose fingerprint was checked
+	std::atomic<u32> fullCmps;	// Fingerprint matches which needed a confirming memory compare
+	std::atomic<u32> precompiles;		// Programs compiled ahead of execution by mVUprecompile()
+	std::atomic<u32> precompileHits;	// First executions which found their entry already compiled
+	u32 lastLookups;			// Totals of the previous frame
+	u32 lastProbes;
+	u32 lastFullCmps;
+	u32 lastPrecompiles;
+	u32 lastPrecompileHits;
 };
 
 static const uint mVUdispCacheSize	= __pagesize; // Dispatcher Cache Size (in bytes)
@@ -184,7 +215,7 @@ struct microVU {
 	__aligned16 u32 macFlag [4]; // 4 instances of mac    flag (used in execution)
 	__aligned16 u32 clipFlag[4]; // 4 instances of clip   flag (used in execution)
 	__aligned16 u32 xmmCTemp[4];	 // Backup used in mVUclamp2()
-	__aligned16 u32 xmmBackup[8][4]; // Backup for xmm0~xmm7
+	__aligned16 u32 xmmBackup[iREGCNT_XMM][4]; // Backup for xmm0~xmm7 (xmm0~xmm15 on x86-64)
 
 	u32 index;			// VU Index (VU0 or VU1)
 	u32 cop2;			// VU is in COP2 mode?  (No/Yes)
@@ -195,6 +226,7 @@ struct microVU {
 	u32 cacheSize;		// VU Cache Size
 
 	microProgManager				prog;		// Micro Program Data
+	microProgStats					progStats;	// Micro Program Cache Counters
 	microProfiler					profiler;   // Opcode Profiler
 	std::unique_ptr<microRegAlloc>	regAlloc;	// Reg Alloc Class
 	std::unique_ptr<AsciiFile>		logFile;	// Log File Pointer
@@ -17,7 +17,7 @@
 
 extern bool  doEarlyExit (microVU& mVU);
 extern void  mVUincCycles(microVU& mVU, int x);
-extern void* mVUcompile  (microVU& mVU, u32 startPC, uptr pState);
+extern void* mVUcompile  (microVU& mVU, u32 startPC, uptr pState, const microRegCarry* carry = NULL, bool fallThrough = false);
 extern void* mVUcompileSingleInstruction(microVU& mVU, u32 startPC, uptr pState, microFlagCycles& mFC);
 __fi int getLastFlagInst(microRegInfo& pState, int* xFlag, int flagType, int isEbit) {
 	if (isEbit) return findFlagInst(xFlag, 0x7fffffff);
@@ -230,19 +230,40 @@ void mVUendProgram(mV, microFlagCycles* mFC, int isEbit) {
 // Recompiles Code for Proper Flags and Q/P regs on Block Linkings
 void mVUsetupBranch(mV, microFlagCycles& mFC) {
 	
-	mVU.regAlloc->flushAll();	// Flush Allocated Regs
+	mVU.regAlloc->flushBranch(); // Flush Allocated Regs (keeps the carried regs cached)
 	mVUsetupFlags(mVU, mFC);	// Shuffle Flag Instances
 
 	// Shuffle P/Q regs since every block starts at instance #0
 	if (mVU.p || mVU.q) { xPSHUF.D(xmmPQ, xmmPQ, shufflePQ); }
 }
 
+// Returns the entry point of pBlock for a branch which holds the 'carry' regs
+__fi u8* mVUblockEntry(const microBlock* pBlock, const microRegCarry& carry) {
+	for (uint i = 0; i < iREGCNT_XMM; i++) {
+		if ((pBlock->carry.VFreg[i] >= 0) && (pBlock->carry.VFreg[i] != carry.VFreg[i]))
+			return pBlock->x86ptrStart;
+	}
+	return pBlock->x86ptrWarm;
+}
+
+// Search for Existing Compiled Block for a branch which holds the 'carry' regs
+// (if found, return x86ptr; else, compile and return x86ptr)
+__fi void* mVUbranchFetch(microVU& mVU, u32 startPC, uptr pState, const microRegCarry& carry) {
+	startPC &= mVU.microMemSize-8;
+	blockCreate(startPC/8);
+	microBlock* pBlock = mVUblocks[startPC/8]->search((microRegInfo*)pState);
+	if (pBlock) return mVUblockEntry(pBlock, carry);
+	else		return mVUcompile(mVU, startPC, pState, &carry);
+}
+
 void normBranchCompile(microVU& mVU, u32 branchPC) {
 	microBlock* pBlock;
+	microRegCarry carry;
+	mVU.regAlloc->getCarry(carry);
 	blockCreate(branchPC/8);
 	pBlock = mVUblocks[branchPC/8]->search((microRegInfo*)&mVUregs);
-	if (pBlock)	{ xJMP(pBlock->x86ptrStart); }
-	else		{ mVUcompile(mVU, branchPC, (uptr)&mVUregs); }
+	if (pBlock)	{ xJMP(mVUblockEntry(pBlock, carry)); }
+	else		{ mVUcompile(mVU, branchPC, (uptr)&mVUregs, &carry, true); }
 }
 
 void normJumpCompile(mV, microFlagCycles& mFC, bool isEvilJump) {
@@ -488,12 +509,14 @@ void condBranch(mV, microFlagCycles& mFC, int JMPcc) {
 			}
 		}
 		microBlock* bBlock;
+		microRegCarry carry; // mVUcompile resets regAlloc, so keep the regs held by both sides
+		mVU.regAlloc->getCarry(carry);
 		incPC2(1); // Check if Branch Non-Taken Side has already been recompiled
 		blockCreate(iPC/2);
 		bBlock = mVUblocks[iPC/2]->search((microRegInfo*)&mVUregs);
 		incPC2(-1);
 		if (bBlock)	{ // Branch non-taken has already been compiled
-			xJcc(xInvertCond((JccComparisonType)JMPcc), bBlock->x86ptrStart);
+			xJcc(xInvertCond((JccComparisonType)JMPcc), mVUblockEntry(bBlock, carry));
 			incPC(-3); // Go back to branch opcode (to get branch imm addr)
 			normBranchCompile(mVU, branchAddr(mVU));
 		}
@@ -504,11 +527,11 @@ void condBranch(mV, microFlagCycles& mFC, int JMPcc) {
 			memcpy(&pBlock->pStateEnd, &mVUregs, sizeof(microRegInfo));
 
 			incPC2(1);  // Get PC for branch not-taken
-			mVUcompile(mVU, xPC, (uptr)&mVUregs);
+			mVUcompile(mVU, xPC, (uptr)&mVUregs, &carry, true);
 
 			iPC = bPC;
 			incPC(-3); // Go back to branch opcode (to get branch imm addr)
-			uptr jumpAddr = (uptr)mVUblockFetch(mVU, branchAddr(mVU), (uptr)&pBlock->pStateEnd);
+			uptr jumpAddr = (uptr)mVUbranchFetch(mVU, branchAddr(mVU), (uptr)&pBlock->pStateEnd, carry);
 			*ajmp = (jumpAddr - ((uptr)ajmp + 4));
 		}
 	}
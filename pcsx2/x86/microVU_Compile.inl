@@ -61,6 +61,7 @@ void mVUsetupRange(microVU& mVU, s32 pc, bool isStartPC) {
 	}
 
 	mVUcheckIsSame(mVU);
+	mVUcurProg.rangesHashOk = false;
 
 	if (isStartPC) {
 		microRange mRange = {pc, -1};
@@ -439,6 +440,8 @@ __fi void mVUinitFirstPass(microVU& mVU, uptr pState, u8* thisPtr) {
 		memcpy((u8*)&mVU.prog.lpState, (u8*)pState, sizeof(microRegInfo));
 	}
 	mVUblock.x86ptrStart	= thisPtr;
+	mVUblock.x86ptrWarm		= thisPtr;
+	memset(&mVUblock.carry, 0xff, sizeof(mVUblock.carry));
 	mVUpBlock				= mVUblocks[mVUstartPC/2]->add(&mVUblock); // Add this block to block manager
 	mVUregs.needExactMatch	= (mVUpBlock->pState.blockType)?7:0; // ToDo: Fix 1-Op block flag linking (MGS2:Demo/Sly Cooper)
 	mVUregs.blockType		= 0;
@@ -539,7 +542,45 @@ void mVUSaveFlags(microVU& mVU,microFlagCycles &mFC, microFlagCycles &mFCBackup)
 	memcpy(&mFCBackup, &mFC, sizeof(microFlagCycles));
 	mVUsetFlags(mVU, mFCBackup);	   // Sets Up Flag instances
 }
-void* mVUcompile(microVU& mVU, u32 startPC, uptr pState)
+// Keeps the carried regs which the block reads, and emits the loads for its cold entry point.
+// Returns the warm entry point (branches which hold the regs skip the loads).
+u8* mVUsetupCarry(microVU& mVU, const microRegCarry* carry, bool fallThrough) {
+	microRegCarry& blockCarry = mVUpBlock->carry;
+	u64 reads = 0;
+	u32 pc = mVUstartPC;
+	for (u32 i = 0; i < mVUcount; i++, pc = (pc + 2) & mVU.progMemMask) {
+		const microOp& op = mVU.prog.IRinfo.info[pc / 2];
+		const microVFreg* vf[4] = { &op.uOp.VF_read[0], &op.uOp.VF_read[1], &op.lOp.VF_read[0], &op.lOp.VF_read[1] };
+		for (int j = 0; j < 4; j++) {
+			if (vf[j]->x || vf[j]->y || vf[j]->z || vf[j]->w) reads |= 1ull << vf[j]->reg;
+		}
+	}
+
+	int count = 0;
+	for (uint i = 0; i < iREGCNT_XMM; i++) {
+		s8 reg = carry ? carry->VFreg[i] : -1;
+		blockCarry.VFreg[i] = ((reg >= 0) && (reads & (1ull << reg))) ? reg : -1;
+		if (blockCarry.VFreg[i] >= 0) count++;
+	}
+	if (!count) return mVUpBlock->x86ptrStart;
+
+	// Code falling through from the branch already holds the regs
+	if (fallThrough) {
+		xForwardJump8 warm;
+		mVUpBlock->x86ptrStart = x86Ptr;
+		mVU.regAlloc->loadCarry(blockCarry);
+		warm.SetTarget();
+	}
+	else mVU.regAlloc->loadCarry(blockCarry);
+
+	mVUpBlock->x86ptrWarm = x86Ptr;
+	return x86Ptr;
+}
+
+// carry		= VF regs cached in xmm regs by the branch to this block (NULL if unknown)
+// fallThrough	= The block is compiled right after the branch, which doesn't jump to it
+// Returns the entry point of the block, the warm one when carry is given.
+void* mVUcompile(microVU& mVU, u32 startPC, uptr pState, const microRegCarry* carry, bool fallThrough)
 {
 	microFlagCycles mFC;
 	u8* thisPtr = x86Ptr;
@@ -549,6 +590,7 @@ void* mVUcompile(microVU& mVU, u32 startPC, uptr pState)
 	iPC = startPC / 4;
 	mVUsetupRange(mVU, startPC, 1); // Setup Program Bounds/Range
 	mVU.regAlloc->reset();          // Reset regAlloc
+	mVU.regAlloc->setIR(mVU.prog.IRinfo.info, &iPC, mVU.progMemMask, &mVU.prog.cur->regStats);
 	mVUinitFirstPass(mVU, pState, thisPtr);
 	mVUbranch = 0;
 	for (int branch = 0; mVUcount < endCount;) {
@@ -640,6 +682,7 @@ void* mVUcompile(microVU& mVU, u32 startPC, uptr pState)
 
 	mVUsetFlags(mVU, mFC);           // Sets Up Flag instances
 	mVUoptimizePipeState(mVU);       // Optimize the End Pipeline State for nicer Block Linking
+	u8* entryPtr = mVUsetupCarry(mVU, carry, fallThrough); // Cold/Warm entry points
 	mVUdebugPrintBlocks(mVU, false); // Prints Start/End PC of blocks executed, for debugging...
 	mVUtestCycles(mVU, mFC);              // Update VU Cycles and Exit Early if Necessary
 
@@ -751,7 +794,7 @@ perf_and_return:
 
 	Perf::vu.map((uptr)thisPtr, x86Ptr - thisPtr, startPC);
 
-	return thisPtr;
+	return carry ? entryPtr : thisPtr;
 }
 
 // Returns the entry point of the block (compiles it if not found)
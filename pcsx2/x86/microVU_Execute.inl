@@ -141,8 +141,21 @@ _mVUt void* __fastcall mVUexecute(u32 startPC, u32 cycles) {
 	mVU.cycles		= cycles;
 	mVU.totalCycles = cycles;
 
+	// Remember the start PC for mVUprecompile(), the uploads before this execution are handled
+	u32 entry = (startPC & vuLimit) / 8;
+	mVU.prog.entryPCs[entry / 32] |= 1u << (entry % 32);
+	memzero(mVU.prog.uploaded);
+	mVU.prog.specCount = 0;
+
 	xSetPtr(mVU.prog.x86ptr); // Set x86ptr to where last program left off
-	return mVUsearchProg<vuIndex>(startPC & vuLimit, (uptr)&mVU.prog.lpState); // Find and set correct program
+	void* entryPoint = mVUsearchProg<vuIndex>(startPC & vuLimit, (uptr)&mVU.prog.lpState); // Find and set correct program
+
+	if (mVU.prog.cur->precompiled) { // First execution of a precompiled program
+		mVU.prog.cur->precompiled = false;
+		if (xGetPtr() == mVU.prog.x86ptr)
+			mVU.progStats.precompileHits.fetch_add(1, std::memory_order_relaxed);
+	}
+	return entryPoint;
 }
 
 //------------------------------------------------------------------
@@ -72,11 +72,19 @@ struct microJumpCache {
 	void* x86ptrStart;	// Start of code (Entry point for block)
 };
 
+// VF regs kept cached in xmm registers across a branch (-1 = none), indexed by xmm register.
+// Only xmm8 and up are carried, xmm0~xmm6 are used as temps between the flush and the jump.
+struct microRegCarry {
+	s8 VFreg[iREGCNT_XMM];
+};
+
 struct __aligned16 microBlock {
 	microRegInfo	pState;		 // Detailed State of Pipeline
 	microRegInfo	pStateEnd;	 // Detailed State of Pipeline at End of Block (needed by JR/JALR opcodes)
 	u8*				x86ptrStart; // Start of code (Entry point for block)
+	u8*				x86ptrWarm;	 // Entry point for branches which already hold the 'carry' regs
 	microJumpCache* jumpCache;	 // Will point to an array of entry points of size [16k/8] if block ends in JR/JALR
+	microRegCarry	carry;		 // Cached VF regs expected by x86ptrWarm
 };
 
 struct microTempRegInfo {
@@ -198,12 +206,25 @@ struct microMapXMM {
 	bool isNeeded;	// Is needed for current instruction
 };
 
+// Register pressure of a microProgram, counted when its blocks are compiled
+struct microRegStats {
+	u32 spills;		// Modified VF regs written back to make room for another reg
+	u32 reloads;	// VF regs loaded again after being evicted within the same block
+};
+
 class microRegAlloc {
 protected:
-	static const int   xmmTotal = 7; // Don't allocate PQ?
+	static const int   xmmTotal = iREGCNT_XMM; // xmmPQ is skipped
+	static const int   nextUseMax = 64; // Instructions looked ahead when picking a reg to evict
 	microMapXMM	xmmMap[xmmTotal];
 	int			counter; // Current allocation count
 	int			index;   // VU0 or VU1
+	u64			evicted; // VF regs (and ACC/I) evicted since the last flush, for counting reloads
+
+	const microOp*	irInfo;	// First pass info of the block being compiled (NULL = unknown, COP2 macro ops)
+	const u32*		irPC;	// Current PC of the block being compiled
+	u32				irMask;	// Mask for irInfo indices
+	microRegStats*	stats;	// Counters of the program being compiled (can be NULL)
 
 	// Helper functions to get VU regs
 	VURegs& regs()				 const	{ return ::vuRegs[index]; }
@@ -214,32 +235,71 @@ protected:
 		xMOVSSZX(reg, ptr32[&getVI(REG_I)]);
 		if (!_XYZWss(xyzw)) xSHUF.PS(reg, reg, 0);
 	}
-	
-	int findFreeRegRec(int startIdx) {
-		for(int i = startIdx; i < xmmTotal; i++) {
-			if (!xmmMap[i].isNeeded) {
-				int x = findFreeRegRec(i+1);
-				if (x == -1) return i;
-				return ((xmmMap[i].count < xmmMap[x].count) ? i : x);
+
+	static bool readsVF(const microVFreg& vf, int VFreg) {
+		return (vf.reg == VFreg) && (vf.x || vf.y || vf.z || vf.w);
+	}
+	static bool killsVF(const microVFreg& vf, int VFreg) {
+		return (vf.reg == VFreg) && vf.x && vf.y && vf.z && vf.w;
+	}
+
+	// Instructions until VFreg is read again by the current block (0 = current instruction).
+	// Returns nextUseMax+1 if it isn't read again in the block (or the lookahead), and
+	// nextUseMax+2 if it's fully overwritten before being read.
+	int nextUse(int VFreg) const {
+		if (!irInfo || (VFreg < 0) || (VFreg >= 32)) return 0; // ACC/I aren't tracked by the first pass
+		u32 i = *irPC / 2;
+		for (int dist = 0; dist <= nextUseMax; dist++, i = (i + 1) & irMask) {
+			const microOp& op = irInfo[i];
+			if (readsVF(op.uOp.VF_read[0], VFreg) || readsVF(op.uOp.VF_read[1], VFreg)
+			||  readsVF(op.lOp.VF_read[0], VFreg) || readsVF(op.lOp.VF_read[1], VFreg))
+				return dist;
+			if (killsVF(op.uOp.VF_write, VFreg) || killsVF(op.lOp.VF_write, VFreg))
+				return nextUseMax + 2;
+			if (op.isEOB) break;
+		}
+		return nextUseMax + 1;
+	}
+
+	// Picks the reg whose VF reg is needed the latest, then the least recently used one
+	int findEvictReg() {
+		int x = -1, xUse = 0;
+		for(int i = xmmTotal - 1; i >= 0; i--) {
+			if ((i == xmmPQ.Id) || xmmMap[i].isNeeded) continue;
+			int use = nextUse(xmmMap[i].VFreg);
+			if ((x < 0) || (use > xUse) || ((use == xUse) && (xmmMap[i].count < xmmMap[x].count))) {
+				x = i; xUse = use;
 			}
 		}
-		return -1;
+		return x;
 	}
 
 	int findFreeReg() {
-		for(int i = 0; i < xmmTotal; i++) {
-			if (!xmmMap[i].isNeeded && (xmmMap[i].VFreg < 0)) {
+		// Top down, so cached regs tend to end up in the regs carried across branches
+		for(int i = xmmTotal - 1; i >= 0; i--) {
+			if ((i != xmmPQ.Id) && !xmmMap[i].isNeeded && (xmmMap[i].VFreg < 0)) {
 				return i; // Reg is not needed and was a temp reg
 			}
 		}
-		int x = findFreeRegRec(0);
+		int x = findEvictReg();
 		pxAssertDev( x >= 0, "microVU register allocation failure!" );
+		const microMapXMM& mapX = xmmMap[x];
+		if (stats && (mapX.VFreg > 0) && mapX.xyzw) stats->spills++;
+		if (mapX.VFreg >= 0) evicted |= 1ull << mapX.VFreg;
 		return x;
 	}
 
+	// Counts loads of VF regs which were evicted earlier
+	void countLoad(int vfLoadReg) {
+		if ((vfLoadReg < 0) || !(evicted & (1ull << vfLoadReg))) return;
+		evicted &= ~(1ull << vfLoadReg);
+		if (stats) stats->reloads++;
+	}
+
 public:
 	microRegAlloc(int _index) {
 		index = _index;
+		setIR(NULL, NULL, 0, NULL);
 		reset();
 	}
 
@@ -249,6 +309,16 @@ public:
 			clearReg(i);
 		}
 		counter = 0;
+		evicted = 0;
+	}
+
+	// Sets the first pass info used to pick regs to evict, and where to count spills/reloads.
+	// info = NULL falls back to evicting the least recently used reg.
+	void setIR(const microOp* info, const u32* curPC, u32 progMemMask, microRegStats* progStats) {
+		irInfo = info;
+		irPC   = curPC;
+		irMask = progMemMask / 2;
+		stats  = progStats;
 	}
 
 	// Flushes all allocated registers (i.e. writes-back to memory all modified registers).
@@ -256,14 +326,60 @@ public:
 	// If clearState is 1, then it invalidates all cached reg data after write-back
 	void flushAll(bool clearState = true) {
 		for(int i = 0; i < xmmTotal; i++) {
+			if (i == xmmPQ.Id) continue;
 			writeBackReg(xmm(i));
 			if (clearState)
 				clearReg(i);
 		}
+		if (clearState)
+			evicted = 0;
+	}
+
+	// Flushes all allocated registers before a branch, keeping the VF regs cached in
+	// xmm8 and up valid so the branch target can use them without reloading.
+	void flushBranch() {
+		flushAll(false);
+		for(int i = 0; i < xmmTotal; i++) {
+			if (i == xmmPQ.Id) continue;
+			const microMapXMM& mapI = xmmMap[i];
+			if ((i < 8) || (mapI.VFreg < 0) || (mapI.VFreg >= 32) || mapI.xyzw)
+				clearReg(i);
+			else
+				xmmMap[i].isNeeded = false;
+		}
+		evicted = 0;
+	}
+
+	// VF regs which are cached after flushBranch()
+	void getCarry(microRegCarry& carry) const {
+		for(int i = 0; i < xmmTotal; i++) {
+			const microMapXMM& mapI = xmmMap[i];
+			carry.VFreg[i] = ((i >= 8) && (mapI.VFreg >= 0) && (mapI.VFreg < 32) && !mapI.xyzw) ? mapI.VFreg : -1;
+		}
+	}
+
+	// Loads the carried VF regs from memory (entry point for blocks coming from the dispatcher
+	// or from branches that don't hold them), and marks them as cached for the block.
+	void loadCarry(const microRegCarry& carry) {
+		for(int i = 0; i < xmmTotal; i++) {
+			if (carry.VFreg[i] < 0) continue;
+			xMOVAPS(xmm(i), ptr128[&getVF(carry.VFreg[i])]);
+		}
+		setCarry(carry);
+	}
+
+	void setCarry(const microRegCarry& carry) {
+		for(int i = 0; i < xmmTotal; i++) {
+			if (carry.VFreg[i] < 0) continue;
+			clearReg(i);
+			xmmMap[i].VFreg = carry.VFreg[i];
+			xmmMap[i].count = counter;
+		}
 	}
 
 	void TDwritebackAll(bool clearState = false) {
 		for(int i = 0; i < xmmTotal; i++) {
+			if (i == xmmPQ.Id) continue;
 			microMapXMM& mapX = xmmMap[xmm(i).Id];
 
 			if ((mapX.VFreg > 0) && mapX.xyzw) { // Reg was modified and not Temp or vf0
@@ -339,7 +455,7 @@ public:
 	// writes into them.
 	void clearNeeded(const xmm& reg) {
 
-		if ((reg.Id < 0) || (reg.Id >= xmmTotal)) return; // Sometimes xmmPQ hits this
+		if ((reg.Id < 0) || (reg.Id >= xmmTotal) || (reg.Id == xmmPQ.Id)) return; // Sometimes xmmPQ hits this
 
 		microMapXMM& clear = xmmMap[reg.Id];
 		clear.isNeeded = false;
@@ -431,6 +547,7 @@ public:
 		int x = findFreeReg();
 		const xmm&   xmmX = xmm::GetInstance(x);
 		writeBackReg(xmmX);
+		countLoad(vfLoadReg);
 
 		if (vfWriteReg >= 0) { // Reg Will Be Modified (allow partial reg loading)
 			if ((vfLoadReg == 0) && !(xyzw & 1))
@@ -37,6 +37,7 @@ void setupMacroOp(int mode, const char* opName) {
 	memset(&microVU0.prog.IRinfo.info[0], 0, sizeof(microVU0.prog.IRinfo.info[0]));
 	iFlushCall(FLUSH_EVERYTHING);
 	microVU0.regAlloc->reset();
+	microVU0.regAlloc->setIR(NULL, NULL, 0, NULL); // No first pass info for macro ops
 	if (mode & 0x01) { // Q-Reg will be Read
 		xMOVSSZX(xmmPQ, ptr32[&vu0Regs.VI[REG_Q].UL]);
 	}
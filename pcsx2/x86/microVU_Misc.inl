@@ -213,10 +213,11 @@ void mVUmergeRegs(const xmm& dest, const xmm& src, int xyzw, bool modXYZW)
 // Micro VU - Misc Functions
 //------------------------------------------------------------------
 
-// Backup Volatile Regs (EAX, ECX, EDX, MM0~7, XMM0~7, are all volatile according to 32bit Win/Linux ABI)
+// Backup Volatile Regs (EAX, ECX, EDX, MM0~7, XMM0~7, are all volatile according to 32bit Win/Linux ABI,
+// and XMM8~15 on x86-64 Linux, which regAlloc uses as well)
 __fi void mVUbackupRegs(microVU& mVU, bool toMemory = false) {
 	if (toMemory) {
-		for(int i = 0; i < 8; i++) {
+		for(uint i = 0; i < iREGCNT_XMM; i++) {
 			xMOVAPS(ptr128[&mVU.xmmBackup[i][0]], xmm(i));
 		}
 	}
@@ -229,7 +230,7 @@ __fi void mVUbackupRegs(microVU& mVU, bool toMemory = false) {
 // Restore Volatile Regs
 __fi void mVUrestoreRegs(microVU& mVU, bool fromMemory = false) {
 	if (fromMemory) {
-		for(int i = 0; i < 8; i++) {
+		for(uint i = 0; i < iREGCNT_XMM; i++) {
 			xMOVAPS(xmm(i), ptr128[&mVU.xmmBackup[i][0]]);
 		}
 	}
@@ -250,12 +251,12 @@ public:
 
 _mVUt void __fc mVUprintRegs() {
 	microVU& mVU = mVUx;
-	for(int i = 0; i < 8; i++) {
+	for(uint i = 0; i < iREGCNT_XMM; i++) {
 		Console.WriteLn("xmm%d = [0x%08x,0x%08x,0x%08x,0x%08x]", i,
 			mVU.xmmBackup[i][0], mVU.xmmBackup[i][1],
 			mVU.xmmBackup[i][2], mVU.xmmBackup[i][3]);
 	}
-	for(int i = 0; i < 8; i++) {
+	for(uint i = 0; i < iREGCNT_XMM; i++) {
 		Console.WriteLn("xmm%d = [%f,%f,%f,%f]", i,
 			(float&)mVU.xmmBackup[i][0], (float&)mVU.xmmBackup[i][1],
 			(float&)mVU.xmmBackup[i][2], (float&)mVU.xmmBackup[i][3]);
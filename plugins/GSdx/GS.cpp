@@ -23,6 +23,7 @@
 #include "GSdx.h"
 #include "GSUtil.h"
 #include "Renderers/SW/GSRendererSW.h"
+#include "Renderers/SW/GSDeviceSW.h"
 #include "Renderers/Null/GSRendererNull.h"
 #include "Renderers/Null/GSDeviceNull.h"
 #include "Renderers/OpenGL/GSDeviceOGL.h"
@@ -254,6 +255,10 @@ static int _GSopen(void** dsp, const char* title, GSRendererType renderer, int t
 			dev = new GSDeviceOGL();
 			renderer_name = "Software";
 			break;
+		case GSRendererType::SW:
+			dev = new GSDeviceSW();
+			renderer_name = "Software (CPU)";
+			break;
 		case GSRendererType::Null:
 			dev = new GSDeviceNull();
 			renderer_name = "Null";
@@ -282,6 +287,7 @@ static int _GSopen(void** dsp, const char* title, GSRendererType renderer, int t
 				s_gs = (GSRenderer*)new GSRendererOGL();
 				break;
 			case GSRendererType::OGL_SW:
+			case GSRendererType::SW:
 				s_gs = new GSRendererSW(threads);
 				break;
 			case GSRendererType::Null:
@@ -353,8 +359,16 @@ EXPORT_C_(int) GSopen2(void** dsp, uint32 flags)
 			log_cb(RETRO_LOG_INFO, "Selected Renderer: DX1011_HW\n" );
 			break;
 		case RETRO_HW_CONTEXT_NONE:
-			theApp.SetCurrentRendererType(GSRendererType::Null);
-			log_cb(RETRO_LOG_INFO, "Selected Renderer: NULL\n");
+			if (! std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "CPU"))
+			{
+				theApp.SetCurrentRendererType(GSRendererType::SW);
+				log_cb(RETRO_LOG_INFO, "Selected Renderer: SW\n");
+			}
+			else
+			{
+				theApp.SetCurrentRendererType(GSRendererType::Null);
+				log_cb(RETRO_LOG_INFO, "Selected Renderer: NULL\n");
+			}
 			break;
 		default:
 			if (! std::strcmp(option_value(STRING_PCSX2_OPT_RENDERER, KeyOptionString::return_type), "Software"))
@@ -401,6 +415,9 @@ EXPORT_C_(int) GSopen2(void** dsp, uint32 flags)
 			case GSRendererType::OGL_HW:
 				current_renderer = GSRendererType::OGL_SW;
 				break;
+			case GSRendererType::SW:
+				// no gpu context to switch to
+				break;
 			default:
 				current_renderer = GSRendererType::OGL_SW;
 				break;
@@ -453,6 +470,11 @@ GSVector2i GSgetInternalResolution()
 	return s_gs->GetInternalResolution();
 }
 
+GSRenderer::PresentStats GSgetPresentStats()
+{
+	return s_gs->GetPresentStats();
+}
+
 EXPORT_C GSreset()
 {
 	try
@@ -0,0 +1,254 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "GSGIFPackedCodeGenerator.h"
+
+using namespace Xbyak;
+
+GSGIFPackedCodeGenerator::GSGIFPackedCodeGenerator(void* param, uint64 key, void* code, size_t maxsize)
+	: GSCodeGenerator(code, maxsize)
+	, m_ctx(*(GSGIFPackedContext*)param)
+{
+	m_sel.key = key;
+
+	try {
+		Generate();
+	} catch (std::exception& e) {
+		fprintf(stderr, "ERR:GSGIFPackedCodeGenerator %s\n", e.what());
+	}
+}
+
+bool GSGIFPackedCodeGenerator::IsSupported(uint32 reg)
+{
+	switch(reg)
+	{
+	case GIF_REG_RGBA:
+	case GIF_REG_STQ:
+	case GIF_REG_UV:
+	case GIF_REG_XYZF2:
+	case GIF_REG_XYZ2:
+	case GIF_REG_FOG:
+	case GIF_REG_INVALID:
+	case GIF_REG_XYZF3:
+	case GIF_REG_XYZ3:
+	case GIF_REG_NOP:
+		return true;
+	default:
+		return false;
+	}
+}
+
+#if defined(_M_AMD64) || defined(_WIN64)
+
+// rbx: current register, r12: loops left, r13: GSState::m_v
+// rbx, r12 and r13 are callee saved in both ABIs, so they survive the vertex kicks.
+
+void GSGIFPackedCodeGenerator::Generate()
+{
+	push(rbx);
+	push(r12);
+	push(r13);
+	sub(rsp, 32); // win64 shadow space, also keeps rsp 16-byte aligned for the kicks
+
+	mov(rbx, a0);
+	mov(r12d, a1.cvt32());
+	mov(r13, (size_t)m_ctx.v);
+
+	L("loop");
+
+	for(uint32 i = 0; i < m_sel.nreg; i++)
+	{
+		int offset = i * sizeof(GIFPackedReg);
+
+		switch((m_sel.regs >> (i * 4)) & 0xf)
+		{
+		case GIF_REG_RGBA: RGBA(offset); break;
+		case GIF_REG_STQ: STQ(offset); break;
+		case GIF_REG_UV: UV(offset); break;
+		case GIF_REG_XYZF2: XYZF(offset, false); break;
+		case GIF_REG_XYZ2: XYZ(offset, false); break;
+		case GIF_REG_FOG: FOG(offset); break;
+		case GIF_REG_XYZF3: XYZF(offset, true); break;
+		case GIF_REG_XYZ3: XYZ(offset, true); break;
+		default: break; // NOP, INVALID
+		}
+	}
+
+	add(rbx, m_sel.nreg * sizeof(GIFPackedReg));
+	dec(r12d);
+	jnz("loop", T_NEAR);
+
+	add(rsp, 32);
+	pop(r13);
+	pop(r12);
+	pop(rbx);
+
+	ret();
+}
+
+void GSGIFPackedCodeGenerator::RGBA(int offset)
+{
+	// see GSState::GIFPackedRegHandlerRGBA
+
+	movdqu(xmm0, ptr[rbx + offset]);
+	pcmpeqd(xmm1, xmm1);
+	psrld(xmm1, 24);
+	pand(xmm0, xmm1);
+	packssdw(xmm0, xmm0);
+	packuswb(xmm0, xmm0);
+	movd(ptr[r13 + offsetof(GSVertex, RGBAQ)], xmm0);
+
+	mov(eax, ptr[r13 + (int)((uint8*)m_ctx.q - (uint8*)m_ctx.v)]);
+	mov(ptr[r13 + offsetof(GSVertex, RGBAQ) + 4], eax);
+}
+
+void GSGIFPackedCodeGenerator::STQ(int offset)
+{
+	// see GSState::GIFPackedRegHandlerSTQ, q = 0 becomes 1.0f and nan becomes FLT_MAX
+
+	mov(rax, ptr[rbx + offset]);
+	mov(ptr[r13 + offsetof(GSVertex, ST)], rax);
+
+	Label not_zero, store;
+
+	mov(eax, ptr[rbx + offset + 8]);
+	test(eax, eax);
+	jnz(not_zero);
+	mov(eax, 0x3f800000);
+	jmp(store);
+
+	L(not_zero);
+	mov(ecx, eax);
+	and(ecx, 0x7fffffff);
+	cmp(ecx, 0x7f800000);
+	jbe(store);
+	mov(eax, 0x7f7fffff);
+
+	L(store);
+	mov(ptr[r13 + (int)((uint8*)m_ctx.q - (uint8*)m_ctx.v)], eax);
+}
+
+void GSGIFPackedCodeGenerator::UV(int offset)
+{
+	// see GSState::GIFPackedRegHandlerUV
+
+	movq(xmm0, ptr[rbx + offset]);
+	pcmpeqd(xmm1, xmm1);
+	psrld(xmm1, 18);
+	pand(xmm0, xmm1);
+	packssdw(xmm0, xmm0);
+	movd(ptr[r13 + offsetof(GSVertex, UV)], xmm0);
+
+	if(m_sel.uv_hack)
+	{
+		mov(rax, (size_t)m_ctx.uv_hack_flag);
+		mov(byte[rax], 1);
+	}
+}
+
+void GSGIFPackedCodeGenerator::XYZF(int offset, bool adc)
+{
+	// see GSState::GIFPackedRegHandlerXYZF2, UV is already in place
+
+	movzx(eax, word[rbx + offset]);
+	movzx(ecx, word[rbx + offset + 4]);
+	shl(ecx, 16);
+	or(eax, ecx);
+	mov(ptr[r13 + offsetof(GSVertex, XYZ)], eax);
+
+	mov(eax, ptr[rbx + offset + 8]);
+	shr(eax, 4);
+	and(eax, 0x00ffffff);
+	mov(ptr[r13 + offsetof(GSVertex, XYZ) + 4], eax);
+
+	mov(eax, ptr[rbx + offset + 12]);
+	mov(ecx, eax);
+	shr(ecx, 4);
+	movzx(ecx, cl);
+	mov(ptr[r13 + offsetof(GSVertex, FOG)], ecx);
+
+	Kick(adc);
+}
+
+void GSGIFPackedCodeGenerator::XYZ(int offset, bool adc)
+{
+	// see GSState::GIFPackedRegHandlerXYZ2, UV and FOG are kept
+
+	movzx(eax, word[rbx + offset]);
+	movzx(ecx, word[rbx + offset + 4]);
+	shl(ecx, 16);
+	or(eax, ecx);
+	mov(ptr[r13 + offsetof(GSVertex, XYZ)], eax);
+
+	mov(eax, ptr[rbx + offset + 8]);
+	mov(ptr[r13 + offsetof(GSVertex, XYZ) + 4], eax);
+
+	mov(eax, ptr[rbx + offset + 12]);
+
+	Kick(adc);
+}
+
+void GSGIFPackedCodeGenerator::FOG(int offset)
+{
+	mov(eax, ptr[rbx + offset + 12]);
+	shr(eax, 4);
+	movzx(eax, al);
+	mov(ptr[r13 + offsetof(GSVertex, FOG)], eax);
+}
+
+void GSGIFPackedCodeGenerator::Kick(bool adc)
+{
+	// eax: the last dword of the register, which holds the ADC bit
+
+	if(adc)
+	{
+		mov(a1.cvt32(), 1);
+	}
+	else
+	{
+		mov(a1.cvt32(), eax);
+		and(a1.cvt32(), 0x8000);
+	}
+
+	mov(a0, (size_t)m_ctx.state);
+	mov(rax, (size_t)m_ctx.kick[m_sel.prim][m_sel.auto_flush]);
+	call(rax);
+}
+
+#else
+
+// Only generated for x64, GSState keeps the handler tables on x86
+
+void GSGIFPackedCodeGenerator::Generate()
+{
+	ret();
+}
+
+void GSGIFPackedCodeGenerator::RGBA(int offset) {}
+void GSGIFPackedCodeGenerator::STQ(int offset) {}
+void GSGIFPackedCodeGenerator::UV(int offset) {}
+void GSGIFPackedCodeGenerator::XYZF(int offset, bool adc) {}
+void GSGIFPackedCodeGenerator::XYZ(int offset, bool adc) {}
+void GSGIFPackedCodeGenerator::FOG(int offset) {}
+void GSGIFPackedCodeGenerator::Kick(bool adc) {}
+
+#endif
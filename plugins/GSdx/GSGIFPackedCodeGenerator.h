@@ -0,0 +1,83 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "Renderers/Common/GSFunctionMap.h"
+#include "Renderers/Common/GSVertex.h"
+
+// Key of a PACKED decoder: the register list of the GIFtag and the state the vertex kick
+// depends on. Tags with more registers than fit in regs use the handler tables.
+
+union GSGIFPackedSelector
+{
+	struct
+	{
+		uint64 regs:48; // 4 bits per register, in tag order
+		uint64 nreg:4;
+		uint64 prim:3;
+		uint64 auto_flush:1;
+		uint64 uv_hack:1;
+	};
+
+	uint64 key;
+
+	enum {MAX_REGS = 12};
+
+	operator uint64() const {return key;}
+};
+
+// Where the generated code reads and writes the vertex state of GSState
+
+struct GSGIFPackedContext
+{
+	GSVertex* v;
+	float* q;
+	bool* uv_hack_flag;
+	void* state;
+	void (*kick[8][2])(void* state, uint32 skip); // [prim][auto_flush]
+};
+
+typedef void (*GIFPackedDecoderPtr)(const GIFPackedReg* RESTRICT r, uint32 loops);
+
+class GSGIFPackedCodeGenerator : public GSCodeGenerator
+{
+	void operator = (const GSGIFPackedCodeGenerator&);
+
+	GSGIFPackedSelector m_sel;
+	GSGIFPackedContext& m_ctx;
+
+	void Generate();
+	void RGBA(int offset);
+	void STQ(int offset);
+	void UV(int offset);
+	void XYZF(int offset, bool adc);
+	void XYZ(int offset, bool adc);
+	void FOG(int offset);
+	void Kick(bool adc);
+
+public:
+	GSGIFPackedCodeGenerator(void* param, uint64 key, void* code, size_t maxsize);
+
+	// Registers a decoder can handle without going through the GSState handlers:
+	// anything that may flush or change the context (PRIM, TEX0, CLAMP, A+D) is left out.
+	static bool IsSupported(uint32 reg);
+};
@@ -87,6 +87,7 @@ GSLocalMemory::GSLocalMemory()
 	m_use_fifo_alloc = theApp.GetConfigB("UserHacks") && theApp.GetConfigB("wrap_gs_mem");
 	switch (theApp.GetCurrentRendererType()) {
 		case GSRendererType::OGL_SW:
+		case GSRendererType::SW:
 			m_use_fifo_alloc = true;
 			break;
 		default:
@@ -108,6 +109,10 @@ GSLocalMemory::GSLocalMemory()
 	m_vm16 = (uint16*)m_vm8;
 	m_vm32 = (uint32*)m_vm8;
 
+	memset(m_page_gen, 0, sizeof(m_page_gen));
+
+	m_page_gen_last = 0;
+
 	memset(m_vm8, 0, m_vmsize);
 
 	for(int bp = 0; bp < 32; bp++)
@@ -714,6 +719,59 @@ std::vector<GSVector2i>* GSLocalMemory::GetPage2TileMap(const GIFRegTEX0& TEX0)
 	return p2t;
 }
 
+void GSLocalMemory::BumpPages(const uint32* pages)
+{
+	uint32 gen = ++m_page_gen_last;
+
+	for(const uint32* p = pages; *p != GSOffset::EOP; p++)
+	{
+		m_page_gen[*p] = gen;
+	}
+}
+
+void GSLocalMemory::BumpPagesAsBits(const uint32* pages)
+{
+	uint32 gen = ++m_page_gen_last;
+
+	for(uint32 i = 0; i < MAX_PAGES / 32; i++)
+	{
+		unsigned long j;
+
+		for(uint32 bits = pages[i]; _BitScanForward(&j, bits); bits ^= 1u << j)
+		{
+			m_page_gen[(i << 5) + j] = gen;
+		}
+	}
+}
+
+bool GSLocalMemory::PagesChangedSince(const uint32* pages, uint32 gen) const
+{
+	// pages is a bitmap (see GSOffset::GetPagesAsBits), four generations are compared at once
+
+	GSVector4i g((int)gen);
+
+	for(uint32 i = 0; i < MAX_PAGES / 32; i++)
+	{
+		uint32 bits = pages[i];
+
+		if(bits == 0) continue;
+
+		const GSVector4i* RESTRICT pg = (const GSVector4i*)&m_page_gen[i << 5];
+
+		for(int j = 0; j < 8; j++, bits >>= 4)
+		{
+			// wrap-safe: newer when (int32)(pg - gen) > 0
+
+			if((bits & 15) != 0 && (GSVector4::cast((pg[j] - g) > GSVector4i::zero()).mask() & bits & 15) != 0)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
 ////////////////////
 
 template<int psm, int bsx, int bsy, int alignment>
@@ -127,6 +127,13 @@ public:
 
 	GSClut m_clut;
 
+	// Stamped with a new generation whenever a transfer or a draw writes the page. A cache that
+	// remembers m_page_gen_last when it synced up with the memory can tell if any of its pages
+	// were written since by comparing against that value.
+
+	alignas(16) uint32 m_page_gen[MAX_PAGES];
+	uint32 m_page_gen_last;
+
 protected:
 	bool m_use_fifo_alloc;
 
@@ -187,6 +194,33 @@ public:
 	GSPixelOffset4* GetPixelOffset4(const GIFRegFRAME& FRAME, const GIFRegZBUF& ZBUF);
 	std::vector<GSVector2i>* GetPage2TileMap(const GIFRegTEX0& TEX0);
 
+	// page generations
+
+	void BumpPages(const uint32* pages);
+	void BumpPagesAsBits(const uint32* pages);
+	bool PagesChangedSince(const uint32* pages, uint32 gen) const;
+
+	// content hash, two independent 64-bit lanes, size is a multiple of 8 bytes
+
+	static __forceinline void HashBlock(uint64* RESTRICT key, const void* RESTRICT src, uint32 offset, uint32 size = 256)
+	{
+		const uint64* s = (const uint64*)src;
+
+		uint64 a = key[0] ^ offset;
+		uint64 b = key[1] + offset;
+
+		for(uint32 i = 0; i < size / 8; i++)
+		{
+			a = (a ^ s[i]) * 0x9e3779b97f4a7c15ull;
+			b = (b + s[i]) * 0xc2b2ae3d27d4eb4full;
+			a ^= a >> 29;
+			b ^= b >> 32;
+		}
+
+		key[0] = a;
+		key[1] = b;
+	}
+
 	// address
 
 	static uint32 BlockNumber32(int x, int y, uint32 bp, uint32 bw)
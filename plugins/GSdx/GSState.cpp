@@ -25,12 +25,18 @@
 #include "GSUtil.h"
 #include "options_tools.h"
 
+#include <bitset>
+#include <chrono>
+
 //#define Offset_ST  // Fixes Persona3 mini map alignment which is off even in software rendering
 
 int GSState::s_n = 0;
 
 GSState::GSState()
-	: m_version(6)
+	: m_packed_map("GSGIFPacked", &m_packed_ctx)
+	, m_packed_last_key(0)
+	, m_packed_last(NULL)
+	, m_version(6)
 	, m_mt(false)
 	, m_irq(NULL)
 	, m_path3hack(0)
@@ -67,6 +73,33 @@ GSState::GSState()
 		m_userhacks_skipdraw_offset = 0;
 	}
 
+#if defined(_M_AMD64) || defined(_WIN64)
+	m_packed_jit = theApp.GetConfigB("packed_jit");
+#else
+	m_packed_jit = false;
+#endif
+	m_packed_bench_size = m_packed_jit ? (size_t)theApp.GetConfigI("packed_jit_benchmark") << 20 : 0;
+
+	memset(&m_packed_stats, 0, sizeof(m_packed_stats));
+
+	m_packed_ctx.v = &m_v;
+	m_packed_ctx.q = &m_q;
+	m_packed_ctx.uv_hack_flag = &m_isPackedUV_HackFlag;
+	m_packed_ctx.state = this;
+
+	#define SetPackedKick(P) \
+		m_packed_ctx.kick[P][0] = &GSState::VertexKickThunk<P, false>; \
+		m_packed_ctx.kick[P][1] = &GSState::VertexKickThunk<P, true>; \
+
+	SetPackedKick(GS_POINTLIST);
+	SetPackedKick(GS_LINELIST);
+	SetPackedKick(GS_LINESTRIP);
+	SetPackedKick(GS_TRIANGLELIST);
+	SetPackedKick(GS_TRIANGLESTRIP);
+	SetPackedKick(GS_TRIANGLEFAN);
+	SetPackedKick(GS_SPRITE);
+	SetPackedKick(GS_INVALID);
+
 	s_n = 0;
 	s_save  = theApp.GetConfigB("save");
 	s_savet = theApp.GetConfigB("savet");
@@ -149,10 +182,24 @@ GSState::GSState()
 	Reset();
 
 	ResetHandlers();
+
+	if(theApp.GetConfigB("move_benchmark"))
+	{
+		RunMoveBenchmark();
+	}
 }
 
 GSState::~GSState()
 {
+#ifdef _DEBUG
+	if(m_packed_stats.tags)
+	{
+		fprintf(stderr, "GSGIFPacked: %llu tags, %.1f%% decoded by %llu decoders (%llu registers), %.1f%% signature hits\n",
+			m_packed_stats.tags, 100.0 * m_packed_stats.jit_tags / m_packed_stats.tags, m_packed_stats.signatures,
+			m_packed_stats.jit_regs, 100.0 * m_packed_stats.hits / m_packed_stats.tags);
+	}
+#endif
+
 	if(m_vertex.buff) _aligned_free(m_vertex.buff);
 	if(m_index.buff) _aligned_free(m_index.buff);
 }
@@ -1842,34 +1889,47 @@ void GSState::Move()
 	InvalidateLocalMem(m_env.BITBLTBUF, GSVector4i(sx, sy, sx + w, sy + h));
 	InvalidateVideoMem(m_env.BITBLTBUF, GSVector4i(dx, dy, dx + w, dy + h));
 
+	if(!MoveBlocks(m_env.BITBLTBUF, m_env.TRXPOS, w, h))
+	{
+		MovePixels(m_env.BITBLTBUF, m_env.TRXPOS, w, h);
+	}
+}
+
+void GSState::MovePixels(const GIFRegBITBLTBUF& BITBLTBUF, const GIFRegTRXPOS& TRXPOS, int w, int h)
+{
+	int sx = TRXPOS.SSAX;
+	int sy = TRXPOS.SSAY;
+	int dx = TRXPOS.DSAX;
+	int dy = TRXPOS.DSAY;
+
 	int xinc = 1;
 	int yinc = 1;
 
-	if(m_env.TRXPOS.DIRX) {sx += w - 1; dx += w - 1; xinc = -1;}
-	if(m_env.TRXPOS.DIRY) {sy += h - 1; dy += h - 1; yinc = -1;}
+	if(TRXPOS.DIRX) {sx += w - 1; dx += w - 1; xinc = -1;}
+	if(TRXPOS.DIRY) {sy += h - 1; dy += h - 1; yinc = -1;}
 /*
 	printf("%05x %d %d => %05x %d %d (%d%d), %d %d %d %d %d %d\n",
-		m_env.BITBLTBUF.SBP, m_env.BITBLTBUF.SBW, m_env.BITBLTBUF.SPSM,
-		m_env.BITBLTBUF.DBP, m_env.BITBLTBUF.DBW, m_env.BITBLTBUF.DPSM,
-		m_env.TRXPOS.DIRX, m_env.TRXPOS.DIRY,
+		BITBLTBUF.SBP, BITBLTBUF.SBW, BITBLTBUF.SPSM,
+		BITBLTBUF.DBP, BITBLTBUF.DBW, BITBLTBUF.DPSM,
+		TRXPOS.DIRX, TRXPOS.DIRY,
 		sx, sy, dx, dy, w, h);
 */
 /*
-	GSLocalMemory::readPixel rp = GSLocalMemory::m_psm[m_env.BITBLTBUF.SPSM].rp;
-	GSLocalMemory::writePixel wp = GSLocalMemory::m_psm[m_env.BITBLTBUF.DPSM].wp;
+	GSLocalMemory::readPixel rp = GSLocalMemory::m_psm[BITBLTBUF.SPSM].rp;
+	GSLocalMemory::writePixel wp = GSLocalMemory::m_psm[BITBLTBUF.DPSM].wp;
 
 	for(int y = 0; y < h; y++, sy += yinc, dy += yinc, sx -= xinc*w, dx -= xinc*w)
 		for(int x = 0; x < w; x++, sx += xinc, dx += xinc)
-			(m_mem.*wp)(dx, dy, (m_mem.*rp)(sx, sy, m_env.BITBLTBUF.SBP, m_env.BITBLTBUF.SBW), m_env.BITBLTBUF.DBP, m_env.BITBLTBUF.DBW);
+			(m_mem.*wp)(dx, dy, (m_mem.*rp)(sx, sy, BITBLTBUF.SBP, BITBLTBUF.SBW), BITBLTBUF.DBP, BITBLTBUF.DBW);
 */
 
-	const GSLocalMemory::psm_t& spsm = GSLocalMemory::m_psm[m_env.BITBLTBUF.SPSM];
-	const GSLocalMemory::psm_t& dpsm = GSLocalMemory::m_psm[m_env.BITBLTBUF.DPSM];
+	const GSLocalMemory::psm_t& spsm = GSLocalMemory::m_psm[BITBLTBUF.SPSM];
+	const GSLocalMemory::psm_t& dpsm = GSLocalMemory::m_psm[BITBLTBUF.DPSM];
 
 	// TODO: unroll inner loops (width has special size requirement, must be multiples of 1 << n, depending on the format)
 
-	GSOffset* RESTRICT spo = m_mem.GetOffset(m_env.BITBLTBUF.SBP, m_env.BITBLTBUF.SBW, m_env.BITBLTBUF.SPSM);
-	GSOffset* RESTRICT dpo = m_mem.GetOffset(m_env.BITBLTBUF.DBP, m_env.BITBLTBUF.DBW, m_env.BITBLTBUF.DPSM);
+	GSOffset* RESTRICT spo = m_mem.GetOffset(BITBLTBUF.SBP, BITBLTBUF.SBW, BITBLTBUF.SPSM);
+	GSOffset* RESTRICT dpo = m_mem.GetOffset(BITBLTBUF.DBP, BITBLTBUF.DBW, BITBLTBUF.DPSM);
 
 	if(spsm.trbpp == dpsm.trbpp && spsm.trbpp >= 16)
 	{
@@ -1946,7 +2006,7 @@ void GSState::Move()
 			}
 		}
 	}
-	else if(m_env.BITBLTBUF.SPSM == PSM_PSMT8 && m_env.BITBLTBUF.DPSM == PSM_PSMT8)
+	else if(BITBLTBUF.SPSM == PSM_PSMT8 && BITBLTBUF.DPSM == PSM_PSMT8)
 	{
 		if(xinc > 0)
 		{
@@ -1975,7 +2035,7 @@ void GSState::Move()
 			}
 		}
 	}
-	else if(m_env.BITBLTBUF.SPSM == PSM_PSMT4 && m_env.BITBLTBUF.DPSM == PSM_PSMT4)
+	else if(BITBLTBUF.SPSM == PSM_PSMT4 && BITBLTBUF.DPSM == PSM_PSMT4)
 	{
 		if(xinc > 0)
 		{
@@ -2035,6 +2095,296 @@ void GSState::Move()
 	}
 }
 
+template<int n, bool masked>
+static __forceinline void MoveUnit(uint8* RESTRICT dst, const uint8* RESTRICT src, const GSVector4i& mask)
+{
+	GSVector4i* RESTRICT d = (GSVector4i*)dst;
+	const GSVector4i* RESTRICT s = (const GSVector4i*)src;
+
+	for(int i = 0; i < n / 16; i++)
+	{
+		d[i] = masked ? d[i].blend(s[i], mask) : s[i];
+	}
+}
+
+bool GSState::MoveBlocks(const GIFRegBITBLTBUF& BITBLTBUF, const GIFRegTRXPOS& TRXPOS, int w, int h)
+{
+	// A block is four 64 byte columns and the pixel swizzle inside a column only depends on the format
+	// (8 and 4 bit columns alternate between two layouts), so when both sides share the format and line
+	// up on columns the transfer is a plain copy of columns, or of whole blocks if the rows allow it.
+
+	if(BITBLTBUF.SPSM != BITBLTBUF.DPSM || w <= 0 || h <= 0)
+	{
+		return false;
+	}
+
+	const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[BITBLTBUF.SPSM];
+
+	int sx = TRXPOS.SSAX;
+	int sy = TRXPOS.SSAY;
+	int dx = TRXPOS.DSAX;
+	int dy = TRXPOS.DSAY;
+
+	const GSVector2i& bs = psm.bs;
+
+	int ch = bs.y >> 2;
+
+	if(((sx | dx | w) & (bs.x - 1)) || ((sy | dy | h) & (ch - 1)))
+	{
+		return false;
+	}
+
+	if(psm.bpp < 16 && ((sy ^ dy) & ch))
+	{
+		return false;
+	}
+
+	if(std::max(sx, dx) + w > 2048 || std::max(sy, dy) + h > 2048)
+	{
+		return false;
+	}
+
+	GSOffset* RESTRICT spo = m_mem.GetOffset(BITBLTBUF.SBP, BITBLTBUF.SBW, BITBLTBUF.SPSM);
+	GSOffset* RESTRICT dpo = m_mem.GetOffset(BITBLTBUF.DBP, BITBLTBUF.DBW, BITBLTBUF.DPSM);
+
+	// Copying unit by unit in transfer order matches the pixel loop as long as no unit is read after it was
+	// partially written. That rules out destination blocks aliasing each other, and overlapping source and
+	// destination unless it is the same buffer shifted by whole units without wrapping around.
+
+	std::bitset<MAX_BLOCKS> sblocks;
+	std::bitset<MAX_BLOCKS> dblocks;
+
+	bool wrapped = false;
+	bool overlap = false;
+
+	for(int y = sy & ~(bs.y - 1); y < sy + h; y += bs.y)
+	{
+		for(int x = sx; x < sx + w; x += bs.x)
+		{
+			uint32 bn = spo->block.row[y >> 3] + spo->block.col[x >> 3];
+
+			wrapped |= bn >= MAX_BLOCKS;
+
+			sblocks.set(bn % MAX_BLOCKS);
+		}
+	}
+
+	for(int y = dy & ~(bs.y - 1); y < dy + h; y += bs.y)
+	{
+		for(int x = dx; x < dx + w; x += bs.x)
+		{
+			uint32 bn = dpo->block.row[y >> 3] + dpo->block.col[x >> 3];
+
+			wrapped |= bn >= MAX_BLOCKS;
+
+			bn %= MAX_BLOCKS;
+
+			if(dblocks[bn])
+			{
+				return false;
+			}
+
+			dblocks.set(bn);
+
+			overlap |= sblocks[bn];
+		}
+	}
+
+	if(overlap)
+	{
+		int bw = (BITBLTBUF.SBW * 64) & ~(psm.pgs.x - 1);
+
+		if(spo != dpo || wrapped || std::max(sx, dx) + w > bw)
+		{
+			return false;
+		}
+	}
+
+	uint32 m = 0xffffffff;
+
+	switch(BITBLTBUF.SPSM)
+	{
+	case PSM_PSMCT24:
+	case PSM_PSMZ24: m = 0x00ffffff; break;
+	case PSM_PSMT8H: m = 0xff000000; break;
+	case PSM_PSMT4HL: m = 0x0f000000; break;
+	case PSM_PSMT4HH: m = 0xf0000000; break;
+	}
+
+	GSVector4i mask(m);
+
+	bool blocks = ((sy | dy | h) & (bs.y - 1)) == 0;
+
+	int uh = blocks ? bs.y : ch;
+	int xn = w / bs.x;
+	int yn = h / uh;
+
+	for(int j = 0; j < yn; j++)
+	{
+		int i = TRXPOS.DIRY ? yn - 1 - j : j;
+
+		int syy = sy + i * uh;
+		int dyy = dy + i * uh;
+
+		int soffset = blocks ? 0 : ((syy / ch) & 3) << 6;
+		int doffset = blocks ? 0 : ((dyy / ch) & 3) << 6;
+
+		for(int k = 0; k < xn; k++)
+		{
+			int l = TRXPOS.DIRX ? xn - 1 - k : k;
+
+			const uint8* s = m_mem.BlockPtr(spo->block.row[syy >> 3] + spo->block.col[(sx >> 3) + l * (bs.x >> 3)]) + soffset;
+			uint8* d = m_mem.BlockPtr(dpo->block.row[dyy >> 3] + dpo->block.col[(dx >> 3) + l * (bs.x >> 3)]) + doffset;
+
+			if(m == 0xffffffff)
+			{
+				if(blocks) MoveUnit<256, false>(d, s, mask);
+				else MoveUnit<64, false>(d, s, mask);
+			}
+			else
+			{
+				if(blocks) MoveUnit<256, true>(d, s, mask);
+				else MoveUnit<64, true>(d, s, mask);
+			}
+		}
+	}
+
+	return true;
+}
+
+void GSState::RunMoveBenchmark()
+{
+	static const uint32 psms[] =
+	{
+		PSM_PSMCT32, PSM_PSMCT24, PSM_PSMCT16, PSM_PSMCT16S, PSM_PSMT8, PSM_PSMT4, PSM_PSMT8H, PSM_PSMT4HL, PSM_PSMT4HH,
+		PSM_PSMZ32, PSM_PSMZ24, PSM_PSMZ16, PSM_PSMZ16S,
+	};
+
+	// aligned blocks, aligned columns, the same buffer scrolled both ways, and an unaligned move for the pixel loop
+
+	struct {uint32 sbp, dbp; int sx, sy, dx, dy, w, h; uint32 dir;} cases[] =
+	{
+		{0x0000, 0x2000, 0, 0, 64, 32, 256, 128, 0},
+		{0x0000, 0x2000, 0, 4, 32, 36, 128, 64, 0},
+		{0x0000, 0x0000, 64, 32, 0, 0, 256, 128, 0},
+		{0x0000, 0x0000, 0, 0, 64, 32, 256, 128, 3},
+		{0x0000, 0x2000, 3, 1, 7, 2, 250, 120, 0},
+	};
+
+	const int reps = 16;
+
+	std::vector<uint8> saved(m_mem.m_vm8, m_mem.m_vm8 + GSLocalMemory::m_vmsize);
+	std::vector<uint8> init(GSLocalMemory::m_vmsize);
+	std::vector<uint8> ref(GSLocalMemory::m_vmsize);
+
+	uint32 seed = 0x9e3779b9;
+
+	for(size_t i = 0; i < init.size(); i += 4)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+
+		*(uint32*)&init[i] = seed;
+	}
+
+	int mismatches = 0;
+
+	double pixels_total = 0;
+	double blocks_total = 0;
+
+	for(uint32 spsm : psms)
+	{
+		for(uint32 dpsm : psms)
+		{
+			double pixels_s = 0;
+			double blocks_s = 0;
+
+			int fast = 0;
+
+			for(const auto& c : cases)
+			{
+				GIFRegBITBLTBUF BITBLTBUF;
+				GIFRegTRXPOS TRXPOS;
+
+				BITBLTBUF.u64 = 0;
+				BITBLTBUF.SBP = c.sbp;
+				BITBLTBUF.SBW = 10;
+				BITBLTBUF.SPSM = spsm;
+				BITBLTBUF.DBP = c.dbp;
+				BITBLTBUF.DBW = 10;
+				BITBLTBUF.DPSM = dpsm;
+
+				TRXPOS.u64 = 0;
+				TRXPOS.SSAX = c.sx;
+				TRXPOS.SSAY = c.sy;
+				TRXPOS.DSAX = c.dx;
+				TRXPOS.DSAY = c.dy;
+				TRXPOS.DIRX = c.dir & 1;
+				TRXPOS.DIRY = c.dir >> 1;
+
+				memcpy(m_mem.m_vm8, init.data(), init.size());
+				MovePixels(BITBLTBUF, TRXPOS, c.w, c.h);
+				memcpy(ref.data(), m_mem.m_vm8, ref.size());
+
+				memcpy(m_mem.m_vm8, init.data(), init.size());
+
+				if(MoveBlocks(BITBLTBUF, TRXPOS, c.w, c.h))
+				{
+					fast++;
+				}
+				else
+				{
+					MovePixels(BITBLTBUF, TRXPOS, c.w, c.h);
+				}
+
+				if(memcmp(ref.data(), m_mem.m_vm8, ref.size()) != 0)
+				{
+					printf("GSdx: move %s -> %s (%d,%d -> %d,%d %dx%d DIR %d) mismatch\n",
+						psm_str(spsm), psm_str(dpsm), c.sx, c.sy, c.dx, c.dy, c.w, c.h, c.dir);
+
+					mismatches++;
+				}
+
+				auto start = std::chrono::steady_clock::now();
+
+				for(int i = 0; i < reps; i++)
+				{
+					MovePixels(BITBLTBUF, TRXPOS, c.w, c.h);
+				}
+
+				auto pixels_end = std::chrono::steady_clock::now();
+
+				for(int i = 0; i < reps; i++)
+				{
+					if(!MoveBlocks(BITBLTBUF, TRXPOS, c.w, c.h))
+					{
+						MovePixels(BITBLTBUF, TRXPOS, c.w, c.h);
+					}
+				}
+
+				auto blocks_end = std::chrono::steady_clock::now();
+
+				pixels_s += std::chrono::duration<double>(pixels_end - start).count();
+				blocks_s += std::chrono::duration<double>(blocks_end - pixels_end).count();
+			}
+
+			printf("GSdx: move %-6s -> %-6s %8.1f us %8.1f us (x%.2f, %d/%d cases on blocks)\n",
+				psm_str(spsm), psm_str(dpsm),
+				pixels_s * 1e6 / reps, blocks_s * 1e6 / reps, pixels_s / blocks_s,
+				fast, (int)countof(cases));
+
+			pixels_total += pixels_s;
+			blocks_total += blocks_s;
+		}
+	}
+
+	printf("GSdx: move benchmark, pixels %.1f ms, blocks %.1f ms (x%.2f), %d mismatches\n",
+		pixels_total * 1e3, blocks_total * 1e3, pixels_total / blocks_total, mismatches);
+
+	memcpy(m_mem.m_vm8, saved.data(), saved.size());
+}
+
 void GSState::SoftReset(uint32 mask)
 {
 	if(mask & 1)
@@ -2130,6 +2480,21 @@ template<int index> void GSState::Transfer(const uint8* mem, uint32 size)
 					{
 					case GIFPath::TYPE_UNKNOWN:
 
+						{
+							GSGIFPackedSelector sel;
+
+							if(GIFPackedDecoderPtr f = GetPackedDecoder(path, sel))
+							{
+								if(m_packed_bench_size) RecordPackedTag(sel, mem, path.nloop);
+
+								f((GIFPackedReg*)mem, path.nloop);
+
+								mem += total * sizeof(GIFPackedReg);
+
+								break;
+							}
+						}
+
 						{
 							uint32 reg = 0;
 
@@ -2843,6 +3208,234 @@ __forceinline void GSState::VertexKick(uint32 skip)
 		FlushPrim();
 }
 
+template<uint32 prim, bool auto_flush>
+void GSState::VertexKickThunk(void* state, uint32 skip)
+{
+	((GSState*)state)->VertexKick<prim, auto_flush>(skip);
+}
+
+// Packs the 4-bit register numbers held in the bytes of x, 8 of them into 32 bits
+static __forceinline uint64 PackRegNibbles(uint64 x)
+{
+	x = (x | (x >> 4)) & 0x00ff00ff00ff00ffull;
+	x = (x | (x >> 8)) & 0x0000ffff0000ffffull;
+	x = (x | (x >> 16)) & 0x00000000ffffffffull;
+
+	return x;
+}
+
+GIFPackedDecoderPtr GSState::GetPackedDecoder(const GIFPath& path, GSGIFPackedSelector& sel)
+{
+	if(!m_packed_jit || m_frameskip || path.nreg > GSGIFPackedSelector::MAX_REGS)
+	{
+		return NULL;
+	}
+
+	m_packed_stats.tags++;
+
+	// registers past nreg are zero, see GIFPath::SetTag
+
+	sel.key = 0;
+	sel.regs = PackRegNibbles(path.regs.u64[0]) | (PackRegNibbles(path.regs.u64[1]) << 32);
+	sel.nreg = path.nreg;
+	sel.prim = PRIM->PRIM;
+	sel.auto_flush = m_userhacks_auto_flush;
+	sel.uv_hack = m_userhacks_wildhack;
+
+	if(sel.key == m_packed_last_key)
+	{
+		m_packed_stats.hits++;
+	}
+	else
+	{
+		GIFPackedDecoderPtr f = NULL;
+
+		uint32 i = 0;
+
+		while(i < sel.nreg && GSGIFPackedCodeGenerator::IsSupported((sel.regs >> (i * 4)) & 0xf))
+		{
+			i++;
+		}
+
+		if(i == sel.nreg)
+		{
+			f = m_packed_map[sel];
+
+			m_packed_stats.signatures = m_packed_map.GetActiveCount();
+		}
+
+		m_packed_last_key = sel.key;
+		m_packed_last = f;
+	}
+
+	if(m_packed_last)
+	{
+		m_packed_stats.jit_tags++;
+		m_packed_stats.jit_regs += path.nloop * path.nreg;
+	}
+
+	return m_packed_last;
+}
+
+void GSState::RecordPackedTag(const GSGIFPackedSelector& sel, const uint8* mem, uint32 loops)
+{
+	GIFPackedBenchTag tag;
+
+	tag.sel = sel;
+	tag.loops = loops;
+	tag.offset = m_packed_bench_data.size();
+
+	m_packed_bench_data.insert(m_packed_bench_data.end(), mem, mem + loops * sel.nreg * sizeof(GIFPackedReg));
+	m_packed_bench_tags.push_back(tag);
+
+	if(m_packed_bench_data.size() >= m_packed_bench_size)
+	{
+		m_packed_bench_size = 0;
+
+		RunPackedBenchmark();
+
+		std::vector<GIFPackedBenchTag>().swap(m_packed_bench_tags);
+		std::vector<uint8>().swap(m_packed_bench_data);
+	}
+}
+
+void GSState::RunPackedBenchmark()
+{
+	if(m_userhacks_auto_flush)
+	{
+		printf("GSdx: packed decoder benchmark skipped, auto flush could draw\n");
+		return;
+	}
+
+	// Every tag starts from the current vertex queue and it is rewound afterwards, so
+	// nothing gets drawn and the vertex buffer doesn't grow.
+
+	GSVertex v = m_v;
+	float q = m_q;
+	bool uv_hack_flag = m_isPackedUV_HackFlag;
+	auto vertex = m_vertex;
+	size_t index_tail = m_index.tail;
+
+	auto rewind = [&]()
+	{
+		m_v = v;
+		m_q = q;
+		m_isPackedUV_HackFlag = uv_hack_flag;
+		m_vertex.head = vertex.head;
+		m_vertex.tail = vertex.tail;
+		m_vertex.next = vertex.next;
+		m_vertex.xy_tail = vertex.xy_tail;
+		memcpy(m_vertex.xy, vertex.xy, sizeof(m_vertex.xy));
+		m_index.tail = index_tail;
+	};
+
+	GIFPackedRegHandler handlers[8][16];
+
+	for(int prim = 0; prim < 8; prim++)
+	{
+		memcpy(handlers[prim], m_fpGIFPackedRegHandlers, sizeof(handlers[prim]));
+
+		handlers[prim][GIF_REG_XYZF2] = m_fpGIFPackedRegHandlerXYZ[prim][0];
+		handlers[prim][GIF_REG_XYZF3] = m_fpGIFPackedRegHandlerXYZ[prim][1];
+		handlers[prim][GIF_REG_XYZ2] = m_fpGIFPackedRegHandlerXYZ[prim][2];
+		handlers[prim][GIF_REG_XYZ3] = m_fpGIFPackedRegHandlerXYZ[prim][3];
+	}
+
+	std::vector<GIFPackedDecoderPtr> decoders;
+
+	for(const auto& tag : m_packed_bench_tags)
+	{
+		decoders.push_back(m_packed_map[tag.sel]);
+	}
+
+	auto decode_table = [&](const GIFPackedBenchTag& tag)
+	{
+		const GIFPackedReg* r = (const GIFPackedReg*)&m_packed_bench_data[tag.offset];
+		GIFPackedRegHandler* h = handlers[tag.sel.prim];
+
+		for(uint32 i = 0; i < tag.loops; i++)
+		{
+			for(uint32 j = 0; j < tag.sel.nreg; j++)
+			{
+				(this->*h[(tag.sel.regs >> (j * 4)) & 0xf])(r++);
+			}
+		}
+	};
+
+	auto decode_jit = [&](size_t i)
+	{
+		decoders[i]((const GIFPackedReg*)&m_packed_bench_data[m_packed_bench_tags[i].offset], m_packed_bench_tags[i].loops);
+	};
+
+	// both paths must leave the same vertices and indices behind
+
+	size_t mismatches = 0;
+
+	std::vector<GSVertex> ref_vertex;
+	std::vector<uint32> ref_index;
+
+	for(size_t i = 0; i < m_packed_bench_tags.size(); i++)
+	{
+		rewind();
+		decode_table(m_packed_bench_tags[i]);
+
+		GSVertex ref_v = m_v;
+		float ref_q = m_q;
+		size_t ref_tail = m_vertex.tail;
+		size_t ref_index_tail = m_index.tail;
+
+		ref_vertex.assign(m_vertex.buff + vertex.next, m_vertex.buff + m_vertex.tail);
+		ref_index.assign(m_index.buff + index_tail, m_index.buff + m_index.tail);
+
+		rewind();
+		decode_jit(i);
+
+		if(memcmp(&ref_v, &m_v, sizeof(m_v)) != 0 || ref_q != m_q
+		|| ref_tail != m_vertex.tail || ref_index_tail != m_index.tail
+		|| memcmp(ref_vertex.data(), m_vertex.buff + vertex.next, ref_vertex.size() * sizeof(GSVertex)) != 0
+		|| memcmp(ref_index.data(), m_index.buff + index_tail, ref_index.size() * sizeof(uint32)) != 0)
+		{
+			mismatches++;
+		}
+	}
+
+	const int passes = 4;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(int pass = 0; pass < passes; pass++)
+	{
+		for(const auto& tag : m_packed_bench_tags)
+		{
+			rewind();
+			decode_table(tag);
+		}
+	}
+
+	auto table_end = std::chrono::steady_clock::now();
+
+	for(int pass = 0; pass < passes; pass++)
+	{
+		for(size_t i = 0; i < m_packed_bench_tags.size(); i++)
+		{
+			rewind();
+			decode_jit(i);
+		}
+	}
+
+	auto jit_end = std::chrono::steady_clock::now();
+
+	rewind();
+
+	double mb = (double)m_packed_bench_data.size() * passes / (1024 * 1024);
+	double table_s = std::chrono::duration<double>(table_end - start).count();
+	double jit_s = std::chrono::duration<double>(jit_end - table_end).count();
+
+	printf("GSdx: packed decoder benchmark, %zu tags, %.1f MB, %zu signatures, %zu mismatches\n",
+		m_packed_bench_tags.size(), mb / passes, m_packed_map.GetActiveCount(), mismatches);
+	printf("GSdx:   tables %.1f MB/s, jit %.1f MB/s (x%.2f)\n", mb / table_s, mb / jit_s, table_s / jit_s);
+}
+
 void GSState::GetTextureMinMax(GSVector4i& r, const GIFRegTEX0& TEX0, const GIFRegCLAMP& CLAMP, bool linear)
 {
 	// TODO: some of the +1s can be removed if linear == false
@@ -33,6 +33,7 @@
 #include "Renderers/Common/GSDevice.h"
 #include "GSCrc.h"
 #include "GSAlignedClass.h"
+#include "GSGIFPackedCodeGenerator.h"
 
 struct GSFrameInfo
 {
@@ -82,6 +83,36 @@ class GSState : public GSAlignedClass<32>
 	template<uint32 prim, bool auto_flush> void GIFPackedRegHandlerSTQRGBAXYZ2(const GIFPackedReg* RESTRICT r, uint32 size);
 	void GIFPackedRegHandlerNOP(const GIFPackedReg* RESTRICT r, uint32 size);
 
+	// Generated decoders for the PACKED tags without a predefined type, one per register
+	// list and prim (see GSGIFPackedCodeGenerator). The previous signature is cached since
+	// consecutive tags mostly share it.
+
+	GSCodeGeneratorFunctionMap<GSGIFPackedCodeGenerator, uint64, GIFPackedDecoderPtr> m_packed_map;
+	GSGIFPackedContext m_packed_ctx;
+	bool m_packed_jit;
+	uint64 m_packed_last_key;
+	GIFPackedDecoderPtr m_packed_last;
+
+	template<uint32 prim, bool auto_flush> static void VertexKickThunk(void* state, uint32 skip);
+	GIFPackedDecoderPtr GetPackedDecoder(const GIFPath& path, GSGIFPackedSelector& sel);
+
+	// packed_jit_benchmark: records that many MB of decodable tags, then times them through
+	// the handler tables and the generated decoders and checks that both produce the same vertices
+
+	struct GIFPackedBenchTag
+	{
+		GSGIFPackedSelector sel;
+		uint32 loops;
+		size_t offset;
+	};
+
+	std::vector<GIFPackedBenchTag> m_packed_bench_tags;
+	std::vector<uint8> m_packed_bench_data;
+	size_t m_packed_bench_size;
+
+	void RecordPackedTag(const GSGIFPackedSelector& sel, const uint8* mem, uint32 loops);
+	void RunPackedBenchmark();
+
 	template<int i> void ApplyTEX0(GIFRegTEX0& TEX0);
 	void ApplyPRIM(uint32 prim);
 
@@ -210,6 +241,17 @@ protected:
 	GIFRegTEX0 GetTex0Layer(uint32 lod);
 
 public:
+	struct GIFPackedStats
+	{
+		uint64 tags;		// PACKED tags without a predefined type
+		uint64 jit_tags;	// decoded by a generated decoder
+		uint64 jit_regs;
+		uint64 hits;		// same signature as the previous tag
+		uint64 signatures;	// decoders generated
+	};
+
+	GIFPackedStats m_packed_stats;
+
 	GIFPath m_path[4];
 	GIFRegPRIM* PRIM;
 	GSPrivRegSet* m_regs;
@@ -259,6 +301,9 @@ public:
 	virtual void InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut = false) {}
 
 	void Move();
+	void MovePixels(const GIFRegBITBLTBUF& BITBLTBUF, const GIFRegTRXPOS& TRXPOS, int w, int h);
+	bool MoveBlocks(const GIFRegBITBLTBUF& BITBLTBUF, const GIFRegTRXPOS& TRXPOS, int w, int h);
+	void RunMoveBenchmark();
 	void Write(const uint8* mem, int len);
 	void Read(uint8* mem, int len);
 	void InitReadFIFO(uint8* mem, int len);
@@ -334,6 +334,7 @@ void GSdxApp::Init()
 	m_default_configuration["mipmap_hw"]                                  = std::to_string(static_cast<int>(HWMipmapLevel::Automatic));
 	m_default_configuration["ModeHeight"]                                 = "480";
 	m_default_configuration["ModeWidth"]                                  = "640";
+	m_default_configuration["move_benchmark"]                             = "0";
 	m_default_configuration["NTSC_Saturation"]                            = "1";
 	m_default_configuration["override_geometry_shader"]                   = "-1";
 	m_default_configuration["override_GL_ARB_compute_shader"]             = "-1";
@@ -352,9 +353,12 @@ void GSdxApp::Init()
 	m_default_configuration["override_GL_ARB_texture_view"]               = "-1";
 	m_default_configuration["override_GL_ARB_vertex_attrib_binding"]      = "-1";
 	m_default_configuration["override_GL_ARB_texture_barrier"]            = "-1";
+	m_default_configuration["packed_jit"]                                 = "1";
+	m_default_configuration["packed_jit_benchmark"]                       = "0";
 	m_default_configuration["paltex"]                                     = "0";
 	m_default_configuration["png_compression_level"]                      = std::to_string(Z_BEST_SPEED);
 	m_default_configuration["preload_frame_with_gs_data"]                 = "0";
+	m_default_configuration["present_stats"]                              = "0";
 	m_default_configuration["Renderer"]                                   = std::to_string(static_cast<int>(GSRendererType::Default));
 	m_default_configuration["resx"]                                       = "1024";
 	m_default_configuration["resy"]                                       = "1024";
@@ -367,7 +371,12 @@ void GSdxApp::Init()
 	m_default_configuration["shaderfx"]                                   = "0";
 	m_default_configuration["shaderfx_conf"]                              = "shaders/GSdx_FX_Settings.ini";
 	m_default_configuration["shaderfx_glsl"]                              = "shaders/GSdx.fx";
+	m_default_configuration["sync_stats"]                                 = "0";
+	m_default_configuration["texture_hash_cache"]                         = "0";
+	m_default_configuration["texture_hash_budget"]                        = "64";
+	m_default_configuration["texture_hash_dedup"]                         = "0";
 	m_default_configuration["TVShader"]                                   = "0";
+	m_default_configuration["unswizzle_stats"]                            = "0";
 	m_default_configuration["upscale_multiplier"]                         = "1";
 	m_default_configuration["UserHacks"]                                  = "0";
 	m_default_configuration["UserHacks_align_sprite_X"]                   = "0";
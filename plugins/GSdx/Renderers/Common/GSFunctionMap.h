@@ -86,6 +86,11 @@ public:
 		return m_active->f;
 	}
 
+	size_t GetActiveCount() const
+	{
+		return m_map_active.size();
+	}
+
 	void UpdateStats(uint64 frame, uint64 ticks, int actual, int total)
 	{
 		if(m_active)
@@ -21,6 +21,7 @@
 
 #include "stdafx.h"
 #include "GSRenderer.h"
+#include <chrono>
 #if defined(__unix__)
 #include <X11/keysym.h>
 #endif
@@ -46,6 +47,10 @@ GSRenderer::GSRenderer()
 	m_aa1         = theApp.GetConfigB("aa1");
 	m_fxaa        = theApp.GetConfigB("fxaa");
 	m_dithering   = theApp.GetConfigI("dithering_ps2"); // 0 off, 1 auto, 2 auto no scale
+
+	m_print_present_stats = theApp.GetConfigB("present_stats");
+
+	memset(&m_present_stats, 0, sizeof(m_present_stats));
 }
 
 GSRenderer::~GSRenderer()
@@ -306,6 +311,8 @@ void GSRenderer::VSync(int field)
 
 	Flush();
 
+	auto start = std::chrono::steady_clock::now();
+
 	if(!m_dev->IsLost(true))
 	{
 		if(!Merge(field ? 1 : 0))
@@ -325,6 +332,16 @@ void GSRenderer::VSync(int field)
 
 	// present
 	m_dev->Present(m_wnd->GetClientRect().fit(m_aspectratio), m_shader);
+
+	m_present_stats.last_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	m_present_stats.total_ms += m_present_stats.last_ms;
+	m_present_stats.frames++;
+
+	if(m_print_present_stats && (m_present_stats.frames % 60) == 0)
+	{
+		printf("GSdx: present %.3f ms, %.3f ms avg over %llu frames\n",
+			m_present_stats.last_ms, m_present_stats.total_ms / m_present_stats.frames, (unsigned long long)m_present_stats.frames);
+	}
 }
 
 bool GSRenderer::MakeSnapshot(const std::string& path)
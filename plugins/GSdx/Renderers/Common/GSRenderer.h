@@ -34,6 +34,8 @@ class GSRenderer : public GSState
 	bool m_shift_key;
 	bool m_control_key;
 
+	bool m_print_present_stats;
+
 protected:
 	int m_dithering;
 	int m_interlace;
@@ -47,6 +49,17 @@ protected:
 	virtual GSTexture* GetOutput(int i, int& y_offset) = 0;
 	virtual GSTexture* GetFeedbackOutput() { return nullptr; }
 
+public:
+	struct PresentStats
+	{
+		uint64 frames;
+		double last_ms; // output readback, merge and present of the last shown frame
+		double total_ms;
+	};
+
+protected:
+	PresentStats m_present_stats;
+
 public:
 	std::shared_ptr<GSWnd> m_wnd;
 	GSDevice* m_dev;
@@ -65,6 +78,7 @@ public:
 	virtual int GetUpscaleMultiplier() {return 1;}
 	virtual GSVector2i GetCustomResolution() {return GSVector2i(0,0);}
 	GSVector2i GetInternalResolution();
+	const PresentStats& GetPresentStats() const {return m_present_stats;}
 	void SetAspectRatio(int aspect) {m_aspectratio = aspect;}
 	void SetVSync(int vsync);
 
@@ -29,7 +29,7 @@ GSTextureCache11::GSTextureCache11(GSRenderer* r)
 {
 }
 
-void GSTextureCache11::Read(Target* t, const GSVector4i& r)
+void GSTextureCache11::DoRead(Target* t, const GSVector4i& r)
 {
 	if (!t->m_dirty.empty() || r.width() == 0 || r.height() == 0)
 	{
@@ -115,7 +115,7 @@ void GSTextureCache11::Read(Target* t, const GSVector4i& r)
 	}
 }
 
-void GSTextureCache11::Read(Source* t, const GSVector4i& r)
+void GSTextureCache11::DoRead(Source* t, const GSVector4i& r)
 {
 	// FIXME: copy was copyied from openGL. It is unlikely to work.
 
@@ -29,8 +29,8 @@ class GSTextureCache11 : public GSTextureCache
 protected:
 	int Get8bitFormat() {return DXGI_FORMAT_A8_UNORM;}
 
-	void Read(Target* t, const GSVector4i& r);
-	void Read(Source* t, const GSVector4i& r);
+	void DoRead(Target* t, const GSVector4i& r);
+	void DoRead(Source* t, const GSVector4i& r);
 
 public:
 	GSTextureCache11(GSRenderer* r);
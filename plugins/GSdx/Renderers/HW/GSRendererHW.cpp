@@ -1404,6 +1404,19 @@ void GSRendererHW::Draw()
 	// The rectangle of the draw
 	m_r = GSVector4i(m_vt.m_min.p.xyxy(m_vt.m_max.p)).rintersect(GSVector4i(context->scissor.in));
 
+	// Some of the hacks below write the local memory directly instead of drawing, only
+	// the regular path invalidates the texture cache afterwards
+
+	{
+		uint32 pages[MAX_PAGES + 1];
+
+		context->offset.fb->GetPages(m_r, pages);
+		m_mem.BumpPages(pages);
+
+		context->offset.zb->GetPages(m_r, pages);
+		m_mem.BumpPages(pages);
+	}
+
 	if(m_hacks.m_oi && !(this->*m_hacks.m_oi)(rt_tex, ds_tex, m_src))
 	{
 		GL_INS("Warning skipping a draw call (%d)", s_n);
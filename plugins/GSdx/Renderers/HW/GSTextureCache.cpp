@@ -26,10 +26,12 @@
 
 bool GSTextureCache::m_disable_partial_invalidation = false;
 bool GSTextureCache::m_wrap_gs_mem = false;
+GSTextureCache::GenStats GSTextureCache::m_gen_stats;
 
 GSTextureCache::GSTextureCache(GSRenderer* r)
 	: m_renderer(r)
 	, m_palette_map(r)
+	, m_hash_cache(r)
 {
 	if (theApp.GetConfigB("UserHacks")) {
 		UserHacks_HalfPixelOffset      = theApp.GetConfigI("UserHacks_HalfPixelOffset") == 1;
@@ -60,10 +62,21 @@ GSTextureCache::GSTextureCache(GSRenderer* r)
 	m_temp = (uint8*)_aligned_malloc(9 * 1024 * 1024, 32);
 
 	m_texture_inside_rt_cache.reserve(m_texture_inside_rt_cache_size);
+
+	memset(&m_gen_stats, 0, sizeof(m_gen_stats));
 }
 
 GSTextureCache::~GSTextureCache()
 {
+#ifdef _DEBUG
+	fprintf(stderr, "TC: %llu invalidations, %llu source updates skipped, %llu of %llu readbacks skipped\n",
+		m_gen_stats.invalidations, m_gen_stats.updates_skipped,
+		m_gen_stats.readbacks_skipped, m_gen_stats.readbacks + m_gen_stats.readbacks_skipped);
+	if (m_hash_cache.m_enabled)
+		fprintf(stderr, "TC: %llu hash hits, %llu misses, %llu MB of uploads saved\n",
+			m_hash_cache.m_stats.hits, m_hash_cache.m_stats.misses, m_hash_cache.m_stats.bytes_saved >> 20);
+#endif
+
 	RemoveAll();
 
 	m_texture_inside_rt_cache.clear();
@@ -87,6 +100,8 @@ void GSTextureCache::RemoveAll()
 {
 	m_src.RemoveAll();
 
+	m_hash_cache.Clear();
+
 	for(int type = 0; type < 2; type++)
 	{
 		for (auto t : m_dst[type]) delete t;
@@ -606,6 +621,8 @@ GSTextureCache::Target* GSTextureCache::LookupTarget(const GIFRegTEX0& TEX0, int
 		dst->m_used = true;
 	}
 
+	dst->m_readback = false; // about to be drawn to
+
 	return dst;
 }
 
@@ -821,6 +838,10 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 
 	off->GetPages(rect, pages, &r);
 
+	m_renderer->m_mem.BumpPages(pages);
+
+	m_gen_stats.invalidations++;
+
 	bool found = false;
 
 	for(const uint32* p = pages; *p != GSOffset::EOP; p++)
@@ -996,7 +1017,7 @@ void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r)
 			for(auto t : m_dst[DepthStencil]) {
 				if(GSUtil::HasSharedBits(bp, psm, t->m_TEX0.TBP0, t->m_TEX0.PSM)) {
 					if (GSUtil::HasCompatibleBits(psm, t->m_TEX0.PSM))
-						Read(t, r.rintersect(t->m_valid));
+						ReadTarget(t, r.rintersect(t->m_valid));
 				}
 			}
 		}
@@ -1024,12 +1045,12 @@ void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r)
 				// note: r.rintersect breaks Wizardry and Chaos Legion
 				// Read(t, t->m_valid) works in all tested games but is very slow in GUST titles ><
 				if (GSTextureCache::m_disable_partial_invalidation) {
-					Read(t, r.rintersect(t->m_valid));
+					ReadTarget(t, r.rintersect(t->m_valid));
 				} else {
 					if (r.x == 0 && r.y == 0) // Full screen read?
-						Read(t, t->m_valid);
+						ReadTarget(t, t->m_valid);
 					else // Block level read?
-						Read(t, r.rintersect(t->m_valid));
+						ReadTarget(t, r.rintersect(t->m_valid));
 				}
 			}
 		} else {
@@ -1134,6 +1155,58 @@ void GSTextureCache::InvalidateVideoMemSubTarget(GSTextureCache::Target* rt)
 	}
 }
 
+void GSTextureCache::ReadTarget(Target* t, const GSVector4i& r)
+{
+	GSLocalMemory& mem = m_renderer->m_mem;
+
+	uint32 pages[MAX_PAGES / 32];
+
+	mem.GetOffset(t->m_TEX0.TBP0, t->m_TEX0.TBW, t->m_TEX0.PSM)->GetPagesAsBits(r, pages);
+
+	if(t->m_readback && t->m_readback_TEX0 == t->m_TEX0 && t->m_readback_rect.rintersect(r).eq(r) && !mem.PagesChangedSince(pages, t->m_readback_gen))
+	{
+		m_gen_stats.readbacks_skipped++;
+
+		return;
+	}
+
+	Read(t, r);
+
+	t->m_readback = true;
+	t->m_readback_TEX0 = t->m_TEX0;
+	t->m_readback_rect = r;
+	t->m_readback_gen = mem.m_page_gen_last;
+
+	m_gen_stats.readbacks++;
+}
+
+void GSTextureCache::Read(Target* t, const GSVector4i& r)
+{
+	DoRead(t, r);
+
+	BumpPages(t->m_TEX0, r);
+}
+
+void GSTextureCache::Read(Source* t, const GSVector4i& r)
+{
+	DoRead(t, r);
+
+	BumpPages(t->m_TEX0, r);
+}
+
+// a readback wrote these pages of the local memory, sources and targets that synced up with them are stale now
+
+void GSTextureCache::BumpPages(const GIFRegTEX0& TEX0, const GSVector4i& r)
+{
+	GSLocalMemory& mem = m_renderer->m_mem;
+
+	uint32 pages[MAX_PAGES / 32];
+
+	mem.GetOffset(TEX0.TBP0, TEX0.TBW, TEX0.PSM)->GetPagesAsBits(r, pages);
+
+	mem.BumpPagesAsBits(pages);
+}
+
 void GSTextureCache::IncAge()
 {
 	int maxage = m_src.m_used ? 3 : 30;
@@ -1158,6 +1231,8 @@ void GSTextureCache::IncAge()
 
 	m_src.m_used = false;
 
+	m_hash_cache.IncAge();
+
 	// Clearing of Rendertargets causes flickering in many scene transitions.
 	// Sigh, this seems to be used to invalidate surfaces. So set a huge maxage to avoid flicker,
 	// but still invalidate surfaces. (Disgaea 2 fmv when booting the game through the BIOS)
@@ -1522,6 +1597,10 @@ GSTextureCache::Source* GSTextureCache::CreateSource(const GIFRegTEX0& TEX0, con
 				AttachPaletteToSource(src, psm.pal, false);
 			}
 		}
+
+		// Repeating sources upload blocks through the page to tile map, keep them private
+		if (m_hash_cache.m_enabled && !src->m_repeating)
+			src->m_hash_cache = &m_hash_cache;
 	}
 
 	ASSERT(src->m_texture);
@@ -1565,7 +1644,7 @@ void GSTextureCache::PrintMemoryUsage()
 	uint32 rt     = 0;
 	uint32 dss    = 0;
 	for(auto s : m_src.m_surfaces) {
-		if(s && !s->m_shared_texture) {
+		if(s && !s->m_shared_texture && !s->m_hash) {
 			if(s->m_target)
 				tex_rt += s->m_texture->GetMemUsage();
 			else
@@ -1581,7 +1660,12 @@ void GSTextureCache::PrintMemoryUsage()
 			dss += t->m_texture->GetMemUsage();
 	}
 
-	GL_PERF("MEM: RO Tex %dMB. RW Tex %dMB. Target %dMB. Depth %dMB", tex >> 20u, tex_rt >> 20u, rt >> 20u, dss >> 20u);
+	GL_PERF("MEM: RO Tex %dMB. RW Tex %dMB. Target %dMB. Depth %dMB. Hashed Tex %dMB", tex >> 20u, tex_rt >> 20u, rt >> 20u, dss >> 20u,
+		(uint32)(m_hash_cache.GetMemUsage() >> 20u));
+	GL_PERF("TC: %llu invalidations, %llu source updates skipped, %llu readbacks, %llu skipped",
+		m_gen_stats.invalidations, m_gen_stats.updates_skipped, m_gen_stats.readbacks, m_gen_stats.readbacks_skipped);
+	GL_PERF("TC: %llu hash hits, %llu misses, %lluMB of uploads saved",
+		m_hash_cache.m_stats.hits, m_hash_cache.m_stats.misses, m_hash_cache.m_stats.bytes_saved >> 20u);
 #endif
 }
 
@@ -1639,6 +1723,11 @@ GSTextureCache::Source::Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFR
 	, m_p2t(NULL)
 	, m_from_target(NULL)
 	, m_from_target_TEX0(TEX0)
+	, m_pages_as_bit(NULL)
+	, m_update_gen(0)
+	, m_updated(false)
+	, m_hash_cache(NULL)
+	, m_hash(NULL)
 {
 	m_TEX0 = TEX0;
 	m_TEXA = TEXA;
@@ -1674,6 +1763,13 @@ GSTextureCache::Source::Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFR
 GSTextureCache::Source::~Source()
 {
 	_aligned_free(m_write.rect);
+
+	if(m_hash != NULL)
+	{
+		m_hash_cache->Release(m_hash);
+
+		m_texture = NULL; // still owned by the hash cache
+	}
 }
 
 void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
@@ -1697,10 +1793,31 @@ void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
 		m_complete = true; // lame, but better than nothing
 	}
 
+	if(layer == 0 && m_updated && m_update_rect.rintersect(r).eq(r) && !m_renderer->m_mem.PagesChangedSince(m_pages_as_bit, m_update_gen))
+	{
+		m_gen_stats.updates_skipped++;
+
+		return;
+	}
+
 	const GSOffset* off = m_renderer->m_context->offset.tex;
 
 	uint32 blocks = 0;
 
+	// Full requests look for a texture that already holds the same content, the blocks are
+	// then only marked valid. On a miss the texture is registered once it is uploaded.
+	bool upload = true;
+	bool hashed = false;
+	uint64 key[2];
+
+	if(layer == 0 && m_hash_cache != NULL && r.eq(GSVector4i(0, 0, tw, th)))
+	{
+		Hash(off, key);
+
+		upload = !AttachHash(key);
+		hashed = upload;
+	}
+
 	if(m_repeating)
 	{
 		for(int y = r.top; y < r.bottom; y += bs.y)
@@ -1751,7 +1868,10 @@ void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
 					{
 						m_valid[row] |= col;
 
-						Write(GSVector4i(x, y, x + bs.x, y + bs.y), layer);
+						if(upload)
+						{
+							Write(GSVector4i(x, y, x + bs.x, y + bs.y), layer);
+						}
 
 						blocks++;
 					}
@@ -1762,9 +1882,28 @@ void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
 
 	if(blocks > 0)
 	{
-		m_renderer->m_perfmon.Put(GSPerfMon::Unswizzle, bs.x * bs.y * blocks << (m_palette ? 2 : 0));
+		if(upload)
+		{
+			m_renderer->m_perfmon.Put(GSPerfMon::Unswizzle, bs.x * bs.y * blocks << (m_palette ? 2 : 0));
+
+			Flush(m_write.count, layer);
+		}
+		else
+		{
+			m_hash_cache->m_stats.bytes_saved += bs.x * bs.y * blocks << (m_palette ? 0 : 2);
+		}
+	}
 
-		Flush(m_write.count, layer);
+	if(hashed && m_hash == NULL)
+	{
+		m_hash = m_hash_cache->Insert(key, m_texture);
+	}
+
+	if(layer == 0 && m_pages_as_bit != NULL)
+	{
+		m_update_rect = r;
+		m_update_gen = m_renderer->m_mem.m_page_gen_last;
+		m_updated = true;
 	}
 }
 
@@ -1791,6 +1930,11 @@ void GSTextureCache::Source::UpdateLayer(const GIFRegTEX0& TEX0, const GSVector4
 
 void GSTextureCache::Source::Write(const GSVector4i& r, int layer)
 {
+	if(m_hash != NULL)
+	{
+		Detach();
+	}
+
 	m_write.rect[m_write.count++] = r;
 
 	while(m_write.count >= 2)
@@ -1890,6 +2034,118 @@ void GSTextureCache::Source::Flush(uint32 count, int layer)
 	m_write.count -= count;
 }
 
+void GSTextureCache::Source::Hash(const GSOffset* off, uint64* key)
+{
+	const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[m_TEX0.PSM];
+	const GSVector2i& bs = psm.bs;
+
+	int tw = std::max<int>(1 << m_TEX0.TW, bs.x);
+	int th = std::max<int>(1 << m_TEX0.TH, bs.y);
+
+	GSLocalMemory& mem = m_renderer->m_mem;
+
+	// The block order encodes the layout, so TBP0 and TBW are left out and the same
+	// texture uploaded to another address still matches
+
+	key[0] = m_TEX0.PSM | (m_TEX0.TW << 8) | (m_TEX0.TH << 12) | ((m_palette != NULL) << 16);
+	key[1] = 0;
+
+	uint32 i = 0;
+
+	for(int y = 0; y < th; y += bs.y)
+	{
+		uint32 base = off->block.row[y >> 3u];
+
+		for(int x = 0; x < tw; x += bs.x, i++)
+		{
+			uint32 block = base + off->block.col[x >> 3u];
+
+			if(block < MAX_BLOCKS || m_wrap_gs_mem)
+			{
+				GSLocalMemory::HashBlock(key, mem.BlockPtr(block), i);
+			}
+		}
+	}
+
+	if(psm.pal > 0)
+	{
+		// Indices are looked up on the GPU when the source has a palette texture
+		if(m_palette == NULL)
+		{
+			GSLocalMemory::HashBlock(key, m_palette_obj->GetPaletteKey().clut, i, psm.pal * sizeof(uint32));
+		}
+	}
+	else if(psm.fmt > 0)
+	{
+		GSLocalMemory::HashBlock(key, &m_TEXA, i, sizeof(m_TEXA));
+	}
+}
+
+bool GSTextureCache::Source::AttachHash(const uint64* key)
+{
+	HashStats& stats = m_hash_cache->m_stats;
+
+	if(m_hash != NULL && m_hash->key[0] == key[0] && m_hash->key[1] == key[1])
+	{
+		// rewritten with the same data
+		stats.hits++;
+
+		return true;
+	}
+
+	HashEntry* e = m_hash_cache->Lookup(key);
+
+	if(e == NULL)
+	{
+		stats.misses++;
+
+		return false;
+	}
+
+	if(m_hash != NULL)
+	{
+		m_hash_cache->Release(m_hash);
+	}
+	else
+	{
+		m_renderer->m_dev->Recycle(m_texture);
+	}
+
+	m_texture = e->texture;
+	m_hash = e;
+
+	e->refs++;
+
+	// Mipmap layers of the shared texture belong to whoever wrote them
+	memset(m_layer_TEX0, 0, sizeof(m_layer_TEX0));
+
+	stats.hits++;
+
+	return true;
+}
+
+void GSTextureCache::Source::Detach()
+{
+	if(m_hash->refs == 1)
+	{
+		// Last user, the texture simply stops being shared
+		m_hash_cache->Remove(m_hash);
+	}
+	else
+	{
+		// The valid blocks stay valid, they are in the copy
+		GSTexture* t = m_renderer->m_dev->CreateTexture(m_texture->GetWidth(), m_texture->GetHeight(), m_texture->GetFormat());
+
+		m_renderer->m_dev->CopyRect(m_texture, t, GSVector4i(0, 0, t->GetWidth(), t->GetHeight()));
+
+		m_hash_cache->Release(m_hash);
+
+		m_texture = t;
+	}
+
+	m_hash = NULL;
+}
+
 bool GSTextureCache::Source::ClutMatch(PaletteKey palette_key) {
 	return PaletteKeyEqual()(palette_key, m_palette_obj->GetPaletteKey());
 }
@@ -1901,6 +2157,8 @@ GSTextureCache::Target::Target(GSRenderer* r, const GIFRegTEX0& TEX0, uint8* tem
 	, m_type(-1)
 	, m_used(false)
 	, m_depth_supported(depth_supported)
+	, m_readback(false)
+	, m_readback_gen(0)
 {
 	m_TEX0 = TEX0;
 	m_32_bits_fmt |= (GSLocalMemory::m_psm[TEX0.PSM].trbpp != 16);
@@ -1932,6 +2190,8 @@ void GSTextureCache::Target::Update()
 
 	if (r.rempty()) return;
 
+	m_readback = false;
+
 	// No handling please
 	if ((m_type == DepthStencil) && !m_depth_supported) {
 		// do the most likely thing a direct write would do, clear it
@@ -2283,3 +2543,143 @@ void GSTextureCache::PaletteMap::Clear() {
 	}
 }
 
+// GSTextureCache::HashCache
+
+GSTextureCache::HashCache::HashCache(GSRenderer* r)
+	: m_renderer(r)
+	, m_bytes(0)
+{
+	m_enabled = theApp.GetConfigB("texture_hash_dedup");
+	m_budget = (uint64)std::max(theApp.GetConfigI("texture_hash_budget"), 0) << 20;
+
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+GSTextureCache::HashCache::~HashCache()
+{
+	Clear();
+}
+
+GSTextureCache::HashEntry* GSTextureCache::HashCache::Lookup(const uint64* key)
+{
+	auto i = m_map.find(key[0]);
+
+	if(i == m_map.end() || i->second->key[1] != key[1])
+	{
+		return NULL;
+	}
+
+	HashEntry* e = i->second;
+
+	e->age = 0;
+
+	return e;
+}
+
+GSTextureCache::HashEntry* GSTextureCache::HashCache::Insert(const uint64* key, GSTexture* t)
+{
+	if(m_map.find(key[0]) != m_map.end())
+	{
+		// half of the key collides, leave the texture private
+		return NULL;
+	}
+
+	HashEntry* e = new HashEntry();
+
+	e->texture = t;
+	e->key[0] = key[0];
+	e->key[1] = key[1];
+	e->refs = 1;
+	e->bytes = t->GetMemUsage();
+	e->age = 0;
+
+	m_map[key[0]] = e;
+
+	m_bytes += e->bytes;
+
+	Evict();
+
+	return e;
+}
+
+void GSTextureCache::HashCache::Release(HashEntry* e)
+{
+	ASSERT(e->refs > 0);
+
+	// Unreferenced entries are kept for sources created later with the same content
+	if(--e->refs == 0)
+	{
+		e->age = 0;
+	}
+}
+
+void GSTextureCache::HashCache::Remove(HashEntry* e)
+{
+	// The texture goes back to the caller
+	m_map.erase(e->key[0]);
+
+	m_bytes -= e->bytes;
+
+	delete e;
+}
+
+void GSTextureCache::HashCache::IncAge()
+{
+	for(auto& i : m_map)
+	{
+		if(i.second->refs == 0)
+		{
+			i.second->age++;
+		}
+	}
+
+	Evict();
+}
+
+void GSTextureCache::HashCache::Evict()
+{
+	// Oldest unreferenced entries go first, textures in use can't be dropped
+	while(m_bytes > m_budget)
+	{
+		auto oldest = m_map.end();
+
+		for(auto i = m_map.begin(); i != m_map.end(); ++i)
+		{
+			if(i->second->refs == 0 && (oldest == m_map.end() || i->second->age > oldest->second->age))
+			{
+				oldest = i;
+			}
+		}
+
+		if(oldest == m_map.end())
+		{
+			break;
+		}
+
+		HashEntry* e = oldest->second;
+
+		m_renderer->m_dev->Recycle(e->texture);
+
+		m_bytes -= e->bytes;
+
+		m_map.erase(oldest);
+
+		delete e;
+	}
+}
+
+void GSTextureCache::HashCache::Clear()
+{
+	for(auto& i : m_map)
+	{
+		ASSERT(i.second->refs == 0);
+
+		m_renderer->m_dev->Recycle(i.second->texture);
+
+		delete i.second;
+	}
+
+	m_map.clear();
+
+	m_bytes = 0;
+}
@@ -96,6 +96,50 @@ public:
 		bool operator()(const PaletteKey &lhs, const PaletteKey &rhs) const;
 	};
 
+	// Sources with identical local memory content (and CLUT/TEXA where the CPU expands them)
+	// share one texture. Entries outlive their sources until the memory budget evicts them.
+	struct HashEntry
+	{
+		GSTexture* texture;
+		uint64 key[2];
+		uint32 refs;
+		uint32 bytes;
+		uint32 age;
+	};
+
+	struct HashStats
+	{
+		uint64 hits;
+		uint64 misses;
+		uint64 bytes_saved;
+	};
+
+	class HashCache
+	{
+		GSRenderer* m_renderer;
+		std::unordered_map<uint64, HashEntry*> m_map;
+		uint64 m_bytes;
+		uint64 m_budget;
+
+		void Evict();
+
+	public:
+		bool m_enabled;
+		HashStats m_stats;
+
+		HashCache(GSRenderer* r);
+		~HashCache();
+
+		HashEntry* Lookup(const uint64* key);
+		HashEntry* Insert(const uint64* key, GSTexture* t);
+		void Release(HashEntry* e);
+		void Remove(HashEntry* e);
+		void IncAge();
+		void Clear();
+
+		uint64 GetMemUsage() const {return m_bytes;}
+	};
+
 	class Source : public Surface
 	{
 		struct {GSVector4i* rect; uint32 count;} m_write;
@@ -103,6 +147,10 @@ public:
 		void Write(const GSVector4i& r, int layer);
 		void Flush(uint32 count, int layer);
 
+		void Hash(const GSOffset* off, uint64* key);
+		bool AttachHash(const uint64* key);
+		void Detach();
+
 	public:
 		std::shared_ptr<Palette> m_palette_obj;
 		GSTexture* m_palette;
@@ -121,6 +169,14 @@ public:
 		// Keep a GSTextureCache::SourceMap::m_map iterator to allow fast erase
 		std::array<uint16, MAX_PAGES> m_erase_it;
 		uint32* m_pages_as_bit;
+		// Rectangle of the last layer 0 update and the page generation it saw, nothing to do
+		// while the pages are unchanged and the requests stay inside
+		GSVector4i m_update_rect;
+		uint32 m_update_gen;
+		bool m_updated;
+		// Content-shared texture, m_texture belongs to m_hash while it is set
+		HashCache* m_hash_cache;
+		HashEntry* m_hash;
 
 	public:
 		Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint8* temp, bool dummy_container = false);
@@ -141,6 +197,12 @@ public:
 		GSVector4i m_valid;
 		bool m_depth_supported;
 		bool m_dirty_alpha;
+		// Local memory already holds m_readback_rect of the target if none of its pages changed since
+		// m_readback_gen and the target was not drawn to (see LookupTarget)
+		bool m_readback;
+		GIFRegTEX0 m_readback_TEX0;
+		GSVector4i m_readback_rect;
+		uint32 m_readback_gen;
 
 	public:
 		Target(GSRenderer* r, const GIFRegTEX0& TEX0, uint8* temp, bool depth_supported);
@@ -186,6 +248,14 @@ public:
 		void RemoveAt(Source* s);
 	};
 
+	struct GenStats
+	{
+		uint64 invalidations;
+		uint64 updates_skipped;
+		uint64 readbacks;
+		uint64 readbacks_skipped;
+	};
+
 	struct TexInsideRtCacheEntry
 	{
 		uint32 psm;
@@ -203,6 +273,7 @@ protected:
 	GSRenderer* m_renderer;
 	PaletteMap m_palette_map;
 	SourceMap m_src;
+	HashCache m_hash_cache;
 	FastList<Target*> m_dst[2];
 	bool m_paltex;
 	bool m_preload_frame;
@@ -213,6 +284,7 @@ protected:
 	static bool m_disable_partial_invalidation;
 	bool m_texture_inside_rt;
 	static bool m_wrap_gs_mem;
+	static GenStats m_gen_stats;
 	uint8 m_texture_inside_rt_cache_size = 255;
 	std::vector<TexInsideRtCacheEntry> m_texture_inside_rt_cache;
 
@@ -221,14 +293,20 @@ protected:
 
 	virtual int Get8bitFormat() = 0;
 
+	void ReadTarget(Target* t, const GSVector4i& r);
+	void BumpPages(const GIFRegTEX0& TEX0, const GSVector4i& r);
+
+	virtual void DoRead(Target* t, const GSVector4i& r) = 0;
+	virtual void DoRead(Source* t, const GSVector4i& r) = 0;
+
 	// TODO: virtual void Write(Source* s, const GSVector4i& r) = 0;
 	// TODO: virtual void Write(Target* t, const GSVector4i& r) = 0;
 
 public:
 	GSTextureCache(GSRenderer* r);
 	virtual ~GSTextureCache();
-	virtual void Read(Target* t, const GSVector4i& r) = 0;
-	virtual void Read(Source* t, const GSVector4i& r) = 0;
+	void Read(Target* t, const GSVector4i& r);
+	void Read(Source* t, const GSVector4i& r);
 	void RemoveAll();
 	void RemovePartial();
 
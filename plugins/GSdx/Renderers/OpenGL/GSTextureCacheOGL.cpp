@@ -28,7 +28,7 @@ GSTextureCacheOGL::GSTextureCacheOGL(GSRenderer* r)
 {
 }
 
-void GSTextureCacheOGL::Read(Target* t, const GSVector4i& r)
+void GSTextureCacheOGL::DoRead(Target* t, const GSVector4i& r)
 {
 	if (!t->m_dirty.empty() || r.width() == 0 || r.height() == 0)
 		return;
@@ -116,7 +116,7 @@ void GSTextureCacheOGL::Read(Target* t, const GSVector4i& r)
 	}
 }
 
-void GSTextureCacheOGL::Read(Source* t, const GSVector4i& r)
+void GSTextureCacheOGL::DoRead(Source* t, const GSVector4i& r)
 {
 	const GIFRegTEX0& TEX0 = t->m_TEX0;
 
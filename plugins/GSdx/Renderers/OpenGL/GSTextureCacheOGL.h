@@ -30,8 +30,8 @@ class GSTextureCacheOGL final : public GSTextureCache
 protected:
 	int Get8bitFormat() { return GL_R8;}
 
-	void Read(Target* t, const GSVector4i& r);
-	void Read(Source* t, const GSVector4i& r);
+	void DoRead(Target* t, const GSVector4i& r);
+	void DoRead(Source* t, const GSVector4i& r);
 
 public:
 	GSTextureCacheOGL(GSRenderer* r);
@@ -0,0 +1,401 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "stdafx.h"
+#include "GSDeviceSW.h"
+#include <libretro.h>
+
+extern retro_video_refresh_t video_cb;
+extern retro_environment_t environ_cb;
+
+// alpha: weight of src in 0..256, or < 0 for 2 * As like the merge shader (0x80 is opaque)
+// amod: keep the alpha of dst
+
+static __forceinline GSVector4i Blend4(const GSVector4i& s, const GSVector4i& d, const GSVector4i& a, bool src_alpha, const GSVector4i& mask)
+{
+	const GSVector4i one = GSVector4i::x0001().sll16(8);
+
+	GSVector4i sl = s.upl8();
+	GSVector4i sh = s.uph8();
+	GSVector4i dl = d.upl8();
+	GSVector4i dh = d.uph8();
+
+	GSVector4i al = a;
+	GSVector4i ah = a;
+
+	if(src_alpha)
+	{
+		al = sl.wwwwlh().sll16(1).min_i16(one);
+		ah = sh.wwwwlh().sll16(1).min_i16(one);
+	}
+
+	sl = sl.mul16l(al).add16(dl.mul16l(one.sub16(al))).srl16(8);
+	sh = sh.mul16l(ah).add16(dh.mul16l(one.sub16(ah))).srl16(8);
+
+	return sl.pu16(sh).blend(d, mask);
+}
+
+static void BlendLine(uint32* RESTRICT dst, const uint32* RESTRICT src, int n, int alpha, bool amod)
+{
+	if(alpha >= 256 && !amod)
+	{
+		memcpy(dst, src, n * sizeof(uint32));
+
+		return;
+	}
+
+	GSVector4i a = GSVector4i::load(std::max<int>(alpha, 0)).xxxxl().xxxx();
+	GSVector4i mask = amod ? GSVector4i::xff000000() : GSVector4i::zero();
+
+	int i = 0;
+
+	for(; i + 4 <= n; i += 4)
+	{
+		GSVector4i s = GSVector4i::load<false>(&src[i]);
+		GSVector4i d = GSVector4i::load<false>(&dst[i]);
+
+		GSVector4i::store<false>(&dst[i], Blend4(s, d, a, alpha < 0, mask));
+	}
+
+	if(i < n)
+	{
+		GSVector4i s = GSVector4i::zero();
+		GSVector4i d = GSVector4i::zero();
+
+		memcpy(&s, &src[i], (n - i) * sizeof(uint32));
+		memcpy(&d, &dst[i], (n - i) * sizeof(uint32));
+
+		d = Blend4(s, d, a, alpha < 0, mask);
+
+		memcpy(&dst[i], &d, (n - i) * sizeof(uint32));
+	}
+}
+
+// (c0 + 2 * c1 + c2) / 4
+
+static void BlurLine(uint32* RESTRICT dst, const uint32* c0, const uint32* c1, const uint32* c2, int n)
+{
+	int i = 0;
+
+	for(; i + 4 <= n; i += 4)
+	{
+		GSVector4i a = GSVector4i::load<false>(&c0[i]);
+		GSVector4i b = GSVector4i::load<false>(&c1[i]);
+		GSVector4i c = GSVector4i::load<false>(&c2[i]);
+
+		GSVector4i::store<false>(&dst[i], a.avg8(c).avg8(b));
+	}
+
+	for(; i < n; i++)
+	{
+		GSVector4i a = GSVector4i::load((int)c0[i]);
+		GSVector4i b = GSVector4i::load((int)c1[i]);
+		GSVector4i c = GSVector4i::load((int)c2[i]);
+
+		dst[i] = (uint32)GSVector4i::store(a.avg8(c).avg8(b));
+	}
+}
+
+bool GSDeviceSW::Create(const std::shared_ptr<GSWnd> &wnd)
+{
+	if(!GSDevice::Create(wnd))
+		return false;
+
+	Reset(1, 1);
+
+	return true;
+}
+
+bool GSDeviceSW::Reset(int w, int h)
+{
+	return GSDevice::Reset(w, h);
+}
+
+GSTexture* GSDeviceSW::CreateSurface(int type, int w, int h, int format)
+{
+	// always 32-bit, formats are only meaningful to the hw renderers
+
+	return new GSTextureSW(type, w, h);
+}
+
+void GSDeviceSW::Present(const GSVector4i& r, int shader)
+{
+	// The frontend scales the frame, so it is presented at the merged size and the
+	// post shaders are ignored. Writes go straight to the frontend's buffer when it
+	// lends one in our format, otherwise to m_output.
+
+	GSTexture::GSMap sm;
+
+	if(m_current == NULL || !m_current->Map(sm))
+	{
+		Flip();
+
+		return;
+	}
+
+	int w = m_current->GetWidth();
+	int h = m_current->GetHeight();
+
+	retro_framebuffer fb = {};
+
+	fb.width = w;
+	fb.height = h;
+	fb.access_flags = RETRO_MEMORY_ACCESS_WRITE;
+
+	uint8* bits;
+	size_t pitch;
+
+	if(environ_cb(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER, &fb) && fb.data != NULL
+	&& fb.format == RETRO_PIXEL_FORMAT_XRGB8888 && (int)fb.width == w && (int)fb.height == h)
+	{
+		bits = (uint8*)fb.data;
+		pitch = fb.pitch;
+	}
+	else
+	{
+		m_output.resize(w * h);
+
+		bits = (uint8*)m_output.data();
+		pitch = w * sizeof(uint32);
+	}
+
+	// RGBA8 in memory => 0x00RRGGBB
+
+	for(int y = 0; y < h; y++)
+	{
+		const uint32* RESTRICT src = (const uint32*)(sm.bits + y * sm.pitch);
+		uint32* RESTRICT dst = (uint32*)(bits + y * pitch);
+
+		int x = 0;
+
+		for(; x + 4 <= w; x += 4)
+		{
+			GSVector4i c = GSVector4i::load<false>(&src[x]);
+
+			c = c.sll32(24).srl32(8) | c.srl32(8).sll32(24).srl32(16) | c.sll32(8).srl32(24);
+
+			GSVector4i::store<false>(&dst[x], c);
+		}
+
+		for(; x < w; x++)
+		{
+			uint32 c = src[x];
+
+			dst[x] = ((c & 0xff) << 16) | (c & 0xff00) | ((c >> 16) & 0xff);
+		}
+	}
+
+	m_current->Unmap();
+
+	video_cb(bits, w, h, pitch);
+}
+
+void GSDeviceSW::ClearRenderTarget(GSTexture* t, const GSVector4& c)
+{
+	ClearRenderTarget(t, GSVector4i(c * GSVector4(255.0f), false).rgba32());
+}
+
+void GSDeviceSW::ClearRenderTarget(GSTexture* t, uint32 c)
+{
+	GSTexture::GSMap m;
+
+	if(t->Map(m))
+	{
+		int w = t->GetWidth();
+		int h = t->GetHeight();
+
+		GSVector4i v = GSVector4i::load((int)c).xxxx();
+
+		for(int y = 0; y < h; y++)
+		{
+			uint32* RESTRICT dst = (uint32*)(m.bits + y * m.pitch);
+
+			int x = 0;
+
+			for(; x + 4 <= w; x += 4)
+			{
+				GSVector4i::store<false>(&dst[x], v);
+			}
+
+			for(; x < w; x++)
+			{
+				dst[x] = c;
+			}
+		}
+
+		t->Unmap();
+	}
+}
+
+void GSDeviceSW::Blend(GSTexture* sTex, const GSVector4& sRect, GSTexture::GSMap& dm, const GSVector2i& ds, const GSVector4& dRect, int alpha, bool amod)
+{
+	// Point sampled like StretchRect with the source clamped to its edges. The merge
+	// rectangles are nearly always 1:1, then the source rows are blended in place.
+
+	GSVector4i dr = GSVector4i(dRect, false).rintersect(GSVector4i(0, 0, ds.x, ds.y));
+
+	if(dr.rempty())
+		return;
+
+	GSTexture::GSMap sm;
+
+	if(!sTex->Map(sm))
+		return;
+
+	GSVector2i ss = sTex->GetSize();
+	GSVector4 sr = sRect * GSVector4(ss).xyxy();
+
+	float sx = (sr.z - sr.x) / (dRect.z - dRect.x);
+	float sy = (sr.w - sr.y) / (dRect.w - dRect.y);
+
+	int w = dr.width();
+	int x0 = (int)(sr.x + (dr.left + 0.5f - dRect.x) * sx);
+
+	bool direct = sx == 1.0f && x0 >= 0 && x0 + w <= ss.x;
+
+	if(!direct)
+	{
+		m_line.resize(w);
+	}
+
+	for(int y = dr.top; y < dr.bottom; y++)
+	{
+		int ys = std::min<int>(std::max<int>((int)(sr.y + (y + 0.5f - dRect.y) * sy), 0), ss.y - 1);
+
+		const uint32* src = (const uint32*)(sm.bits + ys * sm.pitch);
+		uint32* dst = (uint32*)(dm.bits + y * dm.pitch) + dr.left;
+
+		if(direct)
+		{
+			src += x0;
+		}
+		else
+		{
+			for(int x = 0; x < w; x++)
+			{
+				int xs = std::min<int>(std::max<int>((int)(sr.x + (dr.left + x + 0.5f - dRect.x) * sx), 0), ss.x - 1);
+
+				m_line[x] = src[xs];
+			}
+
+			src = m_line.data();
+		}
+
+		BlendLine(dst, src, w, alpha, amod);
+	}
+
+	sTex->Unmap();
+}
+
+void GSDeviceSW::DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex, GSVector4* dRect, const GSRegPMODE& PMODE, const GSRegEXTBUF& EXTBUF, const GSVector4& c)
+{
+	// Same order as the gpu devices: background color, 2nd output, 1st output blended on top.
+	// The feedback write (EXTBUF) is not emulated.
+
+	ClearRenderTarget(dTex, c);
+
+	GSTexture::GSMap dm;
+
+	if(!dTex->Map(dm))
+		return;
+
+	GSVector2i ds = dTex->GetSize();
+
+	if(sTex[1] && PMODE.SLBG == 0)
+	{
+		Blend(sTex[1], sRect[1], dm, ds, dRect[1], 256, false);
+	}
+
+	if(sTex[0])
+	{
+		// MMOD = 1 blends with the constant ALP (0xff is opaque), otherwise with the 1st output's alpha
+
+		int alpha = PMODE.MMOD == 1 ? PMODE.ALP + (PMODE.ALP >> 7) : -1;
+
+		Blend(sTex[0], sRect[0], dm, ds, dRect[0], alpha, PMODE.AMOD == 1);
+	}
+
+	dTex->Unmap();
+}
+
+void GSDeviceSW::DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset)
+{
+	// Mirrors the interlace shaders: 0/1 weave the odd/even lines over the previous field,
+	// 2 blends 3 lines, 3 stretches the field to the full height shifted by yoffset (bob).
+
+	GSTexture::GSMap sm, dm;
+
+	if(!sTex->Map(sm))
+		return;
+
+	if(!dTex->Map(dm))
+	{
+		sTex->Unmap();
+
+		return;
+	}
+
+	GSVector2i ss = sTex->GetSize();
+	GSVector2i ds = dTex->GetSize();
+
+	int w = std::min(ss.x, ds.x);
+	int yo = (int)yoffset;
+
+	auto row = [&](int y) -> const uint32*
+	{
+		return (const uint32*)(sm.bits + std::min<int>(std::max<int>(y, 0), ss.y - 1) * sm.pitch);
+	};
+
+	for(int y = 0; y < ds.y; y++)
+	{
+		uint32* dst = (uint32*)(dm.bits + y * dm.pitch);
+
+		switch(shader)
+		{
+		case 0:
+		case 1:
+			if((y & 1) == shader) continue;
+			memcpy(dst, row((2 * y + 1) * ss.y / (2 * ds.y)), w * sizeof(uint32));
+			break;
+		case 2:
+			BlurLine(dst, row(y - 1), row(y), row(y + 1), w);
+			break;
+		default:
+			if(y < yo) continue;
+			if(linear)
+			{
+				int f = (2 * (y - yo) + 1) * ss.y * 128 / ds.y - 128; // .8 fixed point, texel centers
+
+				memcpy(dst, row(f >> 8), w * sizeof(uint32));
+
+				if(f & 255) BlendLine(dst, row((f >> 8) + 1), w, f & 255, false);
+			}
+			else
+			{
+				memcpy(dst, row((2 * (y - yo) + 1) * ss.y / (2 * ds.y)), w * sizeof(uint32));
+			}
+			break;
+		}
+	}
+
+	dTex->Unmap();
+	sTex->Unmap();
+}
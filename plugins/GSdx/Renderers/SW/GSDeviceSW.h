@@ -0,0 +1,52 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "Renderers/Common/GSDevice.h"
+#include "GSTextureSW.h"
+
+// CPU only device for the software renderer: surfaces live in system memory, merge and
+// interlace run on the CPU and the frame is handed to the frontend as XRGB8888.
+
+class GSDeviceSW final : public GSDevice
+{
+	std::vector<uint32> m_line;
+	std::vector<uint32> m_output;
+
+	GSTexture* CreateSurface(int type, int w, int h, int format);
+
+	void DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex, GSVector4* dRect, const GSRegPMODE& PMODE, const GSRegEXTBUF& EXTBUF, const GSVector4& c);
+	void DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset = 0);
+	uint16 ConvertBlendEnum(uint16 generic) { return 0xFFFF; }
+
+	void Blend(GSTexture* sTex, const GSVector4& sRect, GSTexture::GSMap& dm, const GSVector2i& ds, const GSVector4& dRect, int alpha, bool amod);
+
+public:
+	GSDeviceSW() {}
+
+	bool Create(const std::shared_ptr<GSWnd> &wnd);
+	bool Reset(int w, int h);
+	void Present(const GSVector4i& r, int shader);
+
+	void ClearRenderTarget(GSTexture* t, const GSVector4& c);
+	void ClearRenderTarget(GSTexture* t, uint32 c);
+};
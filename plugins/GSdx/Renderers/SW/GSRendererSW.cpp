@@ -38,10 +38,14 @@ void GSRendererSW::InitVectors()
 
 GSRendererSW::GSRendererSW(int threads)
 	: m_fzb(NULL)
+	, m_draw_seq(0)
+	, m_draw_queued(0)
+	, m_draw_done(0)
+	, m_sync_stats_frames(0)
 {
 	m_nativeres = true; // ignore ini, sw is always native
 
-	m_tc = new GSTextureCacheSW(this);
+	m_tc = new GSTextureCacheSW(this, threads);
 
 	memset(m_texture, 0, sizeof(m_texture));
 
@@ -49,13 +53,16 @@ GSRendererSW::GSRendererSW(int threads)
 
 	m_output = (uint8*)_aligned_malloc(1024 * 1024 * sizeof(uint32), 32);
 
-	for (uint32 i = 0; i < countof(m_fzb_pages); i++) {
-		m_fzb_pages[i] = 0;
-	}
-	for (uint32 i = 0; i < countof(m_tex_pages); i++) {
-		m_tex_pages[i] = 0;
+	memset(m_page_seq, 0, sizeof(m_page_seq));
+
+	for (uint32 i = 0; i < countof(m_draw_complete); i++) {
+		m_draw_complete[i] = 0;
 	}
 
+	m_print_sync_stats = theApp.GetConfigB("sync_stats");
+
+	memset(&m_sync_stats, 0, sizeof(m_sync_stats));
+
 	#define InitCVB2(P, Q) \
 		m_cvb[P][0][0][Q] = &GSRendererSW::ConvertVertexBuffer<P, 0, 0, Q>; \
 		m_cvb[P][0][1][Q] = &GSRendererSW::ConvertVertexBuffer<P, 0, 1, Q>; \
@@ -127,6 +134,16 @@ void GSRendererSW::VSync(int field)
 
 	m_tc->IncAge();
 
+	if(m_print_sync_stats && ++m_sync_stats_frames == 60)
+	{
+		printf("GSdx: %.1f full syncs/frame, %.1f partial waits/frame\n",
+			(float)m_sync_stats.syncs / m_sync_stats_frames, (float)m_sync_stats.waits / m_sync_stats_frames);
+
+		memset(&m_sync_stats, 0, sizeof(m_sync_stats));
+
+		m_sync_stats_frames = 0;
+	}
+
 	// if((m_perfmon.GetFrame() & 255) == 0) m_rl->PrintStats();
 }
 
@@ -159,9 +176,26 @@ GSTexture* GSRendererSW::GetOutput(int i, int& y_offset)
 
 		const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[DISPFB.PSM];
 
-		(m_mem.*psm.rtx)(m_mem.GetOffset(DISPFB.Block(), DISPFB.FBW, DISPFB.PSM), r.ralign<Align_Outside>(psm.bs), m_output, pitch, m_env.TEXA);
+		const GSOffset* off = m_mem.GetOffset(DISPFB.Block(), DISPFB.FBW, DISPFB.PSM);
+
+		GSVector4i ra = r.ralign<Align_Outside>(psm.bs);
+
+		GSTexture::GSMap m;
+
+		// read straight into the texture if it can be mapped (system memory with GSDeviceSW)
+
+		if(ra.eq(r) && m_texture[i]->Map(m, &r))
+		{
+			(m_mem.*psm.rtx)(off, r, m.bits, m.pitch, m_env.TEXA);
+
+			m_texture[i]->Unmap();
+		}
+		else
+		{
+			(m_mem.*psm.rtx)(off, ra, m_output, pitch, m_env.TEXA);
 
-		m_texture[i]->Update(r, m_output, pitch);
+			m_texture[i]->Update(r, m_output, pitch);
+		}
 	}
 
 	return m_texture[i];
@@ -421,17 +455,11 @@ void GSRendererSW::Draw()
 
 	// check if there is an overlap between this and previous targets
 
-	if(CheckTargetPages(fb_pages, zb_pages, r))
-	{
-		sd->m_syncpoint = SharedData::SyncTarget;
-	}
+	sd->m_sync_target = CheckTargetPages(fb_pages, zb_pages, r);
 
 	// check if the texture is not part of a target currently in use
 
-	if(CheckSourcePages(sd))
-	{
-		sd->m_syncpoint = SharedData::SyncSource;
-	}
+	sd->m_sync_source = CheckSourcePages(sd);
 
 	// addref source and target pages
 
@@ -448,22 +476,24 @@ void GSRendererSW::Queue(std::shared_ptr<GSRasterizerData>& item)
 {
 	SharedData* sd = (SharedData*)item.get();
 
-	if(sd->m_syncpoint == SharedData::SyncSource) 
+	if(sd->m_sync_source)
 	{
-		Sync(4);
+		Wait(std::max(sd->m_sync_source, sd->m_sync_target), 4);
 	}
 
 	// update previously invalidated parts
 
 	sd->UpdateSource();
 
-	if(sd->m_syncpoint == SharedData::SyncTarget)
+	if(sd->m_sync_target)
 	{
-		Sync(5);
+		Wait(sd->m_sync_target, 5);
 	}
 
 	m_rl->Queue(item);
 
+	m_draw_queued = sd->m_seq;
+
 	// invalidate new parts rendered onto
 
 	if(sd->global.sel.fwrite)
@@ -487,8 +517,20 @@ void GSRendererSW::Sync(int reason)
 
 	uint64 t = __rdtsc();
 
+	UpdateDrawDone();
+
+	if(m_draw_done != m_draw_queued)
+	{
+		m_sync_stats.syncs++;
+	}
+
 	m_rl->Sync();
 
+	// the workers drop their references before their queues look empty
+	UpdateDrawDone();
+
+	ASSERT(m_draw_done == m_draw_queued);
+
 	t = __rdtsc() - t;
 
 	int pixels = m_rl->GetPixels();
@@ -496,6 +538,68 @@ void GSRendererSW::Sync(int reason)
 	m_perfmon.Put(GSPerfMon::Fillrate, pixels);
 }
 
+void GSRendererSW::Wait(uint64 seq, int reason)
+{
+	UpdateDrawDone();
+
+	if(seq <= m_draw_done)
+	{
+		return;
+	}
+
+	if(seq >= m_draw_queued)
+	{
+		// nothing queued after it, as good as draining the workers
+
+		Sync(reason);
+
+		return;
+	}
+
+	GSPerfMonAutoTimer pmat(&m_perfmon, GSPerfMon::Sync);
+
+	do
+	{
+		std::this_thread::yield();
+
+		UpdateDrawDone();
+	}
+	while(seq > m_draw_done);
+
+	m_perfmon.Put(GSPerfMon::SyncWait, 1);
+
+	m_sync_stats.waits++;
+}
+
+void GSRendererSW::UpdateDrawDone()
+{
+	while(m_draw_done < m_draw_queued)
+	{
+		std::atomic<uint8>& complete = m_draw_complete[(m_draw_done + 1) & (DRAW_RING - 1)];
+
+		if(complete.load(std::memory_order_acquire) == 0)
+		{
+			break;
+		}
+
+		complete.store(0, std::memory_order_relaxed);
+
+		m_draw_done++;
+	}
+}
+
+uint64 GSRendererSW::NextDrawSeq()
+{
+	// the ring must not wrap onto a draw still in flight
+
+	if(m_draw_seq + 1 - m_draw_done >= DRAW_RING)
+	{
+		Sync(8);
+	}
+
+	return ++m_draw_seq;
+}
+
 void GSRendererSW::InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r)
 {
 	GSOffset* off = m_mem.GetOffset(BITBLTBUF.DBP, BITBLTBUF.DBW, BITBLTBUF.DPSM);
@@ -504,17 +608,18 @@ void GSRendererSW::InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 
 	// check if the changing pages either used as a texture or a target
 
-	if(!m_rl->IsSynced())
+	UpdateDrawDone();
+
+	if(m_draw_done != m_draw_queued)
 	{
+		uint64 seq = 0;
+
 		for(uint32* RESTRICT p = m_tmp_pages; *p != GSOffset::EOP; p++)
 		{
-			if(m_fzb_pages[*p] | m_tex_pages[*p])
-			{
-				Sync(6);
-
-				break;
-			}
+			seq = std::max({seq, m_page_seq[0][*p], m_page_seq[1][*p], m_page_seq[2][*p]});
 		}
+
+		Wait(seq, 6);
 	}
 
 	m_tc->InvalidatePages(m_tmp_pages, off->psm); // if texture update runs on a thread and Sync(5) happens then this must come later
@@ -522,74 +627,47 @@ void GSRendererSW::InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 
 void GSRendererSW::InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut)
 {
-	if(!m_rl->IsSynced())
+	UpdateDrawDone();
+
+	if(m_draw_done != m_draw_queued)
 	{
 		GSOffset* off = m_mem.GetOffset(BITBLTBUF.SBP, BITBLTBUF.SBW, BITBLTBUF.SPSM);
 
 		off->GetPages(r, m_tmp_pages);
 
+		uint64 seq = 0;
+
 		for(uint32* RESTRICT p = m_tmp_pages; *p != GSOffset::EOP; p++)
 		{
-			if(m_fzb_pages[*p])
-			{
-				Sync(7);
-
-				break;
-			}
+			seq = std::max({seq, m_page_seq[0][*p], m_page_seq[1][*p]});
 		}
+
+		Wait(seq, 7);
 	}
 }
 
 void GSRendererSW::UsePages(const uint32* pages, const int type)
 {
-	for(const uint32* p = pages; *p != GSOffset::EOP; p++) {
-		switch (type) {
-			case 0:
-				ASSERT((m_fzb_pages[*p] & 0xFFFF) < USHRT_MAX);
-				m_fzb_pages[*p] += 1;
-				break;
-			case 1:
-				ASSERT((m_fzb_pages[*p] >> 16) < USHRT_MAX);
-				m_fzb_pages[*p] += 0x10000;
-				break;
-			case 2:
-				ASSERT(m_tex_pages[*p] < USHRT_MAX);
-				m_tex_pages[*p] += 1;
-				break;
-			default:break;
-		}
-	}
-}
+	ASSERT(type >= 0 && type < 3);
 
-void GSRendererSW::ReleasePages(const uint32* pages, const int type)
-{
-	for(const uint32* p = pages; *p != GSOffset::EOP; p++) {
-		switch (type) {
-			case 0:
-				ASSERT((m_fzb_pages[*p] & 0xFFFF) > 0);
-				m_fzb_pages[*p] -= 1;
-				break;
-			case 1:
-				ASSERT((m_fzb_pages[*p] >> 16) > 0);
-				m_fzb_pages[*p] -= 0x10000;
-				break;
-			case 2:
-				ASSERT(m_tex_pages[*p] > 0);
-				m_tex_pages[*p] -= 1;
-				break;
-			default:break;
-		}
+	uint64* RESTRICT seq = m_page_seq[type];
+
+	for(const uint32* p = pages; *p != GSOffset::EOP; p++)
+	{
+		seq[*p] = m_draw_seq;
 	}
 }
 
-bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pages, const GSVector4i& r)
+uint64 GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pages, const GSVector4i& r)
 {
-	bool synced = m_rl->IsSynced();
+	UpdateDrawDone();
+
+	bool synced = m_draw_done == m_draw_queued;
 
 	bool fb = fb_pages != NULL;
 	bool zb = zb_pages != NULL;
 
-	bool res = false;
+	uint64 res = 0;
 
 	if(m_fzb != m_context->offset.fzb4)
 	{
@@ -603,7 +681,7 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 
 		memset(m_fzb_cur_pages, 0, sizeof(m_fzb_cur_pages));
 
-		uint32 used = 0;
+		uint64 used = 0;
 
 		for(const uint32* p = fb_pages; *p != GSOffset::EOP; p++)
 		{
@@ -614,8 +692,7 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 
 			m_fzb_cur_pages[row] |= col;
 
-			used |= m_fzb_pages[i];
-			used |= m_tex_pages[i];
+			used = std::max({used, m_page_seq[0][i], m_page_seq[1][i], m_page_seq[2][i]});
 		}
 
 		for(const uint32* p = zb_pages; *p != GSOffset::EOP; p++)
@@ -627,14 +704,12 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 
 			m_fzb_cur_pages[row] |= col;
 
-			used |= m_fzb_pages[i];
-			used |= m_tex_pages[i];
+			used = std::max({used, m_page_seq[0][i], m_page_seq[1][i], m_page_seq[2][i]});
 		}
 
 		if(!synced)
 		{
-			if(used)
-				res = true;
+			res = used;
 		}
 	}
 	else
@@ -654,7 +729,7 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 			if(fb_pages == NULL) fb_pages = m_context->offset.fb->GetPages(r);
 			if(zb_pages == NULL) zb_pages = m_context->offset.zb->GetPages(r);
 
-			uint32 used = 0;
+			uint64 used = 0;
 
 			for(const uint32* p = fb_pages; *p != GSOffset::EOP; p++)
 			{
@@ -667,7 +742,7 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 				{
 					m_fzb_cur_pages[row] |= col;
 
-					used |= m_fzb_pages[i];
+					used = std::max({used, m_page_seq[0][i], m_page_seq[1][i]});
 				}
 			}
 
@@ -682,14 +757,13 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 				{
 					m_fzb_cur_pages[row] |= col;
 
-					used |= m_fzb_pages[i];
+					used = std::max({used, m_page_seq[0][i], m_page_seq[1][i]});
 				}
 			}
 
 			if(!synced)
 			{
-				if(used)
-					res = true;
+				res = used;
 			}
 		}
 
@@ -698,28 +772,19 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 			// chross-check frame and z-buffer pages, they cannot overlap with eachother and with previous batches in queue,
 			// have to be careful when the two buffers are mutually enabled/disabled and alternating (Bully FBP/ZBP = 0x2300)
 
-			if(fb && !res)
+			if(fb)
 			{
 				for(const uint32* p = fb_pages; *p != GSOffset::EOP; p++)
 				{
-					if(m_fzb_pages[*p] & 0xffff0000)
-					{
-						res = true;
-						break;
-					}
+					res = std::max(res, m_page_seq[1][*p]);
 				}
 			}
 
-			if(zb && !res)
+			if(zb)
 			{
 				for(const uint32* p = zb_pages; *p != GSOffset::EOP; p++)
 				{
-					if(m_fzb_pages[*p] & 0x0000ffff)
-					{
-						res = true;
-
-						break;
-					}
+					res = std::max(res, m_page_seq[0][*p]);
 				}
 			}
 		}
@@ -728,12 +793,14 @@ bool GSRendererSW::CheckTargetPages(const uint32* fb_pages, const uint32* zb_pag
 	if(!fb && fb_pages != NULL) delete [] fb_pages;
 	if(!zb && zb_pages != NULL) delete [] zb_pages;
 
-	return res;
+	return res > m_draw_done ? res : 0;
 }
 
-bool GSRendererSW::CheckSourcePages(SharedData* sd)
+uint64 GSRendererSW::CheckSourcePages(SharedData* sd)
 {
-	if(!m_rl->IsSynced())
+	uint64 res = 0;
+
+	if(m_draw_done != m_draw_queued)
 	{
 		for(size_t i = 0; sd->m_tex[i].t != NULL; i++)
 		{
@@ -745,15 +812,12 @@ bool GSRendererSW::CheckSourcePages(SharedData* sd)
 			{
 				// TODO: 8H 4HL 4HH texture at the same place as the render target (24 bit, or 32-bit where the alpha channel is masked, Valkyrie Profile 2)
 
-				if(m_fzb_pages[*p]) // currently being drawn to? => sync
-				{
-					return true;
-				}
+				res = std::max({res, m_page_seq[0][*p], m_page_seq[1][*p]}); // currently being drawn to? => wait
 			}
 		}
 	}
 
-	return false;
+	return res > m_draw_done ? res : 0;
 }
 
 #include "GSTextureSW.h"
@@ -1233,7 +1297,9 @@ GSRendererSW::SharedData::SharedData(GSRendererSW* parent)
 	, m_fpsm(0)
 	, m_zpsm(0)
 	, m_using_pages(false)
-	, m_syncpoint(SyncNone)
+	, m_seq(0)
+	, m_sync_source(0)
+	, m_sync_target(0)
 {
 	m_tex[0].t = NULL;
 
@@ -1257,6 +1323,8 @@ void GSRendererSW::SharedData::UsePages(const uint32* fb_pages, int fpsm, const
 {
 	if(m_using_pages) return;
 
+	m_seq = m_parent->NextDrawSeq();
+
 	{
 		//TransactionScope scope(s_lock);
 
@@ -1288,24 +1356,9 @@ void GSRendererSW::SharedData::ReleasePages()
 {
 	if(!m_using_pages) return;
 
-	{
-		//TransactionScope scope(s_lock);
-
-		if(global.sel.fb)
-		{
-			m_parent->ReleasePages(m_fb_pages, 0);
-		}
-
-		if(global.sel.zb)
-		{
-			m_parent->ReleasePages(m_zb_pages, 1);
-		}
+	// runs on the worker dropping the last reference, the GS thread picks it up in UpdateDrawDone
 
-		for(size_t i = 0; m_tex[i].t != NULL; i++)
-		{
-			m_parent->ReleasePages(m_tex[i].t->m_pages.n, 2);
-		}
-	}
+	m_parent->m_draw_complete[m_seq & (DRAW_RING - 1)].store(1, std::memory_order_release);
 
 	delete [] m_fb_pages;
 	delete [] m_zb_pages;
@@ -46,8 +46,10 @@ class GSRendererSW : public GSRenderer
 		int m_fpsm;
 		int m_zpsm;
 		bool m_using_pages;
+		uint64 m_seq;
 		TextureLevel m_tex[7 + 1]; // NULL terminated
-		enum {SyncNone, SyncSource, SyncTarget} m_syncpoint;
+		uint64 m_sync_source; // draw to wait for before updating the textures, 0 if none
+		uint64 m_sync_target; // draw to wait for before queuing, 0 if none
 
 	public:
 		SharedData(GSRendererSW* parent);
@@ -75,10 +77,23 @@ protected:
 	GSPixelOffset4* m_fzb;
 	GSVector4i m_fzb_bbox;
 	uint32 m_fzb_cur_pages[16];
-	std::atomic<uint32> m_fzb_pages[512]; // uint16 frame/zbuf pages interleaved
-	std::atomic<uint16> m_tex_pages[512];
 	uint32 m_tmp_pages[512 + 1];
 
+	// Draws are numbered as they are queued. Per page the GS thread remembers the last draw
+	// writing it as frame buffer (0) or z buffer (1) and the last one reading it as texture (2).
+	// Workers complete draws out of order, they only flag m_draw_complete, all draws up to
+	// m_draw_done are known to be finished. Waiting for the last draw touching a page is
+	// enough, the ones queued after it keep running.
+	enum {DRAW_RING = 1 << 16};
+	uint64 m_page_seq[3][MAX_PAGES];
+	uint64 m_draw_seq;
+	uint64 m_draw_queued;
+	uint64 m_draw_done;
+	std::atomic<uint8> m_draw_complete[DRAW_RING];
+	struct {uint32 syncs, waits;} m_sync_stats;
+	int m_sync_stats_frames;
+	bool m_print_sync_stats;
+
 	void Reset();
 	void VSync(int field);
 	void ResetDevice();
@@ -88,14 +103,16 @@ protected:
 	void Draw();
 	void Queue(std::shared_ptr<GSRasterizerData>& item);
 	void Sync(int reason);
+	void Wait(uint64 seq, int reason);
+	void UpdateDrawDone();
+	uint64 NextDrawSeq();
 	void InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r);
 	void InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut = false);
 
 	void UsePages(const uint32* pages, const int type);
-	void ReleasePages(const uint32* pages, const int type);
 
-	bool CheckTargetPages(const uint32* fb_pages, const uint32* zb_pages, const GSVector4i& r);
-	bool CheckSourcePages(SharedData* sd);
+	uint64 CheckTargetPages(const uint32* fb_pages, const uint32* zb_pages, const GSVector4i& r);
+	uint64 CheckSourcePages(SharedData* sd);
 
 	bool GetScanlineGlobalData(SharedData* data);
 
@@ -22,14 +22,31 @@
 #include "stdafx.h"
 #include "GSTextureCacheSW.h"
 
-GSTextureCacheSW::GSTextureCacheSW(GSState* state)
+#include <chrono>
+
+GSTextureCacheSW::GSTextureCacheSW(GSState* state, int threads)
 	: m_state(state)
+	, m_stats_frames(0)
 {
+	m_hash_cache = theApp.GetConfigB("texture_hash_cache");
+	m_print_stats = theApp.GetConfigB("unswizzle_stats");
+
+	memset(&m_stats, 0, sizeof(m_stats));
+	memset(&m_stats_total, 0, sizeof(m_stats_total));
+
+	// the gs thread converts a share as well, it would be waiting otherwise
+
+	for(int i = 0; i < threads; i++)
+	{
+		m_workers.push_back(std::unique_ptr<GSWorker>(new GSWorker([](UnswizzleJob& job) { Unswizzle(job); })));
+	}
 }
 
 GSTextureCacheSW::~GSTextureCacheSW()
 {
 	RemoveAll();
+
+	ASSERT(m_hash_map.empty());
 }
 
 GSTextureCacheSW::Texture* GSTextureCacheSW::Lookup(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint32 tw0)
@@ -64,7 +81,7 @@ GSTextureCacheSW::Texture* GSTextureCacheSW::Lookup(const GIFRegTEX0& TEX0, cons
 	}
 
 	// Lookup miss
-	Texture* t = new Texture(m_state, tw0, TEX0, TEXA);
+	Texture* t = new Texture(this, tw0, TEX0, TEXA);
 
 	m_textures.insert(t);
 
@@ -142,17 +159,150 @@ void GSTextureCacheSW::IncAge()
 			++i;
 		}
 	}
+
+	// called once per frame
+
+	m_stats_total.ms += m_stats.ms;
+	m_stats_total.blocks += m_stats.blocks;
+	m_stats_total.parallel += m_stats.parallel;
+	m_stats_total.hash_hits += m_stats.hash_hits;
+	m_stats_total.hash_misses += m_stats.hash_misses;
+
+	memset(&m_stats, 0, sizeof(m_stats));
+
+	if(m_print_stats && ++m_stats_frames == 60)
+	{
+		printf("GSdx: unswizzle %.2f ms/frame, %u blocks/frame (%u%% parallel), hash cache %u hits %u misses, %d shared buffers\n",
+			m_stats_total.ms / m_stats_frames, m_stats_total.blocks / m_stats_frames,
+			m_stats_total.blocks ? (uint32)(100ull * m_stats_total.parallel / m_stats_total.blocks) : 0,
+			m_stats_total.hash_hits, m_stats_total.hash_misses, (int)m_hash_map.size());
+
+		memset(&m_stats_total, 0, sizeof(m_stats_total));
+
+		m_stats_frames = 0;
+	}
+}
+
+void GSTextureCacheSW::Unswizzle(const UnswizzleJob& job)
+{
+	for(const BlockCopy* RESTRICT p = job.begin; p < job.end; p++)
+	{
+		(job.mem->*job.rtxb)(p->block, job.dst + p->offset, job.pitch, *job.TEXA);
+	}
+}
+
+void GSTextureCacheSW::UnswizzleParallel(const UnswizzleJob& job)
+{
+	// small updates are not worth waking up the workers
+
+	size_t n = job.end - job.begin;
+
+	if(m_workers.empty() || n < 256)
+	{
+		Unswizzle(job);
+
+		return;
+	}
+
+	size_t parts = m_workers.size() + 1;
+	size_t step = (n + parts - 1) / parts;
+
+	const BlockCopy* p = job.begin + step;
+
+	for(auto& worker : m_workers)
+	{
+		UnswizzleJob part = job;
+
+		part.begin = std::min(p, job.end);
+		part.end = std::min(p + step, job.end);
+
+		if(part.begin < part.end)
+		{
+			worker->Push(part);
+		}
+
+		p += step;
+	}
+
+	UnswizzleJob part = job;
+
+	part.end = job.begin + step;
+
+	Unswizzle(part);
+
+	for(auto& worker : m_workers)
+	{
+		worker->Wait();
+	}
+
+	m_stats.parallel += n;
+}
+
+GSTextureCacheSW::HashEntry* GSTextureCacheSW::LookupHash(const uint64* key)
+{
+	auto i = m_hash_map.find(key[0]);
+
+	if(i != m_hash_map.end() && i->second->key[1] == key[1])
+	{
+		m_stats.hash_hits++;
+
+		i->second->refs++;
+
+		return i->second;
+	}
+
+	m_stats.hash_misses++;
+
+	return NULL;
+}
+
+void GSTextureCacheSW::InsertHash(Texture* t, const uint64* key)
+{
+	if(m_hash_map.find(key[0]) != m_hash_map.end())
+	{
+		return; // the second half did not match, keep the first one
+	}
+
+	HashEntry* e = new HashEntry();
+
+	e->buff = t->m_buff;
+	e->key[0] = key[0];
+	e->key[1] = key[1];
+	e->refs = 1;
+
+	m_hash_map[key[0]] = e;
+
+	t->m_hash = e;
+}
+
+void GSTextureCacheSW::ReleaseHash(HashEntry* e, bool free_buff)
+{
+	if(--e->refs > 0)
+	{
+		return;
+	}
+
+	m_hash_map.erase(e->key[0]);
+
+	if(free_buff)
+	{
+		_aligned_free(e->buff);
+	}
+
+	delete e;
 }
 
 //
 
-GSTextureCacheSW::Texture::Texture(GSState* state, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
-	: m_state(state)
+GSTextureCacheSW::Texture::Texture(GSTextureCacheSW* tc, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
+	: m_tc(tc)
+	, m_state(tc->m_state)
 	, m_buff(NULL)
 	, m_tw(tw0)
 	, m_age(0)
 	, m_complete(false)
 	, m_p2t(NULL)
+	, m_hash(NULL)
 {
 	m_TEX0 = TEX0;
 	m_TEXA = TEXA;
@@ -183,7 +333,11 @@ GSTextureCacheSW::Texture::~Texture()
 {
 	delete [] m_pages.n;
 
-	if(m_buff)
+	if(m_hash)
+	{
+		m_tc->ReleaseHash(m_hash, true);
+	}
+	else if(m_buff)
 	{
 		_aligned_free(m_buff);
 	}
@@ -214,29 +368,21 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 		m_complete = true; // lame, but better than nothing
 	}
 
-	if(m_buff == NULL)
-	{
-		uint32 pitch = (1 << m_tw) << shift;
-		
-		m_buff = _aligned_malloc(pitch * th * 4, 32);
+	// a texture converted in one go can share its buffer with others of the same content
 
-		if(m_buff == NULL)
-		{
-			return false;
-		}
-	}
+	bool hash = m_tc->m_hash_cache && m_buff == NULL && m_complete && !m_repeating;
 
 	GSLocalMemory& mem = m_state->m_mem;
 
 	const GSOffset* RESTRICT off = m_offset;
 
-	uint32 blocks = 0;
+	std::vector<BlockCopy>& copies = m_tc->m_copies;
 
-	GSLocalMemory::readTextureBlock rtxbP = psm.rtxbP;
+	copies.clear();
 
 	uint32 pitch = (1 << m_tw) << shift;
 
-	uint8* dst = (uint8*)m_buff + pitch * r.top;
+	uint32 offset = pitch * r.top;
 
 	int block_pitch = pitch * bs.y;
 
@@ -249,7 +395,7 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 
 	if(m_repeating)
 	{
-		for(int y = r.top; y < r.bottom; y += bs.y, dst += block_pitch)
+		for(int y = r.top; y < r.bottom; y += bs.y, offset += block_pitch)
 		{
 			uint32 base = off->block.row[y];
 
@@ -264,16 +410,14 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 				{
 					m_valid[row] |= col;
 
-					(mem.*rtxbP)(block, &dst[x << shift], pitch, m_TEXA);
-
-					blocks++;
+					copies.push_back({block, offset + (x << shift)});
 				}
 			}
 		}
 	}
 	else
 	{
-		for(int y = r.top; y < r.bottom; y += bs.y, dst += block_pitch)
+		for(int y = r.top; y < r.bottom; y += bs.y, offset += block_pitch)
 		{
 			uint32 base = off->block.row[y];
 
@@ -288,19 +432,100 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 				{
 					m_valid[row] |= col;
 
-					(mem.*rtxbP)(block, &dst[x << shift], pitch, m_TEXA);
-
-					blocks++;
+					copies.push_back({block, offset + (x << shift)});
 				}
 			}
 		}
 	}
 
-	if(blocks > 0)
+	if(copies.empty() && m_buff != NULL)
 	{
-		m_state->m_perfmon.Put(GSPerfMon::Unswizzle, bs.x * bs.y * blocks << shift);
+		return true;
 	}
 
+	auto start = std::chrono::steady_clock::now();
+
+	uint64 key[2] = {0, 0};
+
+	if(hash && !copies.empty())
+	{
+		GSVector4i fmt(m_TEX0.PSM, m_TEX0.TW | (m_TEX0.TH << 4), m_tw, 0);
+
+		key[0] = fmt.u64[0];
+		key[1] = fmt.u64[1] ^ (psm.pal == 0 ? m_TEXA.u64 : 0);
+
+		for(const BlockCopy& c : copies)
+		{
+			GSLocalMemory::HashBlock(key, mem.BlockPtr(c.block), c.offset);
+		}
+
+		if(HashEntry* e = m_tc->LookupHash(key))
+		{
+			m_buff = e->buff;
+			m_hash = e;
+
+			m_tc->m_stats.ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			return true;
+		}
+	}
+
+	if(m_buff == NULL)
+	{
+		m_buff = _aligned_malloc(pitch * th * 4, 32);
+	}
+	else if(m_hash != NULL)
+	{
+		// the content is about to change, the other users keep the shared copy
+
+		if(m_hash->refs > 1)
+		{
+			void* buff = _aligned_malloc(pitch * th * 4, 32);
+
+			if(buff != NULL)
+			{
+				memcpy(buff, m_buff, pitch * th * 4);
+			}
+
+			m_buff = buff;
+		}
+
+		m_tc->ReleaseHash(m_hash, false);
+
+		m_hash = NULL;
+	}
+
+	if(m_buff == NULL)
+	{
+		memset(m_valid, 0, sizeof(m_valid));
+
+		m_complete = false;
+
+		return false;
+	}
+
+	UnswizzleJob job;
+
+	job.mem = &mem;
+	job.rtxb = psm.rtxbP;
+	job.begin = copies.data();
+	job.end = copies.data() + copies.size();
+	job.dst = (uint8*)m_buff;
+	job.pitch = pitch;
+	job.TEXA = &m_TEXA;
+
+	m_tc->UnswizzleParallel(job);
+
+	if(hash && !copies.empty())
+	{
+		m_tc->InsertHash(this, key);
+	}
+
+	m_tc->m_stats.ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	m_tc->m_stats.blocks += copies.size();
+
+	m_state->m_perfmon.Put(GSPerfMon::Unswizzle, bs.x * bs.y * copies.size() << shift);
+
 	return true;
 }
 
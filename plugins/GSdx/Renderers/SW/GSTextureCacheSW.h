@@ -23,13 +23,22 @@
 
 #include "Renderers/Common/GSRenderer.h"
 #include "Renderers/Common/GSFastList.h"
+#include "GSThread_CXX11.h"
 
 class GSTextureCacheSW
 {
 public:
+	struct HashEntry
+	{
+		void* buff;
+		uint64 key[2];
+		uint32 refs;
+	};
+
 	class Texture
 	{
 	public:
+		GSTextureCacheSW* m_tc;
 		GSState* m_state;
 		GSOffset* m_offset;
 		GIFRegTEX0 m_TEX0;
@@ -44,25 +53,69 @@ public:
 		std::array<uint16, MAX_PAGES> m_erase_it;
 		struct {uint32 bm[16]; const uint32* n;} m_pages;
 		const uint32* RESTRICT m_sharedbits;
+		HashEntry* m_hash; // m_buff is shared with other textures of the same content, see m_hash_map
 
 		// m_valid
 		// fast mode: each uint32 bits map to the 32 blocks of that page
 		// repeating mode: 1 bpp image of the texture tiles (8x8), also having 512 elements is just a coincidence (worst case: (1024*1024)/(8*8)/(sizeof(uint32)*8))
 
-		Texture(GSState* state, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA);
+		Texture(GSTextureCacheSW* tc, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA);
 		virtual ~Texture();
 
 		bool Update(const GSVector4i& r);
 		bool Save(const std::string& fn, bool dds = false) const;
 	};
 
+	struct BlockCopy
+	{
+		uint32 block;
+		uint32 offset;
+	};
+
+	struct UnswizzleJob
+	{
+		const GSLocalMemory* mem;
+		GSLocalMemory::readTextureBlock rtxb;
+		const BlockCopy* begin;
+		const BlockCopy* end;
+		uint8* dst;
+		int pitch;
+		const GIFRegTEXA* TEXA;
+	};
+
 protected:
+	struct Stats
+	{
+		double ms;
+		uint32 blocks;
+		uint32 parallel;
+		uint32 hash_hits;
+		uint32 hash_misses;
+	};
+
+	using GSWorker = GSJobQueue<UnswizzleJob, 16>;
+
 	GSState* m_state;
 	std::unordered_set<Texture*> m_textures;
 	std::array<FastList<Texture*>, MAX_PAGES> m_map;
+	std::vector<std::unique_ptr<GSWorker>> m_workers;
+	std::vector<BlockCopy> m_copies;
+	std::unordered_map<uint64, HashEntry*> m_hash_map;
+	bool m_hash_cache;
+	bool m_print_stats;
+	Stats m_stats; // current frame
+	Stats m_stats_total;
+	uint32 m_stats_frames;
+
+	static void Unswizzle(const UnswizzleJob& job);
+
+	void UnswizzleParallel(const UnswizzleJob& job);
+	HashEntry* LookupHash(const uint64* key);
+	void InsertHash(Texture* t, const uint64* key);
+	void ReleaseHash(HashEntry* e, bool free_buff);
 
 public:
-	GSTextureCacheSW(GSState* state);
+	GSTextureCacheSW(GSState* state, int threads = 0);
 	virtual ~GSTextureCacheSW();
 
 	Texture* Lookup(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint32 tw0 = 0);
@@ -422,9 +422,9 @@ DEV9read16(u32 addr)
 			// bit 1: hdd
 			// bit 5: flash
 			hard = 0;
-			/*if (config.hddEnable) {
+			if (config.hddEnable) {
 				hard|= 0x2;
-			}*/
+			}
 			if (config.ethEnable) {
 				hard|= 0x1;
 			}
@@ -718,6 +718,9 @@ EXPORT_C_(void)
 DEV9async(u32 cycles)
 {
 	smap_async(cycles);
+#ifdef ENABLE_ATA
+	ata_async(cycles);
+#endif
 }
 
 // extended funcs
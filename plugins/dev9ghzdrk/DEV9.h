@@ -44,6 +44,8 @@
 
 //#define DEV9_LOG_ENABLE
 
+#define ENABLE_ATA
+
 #ifdef DEV9_LOG_ENABLE
 #define DEV9_LOG __Log
 #else
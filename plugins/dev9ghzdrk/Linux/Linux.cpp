@@ -29,6 +29,7 @@
 #include "pcap.h"
 #include "pcap_io.h"
 #include "net.h"
+#include "loopback.h"
 
 #ifndef __LIBRETRO__
 static GtkBuilder * builder;
@@ -165,7 +166,10 @@ DEV9configure() {
 NetAdapter* GetNetAdapter()
 {
     NetAdapter* na;
-    na = new PCAPAdapter();
+    if (strcmp(config.Eth, ETH_LOOPBACK) == 0)
+        na = new LoopbackAdapter();
+    else
+        na = new PCAPAdapter();
 
     if (!na->isInitialised())
     {
@@ -0,0 +1,79 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "../DEV9.h"
+#include "loopback.h"
+
+LoopbackAdapter::LoopbackAdapter()
+{
+    // Packet sockets keep the frame boundaries
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) < 0)
+    {
+        emu_printf("Loopback: socketpair failed\n");
+        fds[0] = fds[1] = -1;
+        return;
+    }
+
+    int size = 4 * 1024 * 1024;
+    for (int i = 0; i < 2; i++)
+    {
+        setsockopt(fds[i], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+        setsockopt(fds[i], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+}
+
+bool LoopbackAdapter::blocks()
+{
+    return false;
+}
+
+bool LoopbackAdapter::isInitialised()
+{
+    return fds[0] >= 0;
+}
+
+//gets a packet, waits up to 1ms for one like the pcap read timeout
+bool LoopbackAdapter::recv(NetPacket* pkt)
+{
+    pollfd pfd = {fds[0], POLLIN, 0};
+    if (poll(&pfd, 1, 1) <= 0)
+        return false;
+
+    ssize_t size = ::recv(fds[0], pkt->buffer, sizeof(pkt->buffer), MSG_DONTWAIT);
+    if (size <= 0)
+        return false;
+
+    pkt->size = size;
+    return true;
+}
+
+//sends the packet back to the guest
+bool LoopbackAdapter::send(NetPacket* pkt)
+{
+    return ::send(fds[1], pkt->buffer, pkt->size, MSG_DONTWAIT) == pkt->size;
+}
+
+LoopbackAdapter::~LoopbackAdapter()
+{
+    if (fds[0] >= 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+}
@@ -0,0 +1,34 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "net.h"
+
+#define ETH_LOOPBACK "loopback"
+
+// Local adapter on a socket pair, selected with the "loopback" device. Frames sent by the
+// guest come back to it, which gives a network path without pcap or root.
+class LoopbackAdapter : public NetAdapter
+{
+    int fds[2];    // adapter end, reflecting end
+
+public:
+    LoopbackAdapter();
+    virtual bool blocks();
+    virtual bool isInitialised();
+    virtual bool recv(NetPacket* pkt);
+    virtual bool send(NetPacket* pkt);
+    virtual ~LoopbackAdapter();
+};
@@ -24,16 +24,21 @@ pthread_t rx_thread;
 
 volatile bool RxRunning=false;
 
+//receives straight into the ring, smap_async moves the packets to the SMAP
 void *NetRxThread(void *arg)
 {
-    NetPacket tmp;
     while(RxRunning)
     {
-        while(rx_fifo_can_rx() && nif->recv(&tmp))
+        NetPacket* pk = rx_ring.Reserve();
+        if (!pk)
         {
-            rx_process(&tmp);
+            //ring is full, leave the packets in the adapter until the SMAP catches up
+            usleep(100);
+            continue;
         }
 
+        if (nif->recv(pk))
+            rx_ring.Commit();
     }
 
     return 0;
@@ -48,6 +53,7 @@ void tx_put(NetPacket* pkt)
 void InitNet(NetAdapter* ad)
 {
     nif=ad;
+    rx_ring.Reset();
     RxRunning=true;
 
        pthread_attr_t thAttr;
@@ -74,6 +80,7 @@ void TermNet()
             pthread_join(rx_thread,NULL);
         emu_printf(".done\n");
 
+        PrintNetStats();
         delete nif;
     }
 }
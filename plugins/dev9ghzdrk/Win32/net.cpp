@@ -24,14 +24,15 @@ HANDLE rx_thread;
 
 volatile bool RxRunning=false;
 //rx thread
+//receives straight into the ring, smap_async moves the packets to the SMAP
 DWORD WINAPI NetRxThread(LPVOID lpThreadParameter)
 {	
-	NetPacket tmp;
+	NetPacket* pk;
 	while(RxRunning)
 	{
-		while(rx_fifo_can_rx() && nif->recv(&tmp))
+		while((pk=rx_ring.Reserve()) && nif->recv(pk))
 		{
-			rx_process(&tmp);
+			rx_ring.Commit();
 		}
 		
 		Sleep(10);
@@ -49,6 +50,7 @@ void tx_put(NetPacket* pkt)
 void InitNet(NetAdapter* ad)
 {
 	nif=ad;
+	rx_ring.Reset();
 	RxRunning=true;
 
 	rx_thread=CreateThread(0,0,NetRxThread,0,CREATE_SUSPENDED,0);
@@ -65,6 +67,7 @@ void TermNet()
 		WaitForSingleObject(rx_thread, -1);
 		emu_printf(".done\n");
 
+		PrintNetStats();
 		delete nif;
 		nif = NULL;
 	}
@@ -0,0 +1,612 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include "ata.h"
+#include "hdd_io.h"
+
+// ATA status bits
+#define ATA_STAT_ERR	0x01
+#define ATA_STAT_DRQ	0x08
+#define ATA_STAT_DSC	0x10
+#define ATA_STAT_DRDY	0x40
+#define ATA_STAT_BSY	0x80
+#define ATA_STAT_READY	(ATA_STAT_DRDY | ATA_STAT_DSC)
+
+#define ATA_ERR_ABRT	0x04
+
+// ATA_R_CONTROL bits
+#define ATA_CTL_NIEN	0x02
+#define ATA_CTL_SRST	0x04
+#define ATA_CTL_HOB		0x80
+
+// ATA_R_SELECT bits
+#define ATA_SEL_DEV		0x10
+#define ATA_SEL_LBA		0x40
+
+// SPD_R_XFR_CTRL bits set by atad around the DEV9 DMA of an ATA transfer
+#define SPD_XFR_DMAEN	0x80
+
+// Emulated drive timing: command overhead plus the transfer at UDMA mode 2 speed.
+#define IOP_CLOCK				36864000
+#define ATA_COMMAND_CYCLES		(IOP_CLOCK / 10000)	// 100us
+#define ATA_BYTES_PER_SECOND	(33 * 1000 * 1000)
+
+enum AtaXfer
+{
+	XFER_NONE,
+	XFER_PIO_IN,
+	XFER_PIO_OUT,
+	XFER_DMA_IN,
+	XFER_DMA_OUT,
+};
+
+static HddImage hdd;
+
+static struct
+{
+	// Task file. The previous write of each register is kept for the 48 bit commands.
+	u8 feature, nsector, lbal, lbam, lbah;
+	u8 hob_nsector, hob_lbal, hob_lbam, hob_lbah;
+	u8 select, status, error, control;
+
+	u8 command;
+	AtaXfer xfer;
+	u64 lba;
+	u32 count;
+
+	// PIO/DMA data of the current command
+	std::vector<u8> buffer;
+	u32 pos;
+
+	// Read or flush in progress on the I/O thread
+	std::shared_ptr<HddRequest> pending;
+} ata;
+
+static int ata_transfer_cycles(u64 bytes)
+{
+	return ATA_COMMAND_CYCLES + (int)(bytes * IOP_CLOCK / ATA_BYTES_PER_SECOND);
+}
+
+static void ata_irq(int cycles)
+{
+	if (!(ata.control & ATA_CTL_NIEN))
+		_DEV9irq(ATA_DEV9_INT, cycles);
+}
+
+static void ata_set_signature()
+{
+	ata.nsector = 1;
+	ata.lbal = 1;
+	ata.lbam = 0;
+	ata.lbah = 0;
+	ata.error = 1; // diagnostics passed
+}
+
+static void ata_reset()
+{
+	if (ata.pending)
+		hdd.Wait(*ata.pending);
+	ata.pending.reset();
+
+	ata.feature = 0;
+	ata.hob_nsector = ata.hob_lbal = ata.hob_lbam = ata.hob_lbah = 0;
+	ata.select = ATA_SEL_LBA;
+	ata.status = ATA_STAT_READY;
+	ata.command = 0;
+	ata.xfer = XFER_NONE;
+	ata.buffer.clear();
+	ata.pos = 0;
+	ata_set_signature();
+}
+
+static void ata_finish(int cycles)
+{
+	ata.xfer = XFER_NONE;
+	ata.status = ATA_STAT_READY;
+	ata_irq(cycles);
+}
+
+static void ata_abort()
+{
+	ata.xfer = XFER_NONE;
+	ata.error = ATA_ERR_ABRT;
+	ata.status = ATA_STAT_READY | ATA_STAT_ERR;
+	ata_irq(ATA_COMMAND_CYCLES);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// IDENTIFY
+//
+
+static void ata_put_string(u16* words, int first, int count, const char* str)
+{
+	char padded[64];
+	memset(padded, ' ', sizeof(padded));
+	memcpy(padded, str, std::min(strlen(str), (size_t)count * 2));
+
+	for (int i = 0; i < count; i++)
+		words[first + i] = (u8)padded[i * 2] << 8 | (u8)padded[i * 2 + 1];
+}
+
+static void ata_identify(u16* id)
+{
+	const u64 sectors = hdd.GetSectorCount();
+	const u32 lba28 = (u32)std::min<u64>(sectors, 0x0FFFFFFF);
+	const u32 cylinders = (u32)std::min<u64>(sectors / (16 * 63), 16383);
+
+	memset(id, 0, 512);
+	id[0] = 0x0040;				// fixed disk
+	id[1] = cylinders;
+	id[3] = 16;					// heads
+	id[6] = 63;					// sectors per track
+	ata_put_string(id, 10, 10, "PCSX2-DEV9-HDD");
+	ata_put_string(id, 23, 4, "1.0");
+	ata_put_string(id, 27, 20, "PCSX2 HDD");
+	id[47] = 0x8000 | 128;		// READ/WRITE MULTIPLE
+	id[49] = 0x0300;			// LBA, DMA
+	id[53] = 0x0007;			// words 54-58, 64-70 and 88 valid
+	id[54] = cylinders;
+	id[55] = 16;
+	id[56] = 63;
+	id[57] = (u16)(cylinders * 16 * 63);
+	id[58] = (u16)((cylinders * 16 * 63) >> 16);
+	id[60] = (u16)lba28;
+	id[61] = (u16)(lba28 >> 16);
+	id[63] = 0x0407;			// MWDMA 0-2, mode 2 selected
+	id[64] = 0x0003;			// PIO 3-4
+	id[65] = id[66] = id[67] = id[68] = 120;
+	id[80] = 0x007E;			// ATA-1 to ATA-6
+	id[82] = 0x4001;			// SMART
+	id[83] = 0x7400;			// 48 bit, FLUSH CACHE (EXT)
+	id[84] = 0x4000;
+	id[85] = 0x4001;
+	id[86] = 0x3400;
+	id[87] = 0x4000;
+	id[88] = 0x043F;			// UDMA 0-5, mode 2 selected
+	id[93] = 0x4000;
+	id[100] = (u16)sectors;
+	id[101] = (u16)(sectors >> 16);
+	id[102] = (u16)(sectors >> 32);
+	id[103] = (u16)(sectors >> 48);
+
+	// Integrity word: signature and checksum of the 512 bytes
+	id[255] = 0x00A5;
+	u8 sum = 0;
+	const u8* bytes = (const u8*)id;
+	for (int i = 0; i < 511; i++)
+		sum += bytes[i];
+	id[255] |= (u8)-sum << 8;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Commands
+//
+
+static bool ata_get_address(bool lba48)
+{
+	if (lba48)
+	{
+		ata.lba = (u64)ata.hob_lbah << 40 | (u64)ata.hob_lbam << 32 | (u64)ata.hob_lbal << 24 |
+				  (u64)ata.lbah << 16 | (u64)ata.lbam << 8 | ata.lbal;
+		ata.count = ata.hob_nsector << 8 | ata.nsector;
+		if (ata.count == 0)
+			ata.count = 65536;
+	}
+	else
+	{
+		if (ata.select & ATA_SEL_LBA)
+			ata.lba = (u64)(ata.select & 0x0F) << 24 | (u64)ata.lbah << 16 | (u64)ata.lbam << 8 | ata.lbal;
+		else // CHS on the geometry reported by IDENTIFY
+			ata.lba = ((u64)(ata.lbah << 8 | ata.lbam) * 16 + (ata.select & 0x0F)) * 63 + ata.lbal - 1;
+		ata.count = ata.nsector ? ata.nsector : 256;
+	}
+
+	return ata.lba + ata.count <= hdd.GetSectorCount();
+}
+
+static void ata_start_pio_in(u32 bytes)
+{
+	ata.buffer.assign(bytes, 0);
+	ata.pos = 0;
+	ata.xfer = XFER_PIO_IN;
+	ata.status = ATA_STAT_READY | ATA_STAT_DRQ;
+}
+
+static void ata_start_read(AtaXfer xfer)
+{
+	ata.pos = 0;
+	ata.xfer = xfer;
+	ata.buffer.resize((size_t)ata.count * HDD_SECTOR_SIZE);
+
+	if (hdd.TryReadCached(ata.lba, ata.count, ata.buffer.data()))
+	{
+		ata.status = ATA_STAT_READY | ATA_STAT_DRQ;
+		if (xfer == XFER_PIO_IN)
+			ata_irq(ata_transfer_cycles(HDD_SECTOR_SIZE));
+		return;
+	}
+
+	ata.pending = std::make_shared<HddRequest>(HddRequest::Read, ata.lba, ata.count);
+	ata.pending->data.resize(ata.buffer.size());
+	ata.status = ATA_STAT_BSY;
+	hdd.Submit(ata.pending);
+}
+
+static void ata_start_write(AtaXfer xfer)
+{
+	ata.pos = 0;
+	ata.xfer = xfer;
+	ata.buffer.resize((size_t)ata.count * HDD_SECTOR_SIZE);
+	ata.status = ATA_STAT_READY | ATA_STAT_DRQ;
+}
+
+// Hands the written sectors to the I/O thread; the command completes without waiting for the disk.
+static void ata_commit_write()
+{
+	auto req = std::make_shared<HddRequest>(HddRequest::Write, ata.lba, ata.count);
+	req->data.swap(ata.buffer);
+	hdd.Submit(req);
+
+	ata_finish(ata_transfer_cycles(req->data.size()));
+}
+
+static void ata_command(u8 cmd)
+{
+	if (ata.select & ATA_SEL_DEV)
+		return;
+
+	if (ata.pending)
+		hdd.Wait(*ata.pending);
+	ata.pending.reset();
+
+	ata.command = cmd;
+	ata.error = 0;
+	ata.xfer = XFER_NONE;
+
+	switch (cmd)
+	{
+		case 0x20: // READ SECTORS
+		case 0x24: // READ SECTORS EXT
+		case 0xC8: // READ DMA
+		case 0x25: // READ DMA EXT
+			if (!ata_get_address(cmd == 0x24 || cmd == 0x25))
+				return ata_abort();
+			ata_start_read(cmd == 0x20 || cmd == 0x24 ? XFER_PIO_IN : XFER_DMA_IN);
+			break;
+
+		case 0x30: // WRITE SECTORS
+		case 0x34: // WRITE SECTORS EXT
+		case 0xCA: // WRITE DMA
+		case 0x35: // WRITE DMA EXT
+			if (!ata_get_address(cmd == 0x34 || cmd == 0x35))
+				return ata_abort();
+			ata_start_write(cmd == 0x30 || cmd == 0x34 ? XFER_PIO_OUT : XFER_DMA_OUT);
+			break;
+
+		case 0xEC: // IDENTIFY DEVICE
+			ata_start_pio_in(512);
+			ata_identify((u16*)ata.buffer.data());
+			ata_irq(ATA_COMMAND_CYCLES);
+			break;
+
+		case 0x8E: // SCE SECURITY CONTROL
+			if (ata.feature == 0xEC) // identify: 128 bytes of drive id, zeroed
+			{
+				ata_start_pio_in(512);
+				ata_irq(ATA_COMMAND_CYCLES);
+			}
+			else
+				ata_finish(ATA_COMMAND_CYCLES);
+			break;
+
+		case 0xE7: // FLUSH CACHE
+		case 0xEA: // FLUSH CACHE EXT
+			ata.pending = std::make_shared<HddRequest>(HddRequest::Flush, 0, 0);
+			ata.status = ATA_STAT_BSY;
+			hdd.Submit(ata.pending);
+			break;
+
+		case 0xB0: // SMART
+			if (ata.feature == 0xDA) // RETURN STATUS: no threshold exceeded
+			{
+				ata.lbam = 0x4F;
+				ata.lbah = 0xC2;
+			}
+			ata_finish(ATA_COMMAND_CYCLES);
+			break;
+
+		case 0xE5: // CHECK POWER MODE
+			ata.nsector = 0xFF; // active
+			ata_finish(ATA_COMMAND_CYCLES);
+			break;
+
+		case 0xF8: // READ NATIVE MAX ADDRESS
+		case 0x27: // READ NATIVE MAX ADDRESS EXT
+		{
+			const u64 max = hdd.GetSectorCount() - 1;
+			ata.lbal = (u8)max;
+			ata.lbam = (u8)(max >> 8);
+			ata.lbah = (u8)(max >> 16);
+			if (cmd == 0x27)
+			{
+				ata.hob_lbal = (u8)(max >> 24);
+				ata.hob_lbam = (u8)(max >> 32);
+				ata.hob_lbah = (u8)(max >> 40);
+			}
+			else
+				ata.select = (ata.select & 0xF0) | ((max >> 24) & 0x0F);
+			ata_finish(ATA_COMMAND_CYCLES);
+			break;
+		}
+
+		case 0xEF: // SET FEATURES
+		case 0x91: // INITIALIZE DEVICE PARAMETERS
+		case 0xC6: // SET MULTIPLE MODE
+		case 0xE0: // STANDBY IMMEDIATE
+		case 0xE1: // IDLE IMMEDIATE
+		case 0xE2: // STANDBY
+		case 0xE3: // IDLE
+		case 0x40: // READ VERIFY SECTORS
+		case 0x70: // SEEK
+			ata_finish(ATA_COMMAND_CYCLES);
+			break;
+
+		default:
+			emu_printf("ATA: unsupported command %02x\n", cmd);
+			ata_abort();
+			break;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Data transfers
+//
+
+static u16 ata_read_data()
+{
+	if (ata.xfer != XFER_PIO_IN || ata.pos >= ata.buffer.size())
+		return 0xFFFF;
+
+	const u16 value = ata.buffer[ata.pos] | ata.buffer[ata.pos + 1] << 8;
+	ata.pos += 2;
+
+	if (ata.pos == ata.buffer.size())
+	{
+		ata.xfer = XFER_NONE;
+		ata.status = ATA_STAT_READY;
+	}
+	else if (ata.pos % HDD_SECTOR_SIZE == 0) // next sector ready
+		ata_irq(ata_transfer_cycles(HDD_SECTOR_SIZE));
+
+	return value;
+}
+
+static void ata_write_data(u16 value)
+{
+	if (ata.xfer != XFER_PIO_OUT || ata.pos >= ata.buffer.size())
+		return;
+
+	ata.buffer[ata.pos] = (u8)value;
+	ata.buffer[ata.pos + 1] = (u8)(value >> 8);
+	ata.pos += 2;
+
+	if (ata.pos == ata.buffer.size())
+		ata_commit_write();
+	else if (ata.pos % HDD_SECTOR_SIZE == 0) // ready for the next sector
+		ata_irq(ata_transfer_cycles(HDD_SECTOR_SIZE));
+}
+
+EXPORT_C_(void)
+ata_readDMA8Mem(u32* pMem, int size)
+{
+	if (ata.xfer != XFER_DMA_IN || !(dev9Ru16(SPD_R_XFR_CTRL) & SPD_XFR_DMAEN))
+		return;
+
+	// The DMA can't be delayed: wait for the I/O thread if the data isn't there yet.
+	if (ata.pending)
+	{
+		hdd.Wait(*ata.pending);
+		if (!ata.pending->ok)
+		{
+			ata.pending.reset();
+			return ata_abort();
+		}
+		ata.buffer.swap(ata.pending->data);
+		ata.pending.reset();
+	}
+
+	size >>= 1;
+	const u32 bytes = std::min<u32>(size, ata.buffer.size() - ata.pos);
+	memcpy(pMem, &ata.buffer[ata.pos], bytes);
+	ata.pos += bytes;
+
+	DEV9_LOG("ATA DMA read %d bytes, %d/%d\n", bytes, ata.pos, (int)ata.buffer.size());
+
+	if (ata.pos == ata.buffer.size())
+		ata_finish(ata_transfer_cycles(ata.buffer.size()));
+}
+
+EXPORT_C_(void)
+ata_writeDMA8Mem(u32* pMem, int size)
+{
+	if (ata.xfer != XFER_DMA_OUT || !(dev9Ru16(SPD_R_XFR_CTRL) & SPD_XFR_DMAEN))
+		return;
+
+	size >>= 1;
+	const u32 bytes = std::min<u32>(size, ata.buffer.size() - ata.pos);
+	memcpy(&ata.buffer[ata.pos], pMem, bytes);
+	ata.pos += bytes;
+
+	DEV9_LOG("ATA DMA write %d bytes, %d/%d\n", bytes, ata.pos, (int)ata.buffer.size());
+
+	if (ata.pos == ata.buffer.size())
+		ata_commit_write();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Registers
+//
+
+template<int sz>
+u16 ata_read(u32 addr)
+{
+	// No slave device
+	if ((ata.select & ATA_SEL_DEV) && addr != ATA_R_SELECT)
+		return 0;
+
+	const bool hob = (ata.control & ATA_CTL_HOB) != 0;
+
+	switch (addr)
+	{
+		case ATA_R_DATA:
+			return ata_read_data();
+		case ATA_R_ERROR:
+			return ata.error;
+		case ATA_R_NSECTOR:
+			return hob ? ata.hob_nsector : ata.nsector;
+		case ATA_R_SECTOR:
+			return hob ? ata.hob_lbal : ata.lbal;
+		case ATA_R_LCYL:
+			return hob ? ata.hob_lbam : ata.lbam;
+		case ATA_R_HCYL:
+			return hob ? ata.hob_lbah : ata.lbah;
+		case ATA_R_SELECT:
+			return ata.select;
+		case ATA_R_STATUS:
+			// Reading the status acknowledges INTRQ
+			dev9.irqcause &= ~ATA_DEV9_INT;
+			return ata.status;
+		case ATA_R_CONTROL: // alternate status
+			return ata.status;
+	}
+
+	DEV9_LOG("ATA: unknown %d byte read at %x\n", sz, addr);
+	return 0;
+}
+
+template<int sz>
+void ata_write(u32 addr, u32 value)
+{
+	const u8 v = (u8)value;
+
+	switch (addr)
+	{
+		case ATA_R_DATA:
+			if (!(ata.select & ATA_SEL_DEV))
+				ata_write_data((u16)value);
+			return;
+		case ATA_R_ERROR: // feature
+			ata.feature = v;
+			break;
+		case ATA_R_NSECTOR:
+			ata.hob_nsector = ata.nsector;
+			ata.nsector = v;
+			break;
+		case ATA_R_SECTOR:
+			ata.hob_lbal = ata.lbal;
+			ata.lbal = v;
+			break;
+		case ATA_R_LCYL:
+			ata.hob_lbam = ata.lbam;
+			ata.lbam = v;
+			break;
+		case ATA_R_HCYL:
+			ata.hob_lbah = ata.lbah;
+			ata.lbah = v;
+			break;
+		case ATA_R_SELECT:
+			ata.select = v;
+			return;
+		case ATA_R_STATUS: // command
+			ata_command(v);
+			return;
+		case ATA_R_CONTROL:
+			// Software reset on the falling edge of SRST
+			if ((ata.control & ATA_CTL_SRST) && !(v & ATA_CTL_SRST))
+				ata_reset();
+			ata.control = v;
+			return;
+		default:
+			DEV9_LOG("ATA: unknown %d byte write at %x value %x\n", sz, addr, value);
+			return;
+	}
+
+	// Writing the task file clears HOB
+	ata.control &= ~ATA_CTL_HOB;
+}
+
+template u16 ata_read<1>(u32 addr);
+template u16 ata_read<2>(u32 addr);
+template u16 ata_read<4>(u32 addr);
+template void ata_write<1>(u32 addr, u32 value);
+template void ata_write<2>(u32 addr, u32 value);
+template void ata_write<4>(u32 addr, u32 value);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Plugin
+//
+
+// Completes PIO reads and flushes once the I/O thread is done; DMA reads wait in the DMA,
+// unless they failed: those abort here rather than waiting on a DMA the game may not start.
+void ata_async(u32 cycles)
+{
+	if (!ata.pending || !ata.pending->done.load())
+		return;
+
+	const bool ok = ata.pending->ok;
+	if (ata.xfer == XFER_DMA_IN && ok)
+	{
+		ata.status = ATA_STAT_READY | ATA_STAT_DRQ;
+		return;
+	}
+
+	if (ata.xfer == XFER_PIO_IN && ok)
+	{
+		ata.buffer.swap(ata.pending->data);
+		ata.status = ATA_STAT_READY | ATA_STAT_DRQ;
+		ata_irq(ata_transfer_cycles(HDD_SECTOR_SIZE));
+	}
+	ata.pending.reset();
+
+	if (!ok)
+		ata_abort();
+	else if (ata.xfer == XFER_NONE) // flush
+		ata_finish(ATA_COMMAND_CYCLES);
+}
+
+void ata_init()
+{
+	ata.control = 0;
+	ata_reset();
+
+	if (!config.hddEnable)
+		return;
+
+	const char* path = config.Hdd[0] ? config.Hdd : HDD_DEF;
+	if (!hdd.Open(path, (u64)config.HddSize * 1024 * 1024 / HDD_SECTOR_SIZE))
+	{
+		emu_printf("ATA: could not open the HDD image %s\n", path);
+		config.hddEnable = false;
+	}
+}
+
+void ata_term()
+{
+	ata_reset();
+	hdd.Close();
+}
@@ -18,11 +18,12 @@
 
 void ata_init();
 void ata_term();
+void ata_async(u32 cycles);
 
 template<int sz>
 void ata_write(u32 addr, u32 value);
 template<int sz>
-u8 ata_read(u32 addr);
+u16 ata_read(u32 addr);
 
 EXPORT_C_(void)
 ata_readDMA8Mem(u32 *pMem, int size);
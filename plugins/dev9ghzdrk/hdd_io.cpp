@@ -0,0 +1,499 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+#include "hdd_io.h"
+
+#ifdef _WIN32
+#include <winioctl.h>
+#endif
+
+#define HDD_BLOCK_SIZE (HDD_BLOCK_SECTORS * HDD_SECTOR_SIZE)
+
+static u64 NowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool IsZero(const u8* data, size_t size)
+{
+	const u64* p = (const u64*)data;
+	for (size_t i = 0; i < size / sizeof(u64); i++)
+		if (p[i])
+			return false;
+	return true;
+}
+
+HddImage::HddImage()
+#ifdef _WIN32
+	: m_file(INVALID_HANDLE_VALUE)
+#else
+	: m_file(-1)
+#endif
+	, m_sectors(0)
+	, m_queued_write_bytes(0)
+	, m_quit(false)
+	, m_next_sequential(0)
+	, m_open_ns(0)
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+HddImage::~HddImage()
+{
+	Close();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Host file access
+//
+
+#ifdef _WIN32
+
+bool HddImage::FileRead(u64 offset, void* dst, size_t size)
+{
+	OVERLAPPED ov = {};
+	ov.Offset = (DWORD)offset;
+	ov.OffsetHigh = (DWORD)(offset >> 32);
+	DWORD done = 0;
+	if (!ReadFile(m_file, dst, (DWORD)size, &done, &ov))
+		return false;
+	// Past the end of a file that couldn't be extended
+	if (done < size)
+		memset((u8*)dst + done, 0, size - done);
+	return true;
+}
+
+bool HddImage::FileWrite(u64 offset, const void* src, size_t size)
+{
+	OVERLAPPED ov = {};
+	ov.Offset = (DWORD)offset;
+	ov.OffsetHigh = (DWORD)(offset >> 32);
+	DWORD done = 0;
+	return WriteFile(m_file, src, (DWORD)size, &done, &ov) && done == size;
+}
+
+bool HddImage::FileZero(u64 offset, size_t size)
+{
+	FILE_ZERO_DATA_INFORMATION zero;
+	zero.FileOffset.QuadPart = offset;
+	zero.BeyondFinalZero.QuadPart = offset + size;
+	DWORD unused;
+	return DeviceIoControl(m_file, FSCTL_SET_ZERO_DATA, &zero, sizeof(zero), NULL, 0, &unused, NULL) != 0;
+}
+
+bool HddImage::FileFlush()
+{
+	return FlushFileBuffers(m_file) != 0;
+}
+
+#else
+
+bool HddImage::FileRead(u64 offset, void* dst, size_t size)
+{
+	ssize_t done = pread(m_file, dst, size, offset);
+	if (done < 0)
+		return false;
+	if ((size_t)done < size)
+		memset((u8*)dst + done, 0, size - done);
+	return true;
+}
+
+bool HddImage::FileWrite(u64 offset, const void* src, size_t size)
+{
+	return pwrite(m_file, src, size, offset) == (ssize_t)size;
+}
+
+bool HddImage::FileZero(u64 offset, size_t size)
+{
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+	return fallocate(m_file, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, size) == 0;
+#else
+	return false;
+#endif
+}
+
+bool HddImage::FileFlush()
+{
+	return fsync(m_file) == 0;
+}
+
+#endif
+
+bool HddImage::Open(const char* path, u64 sectors)
+{
+	Close();
+
+	const u64 size = sectors * HDD_SECTOR_SIZE;
+	u64 current;
+
+#ifdef _WIN32
+	m_file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD unused;
+	DeviceIoControl(m_file, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &unused, NULL);
+
+	LARGE_INTEGER li;
+	GetFileSizeEx(m_file, &li);
+	current = li.QuadPart;
+	if (current < size)
+	{
+		li.QuadPart = size;
+		SetFilePointerEx(m_file, li, NULL, FILE_BEGIN);
+		SetEndOfFile(m_file);
+	}
+#else
+	m_file = open(path, O_RDWR | O_CREAT, 0644);
+	if (m_file < 0)
+		return false;
+
+	struct stat st;
+	current = fstat(m_file, &st) == 0 ? st.st_size : 0;
+	// Extending with ftruncate leaves a hole: the image only takes the space of the written sectors.
+	if (current < size && ftruncate(m_file, size) != 0)
+		emu_printf("HDD: could not extend %s to %llu MB\n", path, (unsigned long long)(size >> 20));
+#endif
+
+	// An existing image keeps its own capacity.
+	m_sectors = std::max(size, current) / HDD_SECTOR_SIZE;
+
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_open_ns = NowNs();
+	m_quit = false;
+	m_thread = std::thread(&HddImage::IoThread, this);
+
+	emu_printf("HDD: %s, %llu MB\n", path, (unsigned long long)(m_sectors * HDD_SECTOR_SIZE >> 20));
+	return true;
+}
+
+void HddImage::Close()
+{
+	if (m_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_quit = true;
+		}
+		m_queue_cv.notify_one();
+		m_thread.join();
+
+		FileFlush();
+		PrintStats();
+	}
+
+#ifdef _WIN32
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_file = INVALID_HANDLE_VALUE;
+#else
+	if (m_file >= 0)
+		close(m_file);
+	m_file = -1;
+#endif
+
+	m_queue.clear();
+	m_queued_write_bytes = 0;
+	m_blocks.clear();
+	m_block_map.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Block cache (m_lock held)
+//
+
+HddImage::Block* HddImage::FindBlock(u64 index)
+{
+	auto it = m_block_map.find(index);
+	if (it == m_block_map.end())
+		return NULL;
+
+	m_blocks.splice(m_blocks.begin(), m_blocks, it->second);
+	return &*it->second;
+}
+
+void HddImage::InsertBlock(u64 index, std::vector<u8>&& data)
+{
+	if (Block* block = FindBlock(index))
+	{
+		block->data = std::move(data);
+		return;
+	}
+
+	m_blocks.push_front(Block{index, std::move(data)});
+	m_block_map[index] = m_blocks.begin();
+
+	while (m_blocks.size() > (HDD_CACHE_SIZE_MB << 20) / HDD_BLOCK_SIZE)
+	{
+		m_block_map.erase(m_blocks.back().index);
+		m_blocks.pop_back();
+	}
+}
+
+bool HddImage::TryReadCached(u64 lba, u32 count, u8* dst)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	// A queued write may change these sectors
+	if (!m_queue.empty())
+		return false;
+
+	const u64 first = lba / HDD_BLOCK_SECTORS;
+	const u64 last = (lba + count - 1) / HDD_BLOCK_SECTORS;
+	for (u64 b = first; b <= last; b++)
+		if (m_block_map.find(b) == m_block_map.end())
+			return false;
+
+	for (u64 s = lba; s < lba + count;)
+	{
+		Block* block = FindBlock(s / HDD_BLOCK_SECTORS);
+		const u32 offset = s % HDD_BLOCK_SECTORS;
+		const u32 n = (u32)std::min<u64>(HDD_BLOCK_SECTORS - offset, lba + count - s);
+		memcpy(dst, &block->data[offset * HDD_SECTOR_SIZE], n * HDD_SECTOR_SIZE);
+		dst += n * HDD_SECTOR_SIZE;
+		s += n;
+	}
+
+	m_stats.reads++;
+	m_stats.cached_reads++;
+	m_stats.read_bytes += (u64)count * HDD_SECTOR_SIZE;
+	m_stats.block_hits += last - first + 1;
+	m_next_sequential = lba + count;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// I/O thread
+//
+
+// Copies a whole block to dst, reading it from the image on a miss. Called without m_lock.
+bool HddImage::ReadBlock(u64 index, u8* dst)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		if (Block* block = FindBlock(index))
+		{
+			memcpy(dst, block->data.data(), HDD_BLOCK_SIZE);
+			m_stats.block_hits++;
+			return true;
+		}
+	}
+
+	std::vector<u8> data(HDD_BLOCK_SIZE);
+	if (!FileRead(index * HDD_BLOCK_SIZE, data.data(), HDD_BLOCK_SIZE))
+		return false;
+
+	memcpy(dst, data.data(), HDD_BLOCK_SIZE);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_stats.block_misses++;
+	InsertBlock(index, std::move(data));
+	return true;
+}
+
+void HddImage::Service(HddRequest& req)
+{
+	switch (req.type)
+	{
+		case HddRequest::Read:
+		{
+			std::vector<u8> block(HDD_BLOCK_SIZE);
+			u8* dst = req.data.data();
+
+			for (u64 s = req.lba; s < req.lba + req.count && req.ok;)
+			{
+				const u32 offset = s % HDD_BLOCK_SECTORS;
+				const u32 n = (u32)std::min<u64>(HDD_BLOCK_SECTORS - offset, req.lba + req.count - s);
+				req.ok = ReadBlock(s / HDD_BLOCK_SECTORS, block.data());
+				memcpy(dst, &block[offset * HDD_SECTOR_SIZE], n * HDD_SECTOR_SIZE);
+				dst += n * HDD_SECTOR_SIZE;
+				s += n;
+			}
+			break;
+		}
+
+		case HddRequest::Write:
+		{
+			const u8* src = req.data.data();
+
+			for (u64 s = req.lba; s < req.lba + req.count && req.ok;)
+			{
+				const u32 offset = s % HDD_BLOCK_SECTORS;
+				const u32 n = (u32)std::min<u64>(HDD_BLOCK_SECTORS - offset, req.lba + req.count - s);
+				const size_t bytes = n * HDD_SECTOR_SIZE;
+
+				// Formatting writes large zeroed areas: keep them as holes in the image.
+				bool zeroed = false;
+				if (n == HDD_BLOCK_SECTORS && IsZero(src, bytes))
+					zeroed = FileZero(s * HDD_SECTOR_SIZE, bytes);
+				if (!zeroed)
+					req.ok = FileWrite(s * HDD_SECTOR_SIZE, src, bytes);
+
+				std::lock_guard<std::mutex> lock(m_lock);
+				if (zeroed)
+					m_stats.zero_writes++;
+				if (Block* block = FindBlock(s / HDD_BLOCK_SECTORS))
+					memcpy(&block->data[offset * HDD_SECTOR_SIZE], src, bytes);
+
+				src += bytes;
+				s += n;
+			}
+			break;
+		}
+
+		case HddRequest::Flush:
+			req.ok = FileFlush();
+			break;
+	}
+}
+
+void HddImage::IoThread()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	while (true)
+	{
+		m_queue_cv.wait(lock, [&] { return m_quit || !m_queue.empty(); });
+		if (m_queue.empty())
+			return;
+
+		std::shared_ptr<HddRequest> req = m_queue.front();
+		const bool sequential = req->type == HddRequest::Read && req->lba == m_next_sequential;
+		if (req->type == HddRequest::Read)
+			m_next_sequential = req->lba + req->count;
+
+		lock.unlock();
+		Service(*req);
+		lock.lock();
+
+		// Popped after servicing so that TryReadCached doesn't bypass a write in progress
+		m_queue.pop_front();
+
+		const u64 ns = NowNs() - req->submit_ns;
+		const u64 bytes = (u64)req->count * HDD_SECTOR_SIZE;
+		switch (req->type)
+		{
+			case HddRequest::Read:
+				m_stats.reads++;
+				m_stats.read_bytes += bytes;
+				m_stats.read_ns += ns;
+				m_stats.max_read_ns = std::max(m_stats.max_read_ns, ns);
+				break;
+			case HddRequest::Write:
+				m_stats.writes++;
+				m_stats.write_bytes += bytes;
+				m_stats.write_ns += ns;
+				m_stats.max_write_ns = std::max(m_stats.max_write_ns, ns);
+				m_queued_write_bytes -= bytes;
+				break;
+			case HddRequest::Flush:
+				m_stats.flushes++;
+				break;
+		}
+
+		req->done.store(true);
+		m_done_cv.notify_all();
+
+		// Games stream their files: fetch what follows a sequential read while the queue is idle.
+		if (sequential)
+		{
+			const u64 next = (req->lba + req->count + HDD_BLOCK_SECTORS - 1) / HDD_BLOCK_SECTORS;
+			for (u64 b = next; b < next + HDD_READ_AHEAD_BLOCKS && m_queue.empty() && !m_quit; b++)
+			{
+				if (b * HDD_BLOCK_SECTORS >= m_sectors || m_block_map.count(b))
+					continue;
+
+				lock.unlock();
+				std::vector<u8> data(HDD_BLOCK_SIZE);
+				const bool ok = FileRead(b * HDD_BLOCK_SIZE, data.data(), HDD_BLOCK_SIZE);
+				lock.lock();
+
+				// A write queued meanwhile would be missing from this copy
+				if (ok && m_queue.empty())
+				{
+					InsertBlock(b, std::move(data));
+					m_stats.read_ahead++;
+				}
+			}
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Emulation side
+//
+
+void HddImage::Submit(const std::shared_ptr<HddRequest>& req)
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	if (req->type == HddRequest::Write)
+	{
+		const u64 bytes = (u64)req->count * HDD_SECTOR_SIZE;
+		if (m_queued_write_bytes + bytes > ((u64)HDD_WRITE_BACKLOG_MB << 20) && m_queued_write_bytes)
+		{
+			const u64 start = NowNs();
+			m_done_cv.wait(lock, [&] { return m_queued_write_bytes + bytes <= ((u64)HDD_WRITE_BACKLOG_MB << 20) || !m_queued_write_bytes; });
+			m_stats.stall_ns += NowNs() - start;
+		}
+		m_queued_write_bytes += bytes;
+	}
+
+	req->submit_ns = NowNs();
+	m_queue.push_back(req);
+	m_queue_cv.notify_one();
+}
+
+void HddImage::Wait(HddRequest& req)
+{
+	if (req.done.load())
+		return;
+
+	const u64 start = NowNs();
+	std::unique_lock<std::mutex> lock(m_lock);
+	m_done_cv.wait(lock, [&] { return req.done.load(); });
+	m_stats.stall_ns += NowNs() - start;
+}
+
+void HddImage::PrintStats() const
+{
+	const HddStats& s = m_stats;
+	if (!s.reads && !s.writes)
+		return;
+
+	const double seconds = std::max(1e-3, (NowNs() - m_open_ns) / 1e9);
+	const u64 io_reads = s.reads - s.cached_reads;
+
+	emu_printf("HDD: %llu reads (%llu served from the cache), %.1f MB, avg %.2f ms, max %.2f ms\n",
+		(unsigned long long)s.reads, (unsigned long long)s.cached_reads, s.read_bytes / 1048576.0,
+		io_reads ? s.read_ns / 1e6 / io_reads : 0.0, s.max_read_ns / 1e6);
+	emu_printf("HDD: %llu writes, %.1f MB (%llu blocks left sparse), avg %.2f ms, max %.2f ms, %llu flushes\n",
+		(unsigned long long)s.writes, s.write_bytes / 1048576.0, (unsigned long long)s.zero_writes,
+		s.writes ? s.write_ns / 1e6 / s.writes : 0.0, s.max_write_ns / 1e6, (unsigned long long)s.flushes);
+	emu_printf("HDD: cache %llu hits, %llu misses, %llu read ahead; %.2f MB/s over %.0f s, IOP stalled %.1f ms\n",
+		(unsigned long long)s.block_hits, (unsigned long long)s.block_misses, (unsigned long long)s.read_ahead,
+		(s.read_bytes + s.write_bytes) / 1048576.0 / seconds, seconds, s.stall_ns / 1e6);
+}
@@ -0,0 +1,128 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "DEV9.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define HDD_SECTOR_SIZE			512
+#define HDD_BLOCK_SECTORS		128	// cache block, 64KB aligned in the image
+#define HDD_CACHE_SIZE_MB		32
+#define HDD_READ_AHEAD_BLOCKS	2	// blocks read after a sequential read
+#define HDD_WRITE_BACKLOG_MB	64	// queued writes before the IOP waits for the disk
+
+struct HddRequest
+{
+	enum Type { Read, Write, Flush };
+
+	Type type;
+	u64 lba;
+	u32 count;
+	std::vector<u8> data;
+
+	std::atomic<bool> done;
+	bool ok;
+	u64 submit_ns;
+
+	HddRequest(Type type, u64 lba, u32 count)
+		: type(type), lba(lba), count(count), done(false), ok(true), submit_ns(0) {}
+};
+
+struct HddStats
+{
+	u64 reads, writes, flushes;
+	u64 read_bytes, write_bytes;
+	u64 read_ns, write_ns;			// submit to completion
+	u64 max_read_ns, max_write_ns;
+	u64 cached_reads;				// served on the IOP thread without the I/O thread
+	u64 block_hits, block_misses, read_ahead;
+	u64 zero_writes;				// blocks punched out of the image instead of written
+	u64 stall_ns;					// time the IOP waited on the disk
+};
+
+// Sparse host image of the HDD. Reads, writes and flushes are serviced in submission order by
+// a background thread through an LRU cache of 64KB blocks; the emulated side only waits when
+// a DMA needs data that isn't there yet or when too many writes are queued.
+class HddImage
+{
+public:
+	HddImage();
+	~HddImage();
+
+	bool Open(const char* path, u64 sectors);
+	void Close();
+	bool IsOpen() const { return m_thread.joinable(); }
+
+	u64 GetSectorCount() const { return m_sectors; }
+
+	// Serves a read on the calling thread when no request is queued and all its blocks are cached.
+	bool TryReadCached(u64 lba, u32 count, u8* dst);
+
+	void Submit(const std::shared_ptr<HddRequest>& req);
+	void Wait(HddRequest& req);
+
+	void PrintStats() const;
+
+private:
+	struct Block
+	{
+		u64 index;
+		std::vector<u8> data;
+	};
+
+	typedef std::list<Block> BlockList;
+
+#ifdef _WIN32
+	HANDLE m_file;
+#else
+	int m_file;
+#endif
+	u64 m_sectors;
+
+	std::thread m_thread;
+	std::mutex m_lock;					// queue, cache and stats
+	std::condition_variable m_queue_cv;
+	std::condition_variable m_done_cv;
+	std::deque<std::shared_ptr<HddRequest>> m_queue;
+	u64 m_queued_write_bytes;
+	bool m_quit;
+
+	BlockList m_blocks;					// most recently used first
+	std::unordered_map<u64, BlockList::iterator> m_block_map;
+	u64 m_next_sequential;				// lba following the last read
+
+	HddStats m_stats;
+	u64 m_open_ns;
+
+	void IoThread();
+	void Service(HddRequest& req);
+	bool ReadBlock(u64 index, u8* dst);
+	Block* FindBlock(u64 index);
+	void InsertBlock(u64 index, std::vector<u8>&& data);
+
+	bool FileRead(u64 offset, void* dst, size_t size);
+	bool FileWrite(u64 offset, const void* src, size_t size);
+	bool FileZero(u64 offset, size_t size);
+	bool FileFlush();
+};
@@ -16,6 +16,8 @@
 #pragma once
 #include <stdlib.h>
 #include <string.h>  //uh isnt memcpy @ stdlib ?
+#include <atomic>
+#include <chrono>
 
 struct NetPacket
 {
@@ -25,6 +27,77 @@ struct NetPacket
 	int size;
 	char buffer[2048-sizeof(int)];//1536 is realy needed, just pad up to 2048 bytes :)
 };
+#define NET_RX_RING_SIZE 256	// packets buffered between the rx thread and the SMAP, power of 2
+
+// Received packets on their way from the adapter's rx thread to the SMAP RX FIFO. The slots
+// are the packet pool: the rx thread receives directly into a free slot and the emulation
+// thread moves the filled ones into the FIFO on each async tick, without locks or allocation.
+// One producer (rx thread), one consumer (smap_async).
+class NetRxRing
+{
+	NetPacket slots[NET_RX_RING_SIZE];
+	std::atomic<unsigned> head;	// next slot the rx thread fills
+	std::atomic<unsigned> tail;	// next slot the SMAP takes
+
+public:
+	// Producer side
+	unsigned long long received, full;	// full counts the times the ring filled up, not the retries
+	bool stalled;
+	// Consumer side
+	unsigned long long delivered, batches;
+	unsigned max_batch;
+	std::chrono::steady_clock::time_point started;
+
+	NetRxRing() { Reset(); }
+
+	void Reset()
+	{
+		head = tail = 0;
+		received = full = delivered = batches = 0;
+		stalled = false;
+		max_batch = 0;
+		started = std::chrono::steady_clock::now();
+	}
+
+	// Free slot to receive into, or NULL when the SMAP is behind
+	NetPacket* Reserve()
+	{
+		unsigned h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) == NET_RX_RING_SIZE)
+		{
+			if (!stalled)
+				full++;
+			stalled = true;
+			return NULL;
+		}
+		stalled = false;
+		return &slots[h & (NET_RX_RING_SIZE - 1)];
+	}
+	// Publishes the reserved slot
+	void Commit()
+	{
+		received++;
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Oldest received packet, or NULL
+	NetPacket* Peek()
+	{
+		unsigned t = tail.load(std::memory_order_relaxed);
+		if (t == head.load(std::memory_order_acquire))
+			return NULL;
+		return &slots[t & (NET_RX_RING_SIZE - 1)];
+	}
+	// Returns the peeked slot to the pool
+	void Release()
+	{
+		delivered++;
+		tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+};
+
+extern NetRxRing rx_ring;
+
 /*
 extern mtfifo<NetPacket*> rx_fifo;
 extern mtfifo<NetPacket*> tx_fifo;
@@ -42,4 +115,5 @@ public:
 
 void tx_put(NetPacket* ptr);
 void InitNet(NetAdapter* adapter);
-void TermNet();
\ No newline at end of file
+void TermNet();
+void PrintNetStats();
\ No newline at end of file
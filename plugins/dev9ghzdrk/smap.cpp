@@ -33,6 +33,7 @@
 
 bool has_link=true;
 volatile bool fireIntR = false;
+NetRxRing rx_ring;
 std::mutex frame_counter_mutex;
 std::mutex reset_mutex;
 /*
@@ -127,6 +128,36 @@ void rx_process(NetPacket* pk)
 								//note that this _is_ wrong since the IOP interrupt system is not thread safe.. but nothing i can do about that
 }
 
+//moves the packets received since the last tick into the RX FIFO, they are signaled by a single RXEND
+void rx_deliver()
+{
+	unsigned batch=0;
+	NetPacket* pk;
+	while((pk=rx_ring.Peek()) && rx_fifo_can_rx())
+	{
+		rx_process(pk);
+		rx_ring.Release();
+		batch++;
+	}
+
+	if (batch)
+	{
+		rx_ring.batches++;
+		if (batch>rx_ring.max_batch)
+			rx_ring.max_batch=batch;
+	}
+}
+
+void PrintNetStats()
+{
+	if (!rx_ring.received)
+		return;
+
+	double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-rx_ring.started).count();
+	emu_printf("SMAP: %llu packets received, %llu delivered in %llu batches (max %u), ring full %llu times, %.0f packets/s\n",
+		rx_ring.received, rx_ring.delivered, rx_ring.batches, rx_ring.max_batch, rx_ring.full, rx_ring.delivered/seconds);
+}
+
 u32 wswap(u32 d)
 {
 	return (d>>16)|(d<<16);
@@ -864,6 +895,8 @@ smap_writeDMA8Mem(u32* pMem, int size)
 EXPORT_C_(void)
 smap_async(u32 cycles)
 {
+	rx_deliver();
+
 	if (fireIntR)
 	{
 		fireIntR = false;
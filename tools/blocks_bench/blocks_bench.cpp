@@ -0,0 +1,366 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// --------------------------------------------------------------------------------------
+//  blocks_bench -- replays block index operations of the recompilers
+// --------------------------------------------------------------------------------------
+// Reads a trace written by BaseBlocks::SetTrace (EE_BLOCK_TRACE in iR5900-32.cpp), or
+// generates a self-modifying code storm when none is given, and replays it against
+// BaseBlocks and against a model of the former index: a sorted array that memmoves on
+// insert and erase, a multimap of links and the full block scan recClear did after each
+// clear. Clears are replayed the way recClear issues them.
+
+#include "PrecompiledHeader.h"
+#include "BaseblockEx.h"
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+
+struct Op
+{
+	char type;
+	u32 a, b;
+};
+
+static u8 s_code[16];
+static void JITCompileStub() {}
+
+// --------------------------------------------------------------------------------------
+//  Former index
+// --------------------------------------------------------------------------------------
+class SortedBlocks
+{
+	struct Block
+	{
+		u32 startpc;
+		uptr fnptr;
+		u16 size;
+	};
+
+	std::vector<Block> blocks;
+	std::multimap<u32, s32*> links;
+	uptr recompiler;
+
+	int LastIndex(u32 pc) const
+	{
+		auto it = std::upper_bound(blocks.begin(), blocks.end(), pc, [](u32 pc, const Block& b) { return pc < b.startpc; });
+		return (int)(it - blocks.begin()) - 1;
+	}
+
+public:
+	SortedBlocks(uptr recompiler) : recompiler(recompiler) { blocks.reserve(0x4000); }
+
+	size_t Count() const { return blocks.size(); }
+
+	void New(u32 pc, uptr fnptr)
+	{
+		auto range = links.equal_range(pc);
+		for (auto i = range.first; i != range.second; ++i)
+			*i->second = (s32)(fnptr - (uptr)(i->second + 1));
+
+		const Block block = {pc, fnptr, 0};
+		blocks.insert(blocks.begin() + (LastIndex(pc) + 1), block);
+	}
+
+	void SetSize(u32 pc, u32 size)
+	{
+		const int idx = LastIndex(pc);
+		if (idx >= 0 && blocks[idx].startpc == pc)
+			blocks[idx].size = size;
+	}
+
+	void Link(u32 pc, s32* jumpptr)
+	{
+		const int idx = LastIndex(pc);
+		if (idx >= 0 && blocks[idx].startpc == pc)
+			*jumpptr = (s32)(blocks[idx].fnptr - (uptr)(jumpptr + 1));
+		else
+			*jumpptr = (s32)(recompiler - (uptr)(jumpptr + 1));
+		links.insert(std::make_pair(pc, jumpptr));
+	}
+
+	// recClear before the page buckets.
+	void Clear(u32 start, u32 end)
+	{
+		int idx = LastIndex(end - 4);
+		if (idx < 0)
+			return;
+
+		const int last = idx;
+		while (idx >= 0 && blocks[idx].startpc + blocks[idx].size * 4 > start)
+		{
+			auto range = links.equal_range(blocks[idx].startpc);
+			for (auto i = range.first; i != range.second; ++i)
+				*i->second = (s32)(recompiler - (uptr)(i->second + 1));
+			idx--;
+		}
+
+		blocks.erase(blocks.begin() + idx + 1, blocks.begin() + last + 1);
+
+		for (const Block& block : blocks)
+		{
+			if ((block.startpc >= start && block.startpc < end) || (block.startpc < start && block.startpc + block.size * 4 > start))
+				fprintf(stderr, "Impossible block clearing failure\n");
+		}
+	}
+
+	void Reset()
+	{
+		blocks.clear();
+		links.clear();
+	}
+};
+
+// --------------------------------------------------------------------------------------
+//  Traces
+// --------------------------------------------------------------------------------------
+static bool LoadTrace(const char* filename, std::vector<Op>& ops)
+{
+	FILE* fp = fopen(filename, "r");
+	if (!fp)
+		return false;
+
+	char line[64];
+	while (fgets(line, sizeof(line), fp))
+	{
+		Op op = {0, 0, 0};
+		if (sscanf(line, "%c %x %x", &op.type, &op.a, &op.b) >= 1 && strchr("nslrx", op.type))
+			ops.push_back(op);
+	}
+
+	fclose(fp);
+	return true;
+}
+
+// A game with `count` blocks of code that keeps rewriting parts of it (decompressed
+// overlays, self-modifying loops), each rewrite followed by the cleared blocks being run
+// and compiled again.
+static void GenerateStorm(std::vector<Op>& ops, u32 count, u32 clears)
+{
+	std::mt19937 rng(1234);
+	const u32 base = 0x100000;
+	const u32 maxSize = 24;
+	std::map<u32, u32> live;	// start, size
+	std::map<u32, u32> sizes;	// blocks run from one branch to the next and don't overlap
+	std::vector<u32> starts;
+
+	u32 pc = base;
+	for (u32 i = 0; i < count; i++)
+	{
+		const u32 size = 1 + rng() % maxSize;
+		starts.push_back(pc);
+		sizes[pc] = size;
+		pc += size * 4;
+	}
+	const u32 end = pc;
+
+	auto compile = [&](u32 start) {
+		const u32 size = sizes[start];
+		ops.push_back({'n', start, 0});
+		ops.push_back({'l', starts[rng() % starts.size()], start});
+		ops.push_back({'l', start + size * 4, start});
+		ops.push_back({'s', start, size});
+		live[start] = size;
+	};
+
+	for (u32 start : starts)
+		compile(start);
+
+	std::vector<u32> cleared;
+	for (u32 i = 0; i < clears; i++)
+	{
+		// Mostly single words (stores into code), sometimes a whole page (overlay loads).
+		const u32 addr = base + ((rng() % (end - base)) & ~3u);
+		const u32 words = (rng() % 8) ? 1 : 0x400;
+		ops.push_back({'r', addr, addr + words * 4});
+
+		cleared.clear();
+		auto it = live.lower_bound(addr > maxSize * 4 ? addr - maxSize * 4 : 0);
+		while (it != live.end() && it->first < addr + words * 4)
+		{
+			if (it->first + it->second * 4 > addr)
+			{
+				cleared.push_back(it->first);
+				it = live.erase(it);
+			}
+			else
+				++it;
+		}
+
+		for (u32 start : cleared)
+			compile(start);
+	}
+}
+
+// --------------------------------------------------------------------------------------
+//  Replay
+// --------------------------------------------------------------------------------------
+struct Result
+{
+	double seconds;
+	double clearSeconds;
+	size_t clears;
+	size_t blocks;
+};
+
+static Result ReplayBaseBlocks(const std::vector<Op>& ops)
+{
+	BaseBlocks blocks;
+	blocks.SetJITCompile(JITCompileStub);
+	BASEBLOCKEX* current = NULL;		// the block being compiled
+
+	std::deque<s32> jumps;
+	Result result = {0, 0, 0, 0};
+	const auto start = std::chrono::steady_clock::now();
+
+	for (const Op& op : ops)
+	{
+		switch (op.type)
+		{
+			case 'n':
+				blocks.ReleaseOrphans();
+				current = blocks.New(op.a, (uptr)s_code);
+				break;
+			case 's':
+				if (current && current->startpc == op.a)
+					blocks.SetSize(current, op.b);
+				break;
+			case 'l':
+				jumps.push_back(0);
+				blocks.Link(op.a, &jumps.back(), current && current->startpc == op.b ? current : NULL);
+				break;
+			case 'r':
+			{
+				const auto clear = std::chrono::steady_clock::now();
+				u32 lower = (u32)-1, upper = 0;
+
+				blocks.Remove(op.a, op.b, NULL, [&](BASEBLOCKEX& block) {
+					if (&block == current)
+						current = NULL;
+					lower = std::min(lower, block.startpc);
+					upper = std::max(upper, block.startpc + block.size * 4);
+				});
+				if (upper > lower)
+				{
+					blocks.ForEach(lower, op.a, [&](BASEBLOCKEX& block) {
+						lower = std::max(lower, block.startpc + block.size * 4);
+						return true;
+					});
+					if (BASEBLOCKEX* ceiling = blocks.Next(op.b, upper))
+						upper = ceiling->startpc;
+				}
+
+				result.clearSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - clear).count();
+				result.clears++;
+				break;
+			}
+			case 'x':
+				blocks.Reset();
+				jumps.clear();
+				current = NULL;
+				break;
+		}
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.blocks = blocks.Count();
+	return result;
+}
+
+static Result ReplaySorted(const std::vector<Op>& ops)
+{
+	SortedBlocks blocks((uptr)JITCompileStub);
+
+	std::deque<s32> jumps;
+	Result result = {0, 0, 0, 0};
+	const auto start = std::chrono::steady_clock::now();
+
+	for (const Op& op : ops)
+	{
+		switch (op.type)
+		{
+			case 'n':
+				blocks.New(op.a, (uptr)s_code);
+				break;
+			case 's':
+				blocks.SetSize(op.a, op.b);
+				break;
+			case 'l':
+				jumps.push_back(0);
+				blocks.Link(op.a, &jumps.back());
+				break;
+			case 'r':
+			{
+				const auto clear = std::chrono::steady_clock::now();
+				blocks.Clear(op.a, op.b);
+				result.clearSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - clear).count();
+				result.clears++;
+				break;
+			}
+			case 'x':
+				blocks.Reset();
+				jumps.clear();
+				break;
+		}
+	}
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.blocks = blocks.Count();
+	return result;
+}
+
+static void Print(const char* name, const Result& result)
+{
+	printf("%-12s %8.1f ms total, %8.1f ms in %zu clears (%.2f us each), %zu blocks left\n", name,
+		result.seconds * 1e3, result.clearSeconds * 1e3, result.clears,
+		result.clears ? result.clearSeconds * 1e6 / result.clears : 0.0, result.blocks);
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<Op> ops;
+
+	if (argc > 1 && strcmp(argv[1], "-h") && strcmp(argv[1], "--help"))
+	{
+		if (!LoadTrace(argv[1], ops))
+		{
+			fprintf(stderr, "Could not read %s\n", argv[1]);
+			return 1;
+		}
+	}
+	else if (argc > 1)
+	{
+		printf("usage: blocks_bench [trace]\n"
+			   "Replays a blocks.trace written with EE_BLOCK_TRACE, or a generated storm of\n"
+			   "20000 blocks and 200000 clears when no trace is given.\n");
+		return 0;
+	}
+	else
+		GenerateStorm(ops, 20000, 200000);
+
+	printf("%zu operations\n", ops.size());
+
+	const Result indexed = ReplayBaseBlocks(ops);
+	const Result sorted = ReplaySorted(ops);
+
+	Print("BaseBlocks", indexed);
+	Print("sorted array", sorted);
+	printf("clear speedup %.1fx\n", indexed.clearSeconds > 0 ? sorted.clearSeconds / indexed.clearSeconds : 0.0);
+
+	return 0;
+}
@@ -0,0 +1,800 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// --------------------------------------------------------------------------------------
+//  libretro_bench -- headless throughput benchmark for the libretro core
+// --------------------------------------------------------------------------------------
+// Loads the core with dlopen, answers the environment with stubs and runs retro_run
+// back to back for a number of frames. Reports FPS, per-frame time percentiles and the
+// CPU time of each emulator thread (EE Core, MTVU, the frontend thread which also runs
+// the GS, ...).
+//
+// Nothing is displayed: the core must use a renderer that doesn't need a gpu context,
+// the bench selects pcsx2_renderer=CPU unless told otherwise ("Null" works too).
+//
+// Input replay files make runs deterministic. One event per line, '#' starts a comment:
+//
+//   <frame> <port> <buttons> [<lx> <ly> <rx> <ry>]
+//
+// buttons is the RETRO_DEVICE_ID_JOYPAD_* bitmask (hex with 0x), the sticks are
+// -32768..32767. The state of a port holds until its next event.
+//
+// TLB misses of all threads are counted with perf_event_open (user space only, needs
+// kernel.perf_event_paranoid <= 2), e.g. to compare runs with -o pcsx2_huge_pages=enabled.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "libretro.h"
+
+struct Core
+{
+	void* handle;
+
+	void (*retro_set_environment)(retro_environment_t);
+	void (*retro_set_video_refresh)(retro_video_refresh_t);
+	void (*retro_set_audio_sample)(retro_audio_sample_t);
+	void (*retro_set_audio_sample_batch)(retro_audio_sample_batch_t);
+	void (*retro_set_input_poll)(retro_input_poll_t);
+	void (*retro_set_input_state)(retro_input_state_t);
+	void (*retro_init)(void);
+	void (*retro_deinit)(void);
+	void (*retro_get_system_av_info)(retro_system_av_info*);
+	bool (*retro_load_game)(const retro_game_info*);
+	void (*retro_unload_game)(void);
+	void (*retro_run)(void);
+};
+
+struct InputEvent
+{
+	unsigned frame;
+	unsigned port;
+	int16_t buttons;
+	int16_t analog[4];
+};
+
+static Core s_core;
+
+static std::map<std::string, std::string> s_options;
+static std::map<std::string, std::string> s_overrides;
+static std::string s_system_dir = ".";
+static std::string s_save_dir;
+static bool s_verbose = false;
+
+static retro_hw_render_callback s_hw_render;
+static bool s_hw_render_set = false;
+
+static std::vector<uint32_t> s_framebuffer;
+static unsigned s_fb_width = 0;
+static unsigned s_fb_height = 0;
+
+static struct
+{
+	unsigned frames;     // frames handed to video_cb
+	unsigned dupes;      // NULL frames
+	unsigned zero_copy;  // frames rendered into our software framebuffer
+	uint64_t audio_frames;
+	uint64_t hash;       // FNV-1a of the last frame
+} s_video;
+
+static std::vector<InputEvent> s_replay;
+static size_t s_replay_pos = 0;
+static InputEvent s_pad[2];
+static unsigned s_frame = 0;
+
+// --------------------------------------------------------------------------------------
+//  Callbacks
+// --------------------------------------------------------------------------------------
+
+static void RETRO_CALLCONV log_printf(enum retro_log_level level, const char* fmt, ...)
+{
+	if (level < RETRO_LOG_WARN && !s_verbose)
+		return;
+
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+static void set_option_defaults(const retro_core_option_definition* defs)
+{
+	for (; defs->key != NULL; defs++)
+	{
+		const char* value = defs->default_value ? defs->default_value : defs->values[0].value;
+
+		if (value)
+			s_options[defs->key] = value;
+	}
+}
+
+static void set_variable_defaults(const retro_variable* vars)
+{
+	// "Description; first|second|..." the first value is the default
+	for (; vars->key != NULL; vars++)
+	{
+		const char* values = strchr(vars->value, ';');
+
+		if (!values)
+			continue;
+
+		std::string value = values + 1;
+		value.erase(0, value.find_first_not_of(' '));
+		s_options[vars->key] = value.substr(0, value.find('|'));
+	}
+}
+
+static bool RETRO_CALLCONV environment(unsigned cmd, void* data)
+{
+	switch (cmd)
+	{
+		case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+			((retro_log_callback*)data)->log = log_printf;
+			return true;
+
+		case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+			*(const char**)data = s_system_dir.c_str();
+			return true;
+
+		case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+			*(const char**)data = s_save_dir.c_str();
+			return true;
+
+		case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+			return *(const retro_pixel_format*)data == RETRO_PIXEL_FORMAT_XRGB8888;
+
+		case RETRO_ENVIRONMENT_GET_CORE_OPTIONS_VERSION:
+			*(unsigned*)data = 1;
+			return true;
+
+		case RETRO_ENVIRONMENT_SET_CORE_OPTIONS:
+			set_option_defaults((const retro_core_option_definition*)data);
+			return true;
+
+		case RETRO_ENVIRONMENT_SET_CORE_OPTIONS_INTL:
+			set_option_defaults(((const retro_core_options_intl*)data)->us);
+			return true;
+
+		case RETRO_ENVIRONMENT_SET_VARIABLES:
+			set_variable_defaults((const retro_variable*)data);
+			return true;
+
+		case RETRO_ENVIRONMENT_GET_VARIABLE:
+		{
+			retro_variable* var = (retro_variable*)data;
+
+			auto it = s_overrides.find(var->key);
+
+			if (it != s_overrides.end())
+				var->value = it->second.c_str();
+			else if ((it = s_options.find(var->key)) != s_options.end())
+				var->value = it->second.c_str();
+			else
+				var->value = NULL;
+
+			return var->value != NULL;
+		}
+
+		case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+			*(bool*)data = false;
+			return true;
+
+		case RETRO_ENVIRONMENT_SET_HW_RENDER:
+		{
+			// No gpu here, only the "no context" request of the Null renderer can be honoured.
+			const retro_hw_render_callback* hw = (const retro_hw_render_callback*)data;
+
+			if (hw->context_type != RETRO_HW_CONTEXT_NONE)
+				return false;
+
+			s_hw_render = *hw;
+			s_hw_render_set = true;
+
+			return true;
+		}
+
+		case RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER:
+		{
+			retro_framebuffer* fb = (retro_framebuffer*)data;
+
+			if (fb->width != s_fb_width || fb->height != s_fb_height)
+			{
+				s_fb_width = fb->width;
+				s_fb_height = fb->height;
+				s_framebuffer.resize((size_t)s_fb_width * s_fb_height);
+			}
+
+			fb->data = s_framebuffer.data();
+			fb->pitch = s_fb_width * sizeof(uint32_t);
+			fb->format = RETRO_PIXEL_FORMAT_XRGB8888;
+			fb->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+
+			return true;
+		}
+
+		case RETRO_ENVIRONMENT_GET_INPUT_BITMASKS:
+			return true;
+
+		case RETRO_ENVIRONMENT_SET_MESSAGE:
+			if (s_verbose)
+				fprintf(stderr, "message: %s\n", ((const retro_message*)data)->msg);
+			return true;
+
+		case RETRO_ENVIRONMENT_SET_MESSAGE_EXT:
+			if (s_verbose)
+				fprintf(stderr, "message: %s\n", ((const retro_message_ext*)data)->msg);
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static void RETRO_CALLCONV video_refresh(const void* data, unsigned width, unsigned height, size_t pitch)
+{
+	if (data == NULL || data == RETRO_HW_FRAME_BUFFER_VALID)
+	{
+		s_video.dupes++;
+		return;
+	}
+
+	s_video.frames++;
+
+	if (data == s_framebuffer.data())
+		s_video.zero_copy++;
+
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	for (unsigned y = 0; y < height; y++)
+	{
+		const uint32_t* row = (const uint32_t*)((const uint8_t*)data + y * pitch);
+
+		for (unsigned x = 0; x < width; x++)
+		{
+			hash = (hash ^ (row[x] & 0xffffff)) * 0x100000001b3ull;
+		}
+	}
+
+	s_video.hash = hash;
+}
+
+static void RETRO_CALLCONV audio_sample(int16_t left, int16_t right)
+{
+	s_video.audio_frames++;
+}
+
+static size_t RETRO_CALLCONV audio_sample_batch(const int16_t* data, size_t frames)
+{
+	s_video.audio_frames += frames;
+
+	return frames;
+}
+
+static void RETRO_CALLCONV input_poll(void)
+{
+	while (s_replay_pos < s_replay.size() && s_replay[s_replay_pos].frame <= s_frame)
+	{
+		const InputEvent& e = s_replay[s_replay_pos++];
+
+		if (e.port < 2)
+			s_pad[e.port] = e;
+	}
+}
+
+static int16_t RETRO_CALLCONV input_state(unsigned port, unsigned device, unsigned index, unsigned id)
+{
+	if (port >= 2)
+		return 0;
+
+	const InputEvent& pad = s_pad[port];
+
+	switch (device)
+	{
+		case RETRO_DEVICE_JOYPAD:
+			if (id == RETRO_DEVICE_ID_JOYPAD_MASK)
+				return pad.buttons;
+			return (pad.buttons >> id) & 1;
+
+		case RETRO_DEVICE_ANALOG:
+			if (index == RETRO_DEVICE_INDEX_ANALOG_BUTTON)
+				return ((pad.buttons >> id) & 1) ? 0x7fff : 0;
+			if (index <= RETRO_DEVICE_INDEX_ANALOG_RIGHT && id <= RETRO_DEVICE_ID_ANALOG_Y)
+				return pad.analog[index * 2 + id];
+			return 0;
+
+		default:
+			return 0;
+	}
+}
+
+// --------------------------------------------------------------------------------------
+//  Helpers
+// --------------------------------------------------------------------------------------
+
+static bool load_core(const char* path)
+{
+	s_core.handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+
+	if (!s_core.handle)
+	{
+		fprintf(stderr, "Could not load %s: %s\n", path, dlerror());
+		return false;
+	}
+
+#define LOAD_SYM(name)                                                 \
+	*(void**)&s_core.name = dlsym(s_core.handle, #name);               \
+	if (!s_core.name)                                                  \
+	{                                                                  \
+		fprintf(stderr, "Missing symbol %s in %s\n", #name, path);     \
+		return false;                                                  \
+	}
+
+	LOAD_SYM(retro_set_environment);
+	LOAD_SYM(retro_set_video_refresh);
+	LOAD_SYM(retro_set_audio_sample);
+	LOAD_SYM(retro_set_audio_sample_batch);
+	LOAD_SYM(retro_set_input_poll);
+	LOAD_SYM(retro_set_input_state);
+	LOAD_SYM(retro_init);
+	LOAD_SYM(retro_deinit);
+	LOAD_SYM(retro_get_system_av_info);
+	LOAD_SYM(retro_load_game);
+	LOAD_SYM(retro_unload_game);
+	LOAD_SYM(retro_run);
+
+#undef LOAD_SYM
+
+	return true;
+}
+
+static bool load_replay(const char* path)
+{
+	FILE* fp = fopen(path, "r");
+
+	if (!fp)
+	{
+		fprintf(stderr, "Could not open replay file %s\n", path);
+		return false;
+	}
+
+	char line[256];
+	unsigned lineno = 0;
+
+	while (fgets(line, sizeof(line), fp))
+	{
+		lineno++;
+
+		if (char* comment = strchr(line, '#'))
+			*comment = 0;
+
+		InputEvent e = {};
+		unsigned buttons = 0;
+		int analog[4] = {};
+
+		int n = sscanf(line, "%u %u %i %i %i %i %i", &e.frame, &e.port, &buttons, &analog[0], &analog[1], &analog[2], &analog[3]);
+
+		if (n <= 0)
+			continue;
+
+		if (n < 3)
+		{
+			fprintf(stderr, "%s:%u: expected <frame> <port> <buttons> [<lx> <ly> <rx> <ry>]\n", path, lineno);
+			fclose(fp);
+			return false;
+		}
+
+		e.buttons = (int16_t)buttons;
+
+		for (int i = 0; i < 4; i++)
+			e.analog[i] = (int16_t)std::min(std::max(analog[i], -32768), 32767);
+
+		s_replay.push_back(e);
+	}
+
+	fclose(fp);
+
+	std::stable_sort(s_replay.begin(), s_replay.end(), [](const InputEvent& a, const InputEvent& b) { return a.frame < b.frame; });
+
+	return true;
+}
+
+struct ThreadTime
+{
+	std::string name;
+	double seconds;
+};
+
+// Per thread user+system time from /proc, threads of the same name are summed up.
+// Unnamed threads (e.g. the GS software renderer workers) keep the process name.
+
+static std::vector<ThreadTime> thread_times()
+{
+	std::vector<ThreadTime> result;
+
+	DIR* dir = opendir("/proc/self/task");
+
+	if (!dir)
+		return result;
+
+	const double tick = (double)sysconf(_SC_CLK_TCK);
+
+	while (dirent* entry = readdir(dir))
+	{
+		if (entry->d_name[0] == '.')
+			continue;
+
+		std::string path = std::string("/proc/self/task/") + entry->d_name + "/stat";
+
+		FILE* fp = fopen(path.c_str(), "r");
+
+		if (!fp)
+			continue;
+
+		char buf[1024];
+		size_t len = fread(buf, 1, sizeof(buf) - 1, fp);
+		fclose(fp);
+		buf[len] = 0;
+
+		// pid (comm) state ... utime stime are fields 14 and 15, comm may contain spaces
+		char* open = strchr(buf, '(');
+		char* close = strrchr(buf, ')');
+
+		if (!open || !close)
+			continue;
+
+		std::string name(open + 1, close);
+
+		unsigned long utime = 0, stime = 0;
+
+		if (sscanf(close + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) != 2)
+			continue;
+
+		if (strtol(entry->d_name, NULL, 10) == getpid())
+			name = "frontend (GS)";
+		else if (name == program_invocation_short_name)
+			name = "unnamed";
+
+		double seconds = (utime + stime) / tick;
+
+		// schedstat has the run time in ns, much finer than the clock ticks of stat
+		path = std::string("/proc/self/task/") + entry->d_name + "/schedstat";
+
+		if ((fp = fopen(path.c_str(), "r")))
+		{
+			unsigned long long runtime;
+
+			if (fscanf(fp, "%llu", &runtime) == 1)
+				seconds = runtime / 1e9;
+
+			fclose(fp);
+		}
+
+		auto it = std::find_if(result.begin(), result.end(), [&](const ThreadTime& t) { return t.name == name; });
+
+		if (it != result.end())
+			it->seconds += seconds;
+		else
+			result.push_back({name, seconds});
+	}
+
+	closedir(dir);
+
+	return result;
+}
+
+struct TlbCounter
+{
+	const char* name;
+	uint64_t config;
+	int fd;
+	uint64_t start;
+};
+
+#define TLB_EVENT(cache, op, result) \
+	(PERF_COUNT_HW_CACHE_##cache | (PERF_COUNT_HW_CACHE_OP_##op << 8) | (PERF_COUNT_HW_CACHE_RESULT_##result << 16))
+
+static TlbCounter s_tlb[] = {
+	{"dTLB loads", TLB_EVENT(DTLB, READ, ACCESS), -1, 0},
+	{"dTLB load misses", TLB_EVENT(DTLB, READ, MISS), -1, 0},
+	{"dTLB store misses", TLB_EVENT(DTLB, WRITE, MISS), -1, 0},
+	{"iTLB misses", TLB_EVENT(ITLB, READ, MISS), -1, 0},
+};
+
+static int s_tlb_error = 0;
+
+// Opened before retro_init so that the emulator threads inherit the counters; reading the
+// counter of this thread adds up the ones of its children.
+static void open_tlb_counters()
+{
+	for (TlbCounter& c : s_tlb)
+	{
+		perf_event_attr attr = {};
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = c.config;
+		attr.inherit = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		c.fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+		if (c.fd < 0 && !s_tlb_error)
+			s_tlb_error = errno;
+	}
+}
+
+static uint64_t read_tlb_counter(const TlbCounter& c)
+{
+	uint64_t value = 0;
+
+	if (c.fd < 0 || read(c.fd, &value, sizeof(value)) != sizeof(value))
+		return 0;
+
+	return value;
+}
+
+// Transparent huge pages mapped by the process, in kB.
+static unsigned long huge_pages_kb()
+{
+	FILE* fp = fopen("/proc/self/smaps_rollup", "r");
+
+	if (!fp)
+		return 0;
+
+	char line[256];
+	unsigned long total = 0, kb;
+
+	while (fgets(line, sizeof(line), fp))
+	{
+		if (sscanf(line, "AnonHugePages: %lu", &kb) == 1 || sscanf(line, "ShmemPmdMapped: %lu", &kb) == 1)
+			total += kb;
+	}
+
+	fclose(fp);
+
+	return total;
+}
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+
+	size_t i = std::min(sorted.size() - 1, (size_t)(p * (sorted.size() - 1) + 0.5));
+
+	return sorted[i];
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: libretro_bench [options] <core> [<content>]\n"
+		"  -frames <n>        frames to measure (default 3000)\n"
+		"  -warmup <n>        frames to run before measuring (default 600)\n"
+		"  -system <dir>      system directory with the bios (default .)\n"
+		"  -save <dir>        save directory (default: system directory)\n"
+		"  -o <key>=<value>   set a core option, e.g. -o pcsx2_renderer=Null\n"
+		"  -replay <file>     input replay file\n"
+		"  -v                 show core log\n");
+}
+
+int main(int argc, char** argv)
+{
+	unsigned frames = 3000;
+	unsigned warmup = 600;
+	const char* core_path = NULL;
+	const char* content = NULL;
+	const char* replay = NULL;
+
+	s_overrides["pcsx2_renderer"] = "CPU";
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+
+		if (arg == "-frames" && has_value)
+			frames = strtoul(argv[++i], NULL, 10);
+		else if (arg == "-warmup" && has_value)
+			warmup = strtoul(argv[++i], NULL, 10);
+		else if (arg == "-system" && has_value)
+			s_system_dir = argv[++i];
+		else if (arg == "-save" && has_value)
+			s_save_dir = argv[++i];
+		else if (arg == "-replay" && has_value)
+			replay = argv[++i];
+		else if (arg == "-o" && has_value)
+		{
+			std::string kv = argv[++i];
+			size_t eq = kv.find('=');
+
+			if (eq == std::string::npos)
+			{
+				usage();
+				return 1;
+			}
+
+			s_overrides[kv.substr(0, eq)] = kv.substr(eq + 1);
+		}
+		else if (arg == "-v")
+			s_verbose = true;
+		else if (arg[0] == '-')
+		{
+			usage();
+			return 1;
+		}
+		else if (!core_path)
+			core_path = argv[i];
+		else if (!content)
+			content = argv[i];
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	if (!core_path || frames == 0)
+	{
+		usage();
+		return 1;
+	}
+
+	if (s_save_dir.empty())
+		s_save_dir = s_system_dir;
+
+	if (replay && !load_replay(replay))
+		return 1;
+
+	if (!load_core(core_path))
+		return 1;
+
+	s_core.retro_set_environment(environment);
+	s_core.retro_set_video_refresh(video_refresh);
+	s_core.retro_set_audio_sample(audio_sample);
+	s_core.retro_set_audio_sample_batch(audio_sample_batch);
+	s_core.retro_set_input_poll(input_poll);
+	s_core.retro_set_input_state(input_state);
+
+	open_tlb_counters();
+
+	s_core.retro_init();
+
+	retro_game_info game = {};
+	game.path = content;
+
+	if (!s_core.retro_load_game(content ? &game : NULL))
+	{
+		fprintf(stderr, "retro_load_game failed (only gpu-less renderers work here: -o pcsx2_renderer=CPU or Null)\n");
+		s_core.retro_deinit();
+		return 1;
+	}
+
+	// What the frontend does once the (non existing) context is ready
+	if (s_hw_render_set && s_hw_render.context_reset)
+		s_hw_render.context_reset();
+
+	retro_system_av_info av = {};
+	s_core.retro_get_system_av_info(&av);
+
+	for (; s_frame < warmup; s_frame++)
+		s_core.retro_run();
+
+	std::vector<ThreadTime> cpu_start = thread_times();
+
+	for (TlbCounter& c : s_tlb)
+		c.start = read_tlb_counter(c);
+	std::vector<double> frame_ms;
+	frame_ms.reserve(frames);
+
+	unsigned video_frames = s_video.frames;
+	auto start = std::chrono::steady_clock::now();
+
+	for (unsigned i = 0; i < frames; i++, s_frame++)
+	{
+		auto t = std::chrono::steady_clock::now();
+
+		s_core.retro_run();
+
+		frame_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count());
+	}
+
+	double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<ThreadTime> cpu_end = thread_times();
+
+	uint64_t tlb[sizeof(s_tlb) / sizeof(s_tlb[0])];
+
+	for (size_t i = 0; i < sizeof(s_tlb) / sizeof(s_tlb[0]); i++)
+		tlb[i] = read_tlb_counter(s_tlb[i]) - s_tlb[i].start;
+
+	video_frames = s_video.frames - video_frames;
+
+	std::vector<double> sorted = frame_ms;
+	std::sort(sorted.begin(), sorted.end());
+
+	printf("content:   %s\n", content ? content : "(bios)");
+	printf("renderer:  %s\n", s_overrides["pcsx2_renderer"].c_str());
+	printf("frames:    %u measured after %u warmup, %u presented, %u dupes, %u zero-copy\n",
+		frames, warmup, s_video.frames, s_video.dupes, s_video.zero_copy);
+	printf("speed:     %.2f fps (%.1f%% of %.2f), %.2f presented fps\n",
+		frames / wall, frames / wall / av.timing.fps * 100, av.timing.fps, video_frames / wall);
+	printf("frame ms:  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+		percentile(sorted, 0.5), percentile(sorted, 0.9), percentile(sorted, 0.99), sorted.back());
+	printf("last frame hash: %016llx\n", (unsigned long long)s_video.hash);
+	printf("thread cpu time (s, %% of wall):\n");
+
+	for (const ThreadTime& t : cpu_end)
+	{
+		double seconds = t.seconds;
+
+		for (const ThreadTime& s : cpu_start)
+		{
+			if (s.name == t.name)
+				seconds -= s.seconds;
+		}
+
+		printf("  %-16s %8.2f %6.1f%%\n", t.name.c_str(), seconds, seconds / wall * 100);
+	}
+
+	printf("huge pages: %lu kB\n", huge_pages_kb());
+
+	if (std::none_of(std::begin(s_tlb), std::end(s_tlb), [](const TlbCounter& c) { return c.fd >= 0; }))
+		printf("tlb:       no perf counters (%s)\n", strerror(s_tlb_error));
+	else
+	{
+		printf("tlb (per frame):\n");
+
+		for (size_t i = 0; i < sizeof(s_tlb) / sizeof(s_tlb[0]); i++)
+		{
+			if (s_tlb[i].fd >= 0)
+				printf("  %-18s %12.0f\n", s_tlb[i].name, (double)tlb[i] / frames);
+		}
+
+		if (s_tlb[0].fd >= 0 && s_tlb[1].fd >= 0 && tlb[0])
+			printf("  dTLB load miss rate %.3f%%\n", tlb[1] * 100.0 / tlb[0]);
+	}
+
+	for (TlbCounter& c : s_tlb)
+	{
+		if (c.fd >= 0)
+			close(c.fd);
+	}
+
+	if (s_hw_render_set && s_hw_render.context_destroy)
+		s_hw_render.context_destroy();
+
+	s_core.retro_unload_game();
+	s_core.retro_deinit();
+
+	dlclose(s_core.handle);
+
+	return 0;
+}